@@ -17,10 +17,18 @@ class SppMirror(object):
             'status': None,
             'exit': None,
             'component': ['start', 'stop'],
-            'port': ['add', 'del']}
+            'port': ['add', 'del'],
+            'mirror_table': ['copy', 'filter', 'sample', 'rate', 'snaplen',
+                             'policy'],
+            'latency_probe': ['on', 'off'],
+            'chain_trace': ['on', 'off']}
 
     WORKER_TYPES = ['mirror']
 
+    COPY_MODES = ['shallow', 'deep', 'header']
+
+    POLICIES = ['drop_mirror', 'keep_original', 'block']
+
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
         self.sec_id = sec_id
@@ -70,6 +78,15 @@ class SppMirror(object):
         elif cmd == 'port':
             self._run_port(params)
 
+        elif cmd == 'mirror_table':
+            self._run_mirror_table(params)
+
+        elif cmd == 'latency_probe':
+            self._run_lat_probe(params)
+
+        elif cmd == 'chain_trace':
+            self._run_chain_trace(params)
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -141,6 +158,72 @@ class SppMirror(object):
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+        # Copy mode and counters of copies
+        if len(json_obj.get('mirror_table', [])) > 0:
+            print('Mirror Table:')
+            for mt in json_obj['mirror_table']:
+                print('  - %s: copy: %s, copies: %d, alloc_fails: %d' % (
+                      mt['name'], mt['copy'], mt['copies'],
+                      mt['alloc_fails']))
+                print('    - filter: %s, filtered: %d' % (
+                      mt['filter'] or 'off', mt['filtered']))
+                print('    - sample: %d, rate: %d, unsampled: %d, '
+                      'snaplen: %d' % (
+                          mt['sample'], mt['rate'], mt['unsampled'],
+                          mt['snaplen']))
+                print('    - policy: %s' % mt['policy'])
+        if len(json_obj.get('mirror_ports', [])) > 0:
+            print('Mirror Ports:')
+            for mp in json_obj['mirror_ports']:
+                print('  - %s: %s (%s), sent: %d, dropped: %d, '
+                      'retries: %d, queued: %d' % (
+                          mp['name'], mp['port'], mp['role'], mp['sent'],
+                          mp['dropped'], mp['retries'], mp['queued']))
+        if len(json_obj.get('mirror_pool', [])) > 0:
+            print('Mirror Pool:')
+            for mp in json_obj['mirror_pool']:
+                print('  - %s: %d/%d' % (
+                      mp['name'], mp['in_use'], mp['size']))
+
+        # Counters of ports
+        if len(json_obj.get('port_stats', [])) > 0:
+            print('Port Stats:')
+            for ps in json_obj['port_stats']:
+                print('  - %s: rx: %d (drop: %d), tx: %d (drop: %d)' % (
+                      ps['port'], ps['rx'], ps['rx_drop'], ps['tx'],
+                      ps['tx_drop']))
+        # Cycles of polling, busy if packets are received
+        if len(json_obj.get('lcore_cycles', [])) > 0:
+            print('Lcore Cycles:')
+            for lc in json_obj['lcore_cycles']:
+                total = lc['busy'] + lc['idle']
+                busy_ratio = 100.0 * lc['busy'] / total if total > 0 else 0
+                print('  - core:%d busy: %d (%.1f%%), idle: %d, pkts: %d' % (
+                      lc['core'], lc['busy'], busy_ratio, lc['idle'],
+                      lc['pkts']))
+        if len(json_obj.get('comp_cycles', [])) > 0:
+            print('Component Cycles:')
+            for cc in json_obj['comp_cycles']:
+                per_pkt = cc['busy'] / cc['pkts'] if cc['pkts'] > 0 else 0
+                print('  - %s (core:%d) busy: %d, idle: %d, pkts: %d, '
+                      'cycles/pkt: %.1f' % (
+                          cc['name'], cc['core'], cc['busy'], cc['idle'],
+                          cc['pkts'], per_pkt))
+        if len(json_obj.get('ring_latency', [])) > 0:
+            print('Ring Latency (ns):')
+            for rl in json_obj['ring_latency']:
+                print('  - %s (probe:%s): count: %d, p50: %d, p99: %d, '
+                      'p99.9: %d, max: %d' % (
+                          rl['port'], rl.get('probe', 'on'), rl['count'],
+                          rl['p50'], rl['p99'], rl['p999'], rl['max']))
+        if len(json_obj.get('chain_latency', [])) > 0:
+            print('Chain Latency (ns):')
+            for cl in json_obj['chain_latency']:
+                print('  - %s (%s): count: %d, p50: %d, p99: %d, '
+                      'p99.9: %d, max: %d' % (
+                          cl['port'], cl['point'], cl['count'],
+                          cl['p50'], cl['p99'], cl['p999'], cl['max']))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_mirrorcommands.
 
@@ -168,6 +251,15 @@ class SppMirror(object):
 
                     elif sub_tokens[0] == 'port':
                         completions = self._compl_port(sub_tokens)
+
+                    elif sub_tokens[0] == 'mirror_table':
+                        completions = self._compl_mirror_table(sub_tokens)
+
+                    elif sub_tokens[0] == 'latency_probe':
+                        completions = self._compl_lat_probe(sub_tokens)
+
+                    elif sub_tokens[0] == 'chain_trace':
+                        completions = self._compl_chain_trace(sub_tokens)
             return completions
         except Exception as e:
             print(e)
@@ -290,6 +382,73 @@ class SppMirror(object):
             else:
                 print('Error: unknown response.')
 
+    def _run_mirror_table(self, params):
+        if (len(params) != 3 or
+                params[1] not in self.MIRROR_CMDS['mirror_table']):
+            print('Error: Invalid syntax.')
+            return None
+
+        val = params[2]
+        if params[1] in ['sample', 'rate', 'snaplen']:
+            try:
+                val = int(params[2])
+            except ValueError:
+                print('Error: Invalid %s.' % params[1])
+                return None
+
+        req = 'mirrors/%d/components/%s/mirror_table' % (
+                self.sec_id, params[0])
+        res = self.spp_ctl_cli.put(req, {params[1]: val})
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to set %s" % params[1])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_lat_probe(self, params):
+        if len(params) != 2 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return None
+
+        req_params = {'action': params[0]}
+        if params[1].startswith('ring:'):
+            req_params['port'] = params[1]
+        else:
+            req_params['name'] = params[1]
+
+        req = 'mirrors/%d/latency_probe' % self.sec_id
+        res = self.spp_ctl_cli.put(req, req_params)
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to turn %s latency probe" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_chain_trace(self, params):
+        if len(params) != 1 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return None
+
+        req = 'mirrors/%d/chain_trace' % self.sec_id
+        res = self.spp_ctl_cli.put(req, {'action': params[0]})
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to turn %s chain trace" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -357,16 +516,65 @@ class SppMirror(object):
                             res.append(kw)
             return res
 
+    def _compl_mirror_table(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in self.worker_names:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        elif len(sub_tokens) == 3:
+            for kw in self.MIRROR_CMDS['mirror_table']:
+                if kw.startswith(sub_tokens[2]):
+                    res.append(kw)
+        elif len(sub_tokens) == 4:
+            if sub_tokens[2] == 'copy':
+                candidates = self.COPY_MODES
+            elif sub_tokens[2] == 'filter':
+                candidates = ['FILE', 'off']
+            elif sub_tokens[2] == 'policy':
+                candidates = self.POLICIES
+            elif sub_tokens[2] in ['sample', 'rate', 'snaplen']:
+                candidates = [sub_tokens[2].upper()]
+            else:
+                candidates = []
+            for kw in candidates:
+                if kw.startswith(sub_tokens[3]):
+                    res.append(kw)
+        return res
+
+    def _compl_lat_probe(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        elif len(sub_tokens) == 3:
+            for kw in self.worker_names + ['RES_UID']:
+                if kw.startswith(sub_tokens[2]):
+                    res.append(kw)
+        return res
+
+    def _compl_chain_trace(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        return res
+
     @classmethod
     def help(cls):
         msg = """Send a command to spp_mirror.
 
         spp_mirror is a secondary process for duplicating incoming
         packets to be used as similar to TaaS in OpenStack. This
-        command has four sub commands.
+        command has six sub commands.
           * status
           * component
           * port
+          * mirror_table
+          * latency_probe
+          * chain_trace
 
         Each of sub commands other than 'status' takes several parameters
         for detailed operations. Notice that 'start' for launching a worker
@@ -385,10 +593,36 @@ class SppMirror(object):
         spp > mirror 1; component stop NAME CORE_ID mirror
 
         # (3) add or delete a port to worker of NAME
-        #   RES_UID: resource UID such as 'ring:0' or 'vhost:1'
+        #   RES_UID: resource UID such as 'ring:0' or 'vhost:1', and queue
+        #            can be given as 'phy:0:1' for multi-queue port
         #   DIR: 'rx' or 'tx'
         spp > mirror 1; port add RES_UID DIR NAME
         spp > mirror 1; port del RES_UID DIR NAME
+
+        # (4) set copy mode, filter, sampling and length of copies of
+        #     worker of NAME
+        #   MODE: 'shallow', 'deep' or 'header'
+        #   FILE: ELF file of BPF filter, or 'off' for removing
+        #   SAMPLE: copy 1 in SAMPLE packets
+        #   RATE: max copies per sec, or 0 for unlimited
+        #   SNAPLEN: max length of copies, or 0 for whole
+        #   POLICY: 'drop_mirror', 'keep_original' or 'block'
+        spp > mirror 1; mirror_table NAME copy MODE
+        spp > mirror 1; mirror_table NAME filter FILE
+        spp > mirror 1; mirror_table NAME sample SAMPLE
+        spp > mirror 1; mirror_table NAME rate RATE
+        spp > mirror 1; mirror_table NAME snaplen SNAPLEN
+        spp > mirror 1; mirror_table NAME policy POLICY
+
+        # (5) turn on or off latency probe of a ring, or of all of rings
+        #     attached to worker of NAME
+        spp > mirror 1; latency_probe on RES_UID
+        spp > mirror 1; latency_probe off NAME
+
+        # (6) turn on or off tracing latency of service chain, of which
+        #     ingress and egress are phy ports
+        spp > mirror 1; chain_trace on
+        spp > mirror 1; chain_trace off
         """
 
         print(msg)
@@ -16,7 +16,7 @@ class SppNfv(object):
 
     # All of spp_nfv commands used for validation and completion.
     NFV_CMDS = ['status', 'exit', 'forward', 'stop', 'add', 'patch',
-                'del']
+                'del', 'chain_trace']
 
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         """Initialize SppNfv.
@@ -54,6 +54,9 @@ class SppNfv(object):
         elif cmd == 'patch':
             self._run_patch(params)
 
+        elif cmd == 'chain_trace':
+            self._run_chain_trace(params)
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -94,6 +97,13 @@ class SppNfv(object):
                 print('  - {}'.format(port))
             else:
                 print('  - {} -> {}'.format(port, dst))
+        if len(nfv_attr.get('chain_latency', [])) > 0:
+            print('- chain_latency (ns):')
+            for cl in nfv_attr['chain_latency']:
+                print('  - {} ({}): count: {}, p50: {}, p99: {}, '
+                      'p99.9: {}, max: {}'.format(
+                          cl['port'], cl['point'], cl['count'],
+                          cl['p50'], cl['p99'], cl['p999'], cl['max']))
 
     # TODO(yasufum) change name starts with '_' as private
     def get_ports(self):
@@ -196,6 +206,11 @@ class SppNfv(object):
                     elif sub_tokens[0] == 'patch':
                         completions = self._compl_patch(sub_tokens)
 
+                    elif sub_tokens[0] == 'chain_trace':
+                        if len(sub_tokens) == 2:
+                            completions = [kw for kw in ['on', 'off']
+                                           if kw.startswith(sub_tokens[1])]
+
             return completions
 
         except Exception as e:
@@ -436,6 +451,25 @@ class SppNfv(object):
                     else:
                         print('Error: unknown response.')
 
+    def _run_chain_trace(self, params):
+        """Run `chain_trace` command."""
+
+        if len(params) != 1 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax. "on" or "off"?')
+            return None
+
+        req_params = {'action': params[0]}
+        res = self.spp_ctl_cli.put('nfvs/%d/chain_trace' %
+                                   self.sec_id, req_params)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print('Turn %s chain trace.' % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -463,7 +497,8 @@ class SppNfv(object):
         'nfv 1;'.
 
           spp > nfv 1;  # press TAB
-          add     del     exit    forward patch   status  stop
+          add          chain_trace  del          exit         forward
+          patch        status       stop
         """
 
         print(msg)
@@ -161,6 +161,13 @@ class SppPcap(object):
                 else:
                     print('    - filename: {}'.format(worker['filename']))
 
+        # Counters of the port captured
+        if len(json_obj.get('port_stats', [])) > 0:
+            print('Port Stats:')
+            for ps in json_obj['port_stats']:
+                print('  - {}: rx: {}, rx_drop: {}'.format(
+                      ps['port'], ps['rx'], ps['rx_drop']))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_pcap commands.
 
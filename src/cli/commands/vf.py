@@ -18,9 +18,15 @@ class SppVf(object):
             'exit': None,
             'component': ['start', 'stop'],
             'port': ['add', 'del'],
-            'classifier_table': ['add', 'del']}
+            'classifier_table': ['add', 'del'],
+            'lb_table': ['hash', 'weight', 'reta'],
+            'latency_probe': ['on', 'off'],
+            'chain_trace': ['on', 'off'],
+            'flush_thresh': None}
 
-    WORKER_TYPES = ['forward', 'merge', 'classifier']
+    WORKER_TYPES = ['forward', 'merge', 'classifier', 'load_balancer']
+
+    LB_HASH_TYPES = ['toeplitz', 'crc']
 
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
@@ -74,6 +80,18 @@ class SppVf(object):
         elif cmd == 'classifier_table':
             self._run_cls_table(params)
 
+        elif cmd == 'lb_table':
+            self._run_lb_table(params)
+
+        elif cmd == 'latency_probe':
+            self._run_lat_probe(params)
+
+        elif cmd == 'chain_trace':
+            self._run_chain_trace(params)
+
+        elif cmd == 'flush_thresh':
+            self._run_flush_thresh(params)
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -126,6 +144,15 @@ class SppVf(object):
         for ct in json_obj['classifier_table']:
             print('  - %s, %s' % (ct['value'], ct['port']))
 
+        # Load Balancer Table
+        if len(json_obj.get('lb_table', [])) > 0:
+            print('Load Balancer Table:')
+            for lb in json_obj['lb_table']:
+                print("  - '%s' (hash: %s)" % (lb['name'], lb['hash']))
+                for wt in lb['weights']:
+                    print('    - %s, weight: %d, reta: %d' % (
+                          wt['port'], wt['weight'], wt['reta']))
+
         # Componennts
         print('Components:')
         for worker in json_obj['components']:
@@ -135,13 +162,33 @@ class SppVf(object):
                 for pt_dir in ['rx', 'tx']:
                     pt = '%s_port' % pt_dir
                     for attr in worker[pt]:
-                        if attr['vlan']['operation'] == 'add':
+                        if len(attr.get('vlan_ops', [])) > 1:
+                            # Chained operations are shown in order.
+                            ops = []
+                            for vo in attr['vlan_ops']:
+                                if vo['operation'] in ['add', 'add_stag']:
+                                    ops.append('%s id: %d, pcp: %d' % (
+                                        vo['operation'], vo['id'],
+                                        vo['pcp']))
+                                elif vo['operation'] == 'set_pcp':
+                                    ops.append('set_pcp pcp: %d' % vo['pcp'])
+                                else:
+                                    ops.append(vo['operation'])
+                            msg = '    - %s: %s (vlan operations: %s)'
+                            print(msg % (pt_dir, attr['port'],
+                                         ' -> '.join(ops)))
+                        elif attr['vlan']['operation'] in ['add', 'add_stag']:
                             msg = '    - %s: %s ' + \
                                   '(vlan operation: %s, id: %d, pcp: %d)'
                             print(msg % (pt_dir, attr['port'],
                                          attr['vlan']['operation'],
                                          attr['vlan']['id'],
                                          attr['vlan']['pcp']))
+                        elif attr['vlan']['operation'] == 'set_pcp':
+                            msg = '    - %s: %s (vlan operation: %s, pcp: %d)'
+                            print(msg % (pt_dir, attr['port'],
+                                         attr['vlan']['operation'],
+                                         attr['vlan']['pcp']))
                         elif attr['vlan']['operation'] == 'del':
                             msg = '    - %s: %s (vlan operation: %s)'
                             print(msg % (pt_dir, attr['port'],
@@ -154,6 +201,52 @@ class SppVf(object):
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+        # Counters of ports and lcores
+        if len(json_obj.get('port_stats', [])) > 0:
+            print('Port Stats:')
+            for ps in json_obj['port_stats']:
+                print('  - %s: rx: %d (drop: %d, vlan_drop: %d), '
+                      'tx: %d (drop: %d, vlan_drop: %d)' % (
+                          ps['port'], ps['rx'], ps['rx_drop'],
+                          ps['rx_vlan_drop'], ps['tx'], ps['tx_drop'],
+                          ps['tx_vlan_drop']))
+        if len(json_obj.get('lcore_stats', [])) > 0:
+            print('Lcore Stats:')
+            for ls in json_obj['lcore_stats']:
+                print('  - core:%d cls_miss: %d, mcast_fanout: %d' % (
+                      ls['core'], ls['cls_miss'], ls['mcast_fanout']))
+        # Cycles of polling, busy if packets are received
+        if len(json_obj.get('lcore_cycles', [])) > 0:
+            print('Lcore Cycles:')
+            for lc in json_obj['lcore_cycles']:
+                total = lc['busy'] + lc['idle']
+                busy_ratio = 100.0 * lc['busy'] / total if total > 0 else 0
+                print('  - core:%d busy: %d (%.1f%%), idle: %d, pkts: %d' % (
+                      lc['core'], lc['busy'], busy_ratio, lc['idle'],
+                      lc['pkts']))
+        if len(json_obj.get('comp_cycles', [])) > 0:
+            print('Component Cycles:')
+            for cc in json_obj['comp_cycles']:
+                per_pkt = cc['busy'] / cc['pkts'] if cc['pkts'] > 0 else 0
+                print('  - %s (core:%d) busy: %d, idle: %d, pkts: %d, '
+                      'cycles/pkt: %.1f' % (
+                          cc['name'], cc['core'], cc['busy'], cc['idle'],
+                          cc['pkts'], per_pkt))
+        if len(json_obj.get('ring_latency', [])) > 0:
+            print('Ring Latency (ns):')
+            for rl in json_obj['ring_latency']:
+                print('  - %s (probe:%s): count: %d, p50: %d, p99: %d, '
+                      'p99.9: %d, max: %d' % (
+                          rl['port'], rl.get('probe', 'on'), rl['count'],
+                          rl['p50'], rl['p99'], rl['p999'], rl['max']))
+        if len(json_obj.get('chain_latency', [])) > 0:
+            print('Chain Latency (ns):')
+            for cl in json_obj['chain_latency']:
+                print('  - %s (%s): count: %d, p50: %d, p99: %d, '
+                      'p99.9: %d, max: %d' % (
+                          cl['port'], cl['point'], cl['count'],
+                          cl['p50'], cl['p99'], cl['p999'], cl['max']))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_vf commands.
 
@@ -171,7 +264,11 @@ class SppVf(object):
                 #         'status': None,
                 #         'component': ['start', 'stop'],
                 #         'port': ['add', 'del'],
-                #         'classifier_table': ['add', 'del']}
+                #         'classifier_table': ['add', 'del'],
+                #         'lb_table': ['hash', 'weight'],
+                #         'latency_probe': ['on', 'off'],
+                #         'chain_trace': ['on', 'off'],
+                #         'flush_thresh': None}
 
                 if len(sub_tokens) == 1:
                     if not (sub_tokens[0] in self.VF_CMDS.keys()):
@@ -190,6 +287,18 @@ class SppVf(object):
 
                     elif sub_tokens[0] == 'classifier_table':
                         completions = self._compl_cls_table(sub_tokens)
+
+                    elif sub_tokens[0] == 'lb_table':
+                        completions = self._compl_lb_table(sub_tokens)
+
+                    elif sub_tokens[0] == 'latency_probe':
+                        completions = self._compl_lat_probe(sub_tokens)
+
+                    elif sub_tokens[0] == 'chain_trace':
+                        completions = self._compl_chain_trace(sub_tokens)
+
+                    elif sub_tokens[0] == 'flush_thresh':
+                        completions = self._compl_flush_thresh(sub_tokens)
             return completions
         except Exception as e:
             print(e)
@@ -253,6 +362,8 @@ class SppVf(object):
         if params[0] == 'start':
             req_params = {'name': params[1], 'core': int(params[2]),
                           'type': params[3]}
+            if len(params) > 4:
+                req_params['table_size'] = int(params[4])
             res = self.spp_ctl_cli.post('vfs/%d/components' % self.sec_id,
                                         req_params)
             if res is not None:
@@ -316,16 +427,34 @@ class SppVf(object):
                                    'id': 'none',
                                    'pcp': 'none'}}
 
-        elif len(params) == 7:
+        elif len(params) == 6 and params[4] == 'set_pcp':
+            action = 'attach'
+            req_params = {'action': action, 'port': params[1],
+                          'dir': params[2],
+                          'vlan': {'operation': 'set_pcp',
+                                   'id': 'none',
+                                   'pcp': int(params[5])}}
+
+        elif len(params) == 7 or len(params) == 8:
             action = 'attach'
             if params[4] == 'add_vlantag':
                 op = 'add'
             elif params[4] == 'del_vlantag':
                 op = 'del'
+            elif params[4] == 'add_stag':
+                op = 'add_stag'
+            else:
+                print('Error: Invalid vlan operation.')
+                return None
             req_params = {'action': action, 'port': params[1],
                           'dir': params[2],
                           'vlan': {'operation': op, 'id': int(params[5]),
                                    'pcp': int(params[6])}}
+            if len(params) == 8:
+                if op != 'add_stag':
+                    print('Error: TPID is only for add_stag.')
+                    return None
+                req_params['vlan']['tpid'] = params[7]
         else:
             print('Error: Invalid syntax.')
 
@@ -343,7 +472,11 @@ class SppVf(object):
 
     def _run_cls_table(self, params):
         req_params = None
-        if len(params) == 4:
+        if len(params) == 4 and params[1] == 'flow':
+            req_params = {'action': params[0], 'type': params[1],
+                          'flow_rules': params[2], 'port': params[3]}
+
+        elif len(params) == 4:
             req_params = {'action': params[0], 'type': params[1],
                           'mac_address': params[2], 'port': params[3]}
 
@@ -367,6 +500,99 @@ class SppVf(object):
                 else:
                     print('Error: unknown response.')
 
+    def _run_lb_table(self, params):
+        req_params = None
+        if len(params) == 3 and params[1] == 'hash':
+            req_params = {'hash': params[2]}
+
+        elif len(params) == 4 and params[1] == 'weight':
+            try:
+                req_params = {'port': params[2], 'weight': int(params[3])}
+            except ValueError:
+                print('Error: Invalid weight.')
+                return None
+
+        elif len(params) == 5 and params[1] == 'reta':
+            try:
+                req_params = {'reta': [int(params[2]), int(params[3])],
+                              'port': params[4]}
+            except ValueError:
+                print('Error: Invalid index of reta.')
+                return None
+        else:
+            print('Error: Invalid syntax.')
+
+        if req_params is not None:
+            req = 'vfs/%d/components/%s/lb_table' % (self.sec_id, params[0])
+            res = self.spp_ctl_cli.put(req, req_params)
+
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to set %s" % params[1])
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+    def _run_lat_probe(self, params):
+        if len(params) != 2 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return None
+
+        req_params = {'action': params[0]}
+        if params[1].startswith('ring:'):
+            req_params['port'] = params[1]
+        else:
+            req_params['name'] = params[1]
+
+        req = 'vfs/%d/latency_probe' % self.sec_id
+        res = self.spp_ctl_cli.put(req, req_params)
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to turn %s latency probe" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_chain_trace(self, params):
+        if len(params) != 1 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return None
+
+        req = 'vfs/%d/chain_trace' % self.sec_id
+        res = self.spp_ctl_cli.put(req, {'action': params[0]})
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to turn %s chain trace" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_flush_thresh(self, params):
+        if len(params) != 2 or not params[1].isdigit():
+            print('Error: Invalid syntax.')
+            return None
+
+        req = 'vfs/%d/flush_thresh' % self.sec_id
+        res = self.spp_ctl_cli.put(req, {'port': params[0],
+                                         'thresh': int(params[1])})
+
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to set flush_thresh of %s" % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -411,7 +637,7 @@ class SppVf(object):
             return res
 
     def _compl_port(self, sub_tokens):
-        if len(sub_tokens) < 9:
+        if len(sub_tokens) < 10:
             subsub_cmds = ['add', 'del']
             res = []
             if len(sub_tokens) == 2:
@@ -434,17 +660,27 @@ class SppVf(object):
                             res.append(kw)
             elif len(sub_tokens) == 6:
                 if sub_tokens[1] == 'add':
-                    for kw in ['add_vlantag', 'del_vlantag']:
+                    for kw in ['add_vlantag', 'del_vlantag', 'add_stag',
+                               'set_pcp']:
                         if kw.startswith(sub_tokens[5]):
                             res.append(kw)
             elif len(sub_tokens) == 7:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_stag']:
                     if 'VID'.startswith(sub_tokens[6]):
                         res.append('VID')
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'set_pcp':
+                    if 'PCP'.startswith(sub_tokens[6]):
+                        res.append('PCP')
             elif len(sub_tokens) == 8:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_stag']:
                     if 'PCP'.startswith(sub_tokens[7]):
                         res.append('PCP')
+            elif len(sub_tokens) == 9:
+                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_stag':
+                    if 'TPID'.startswith(sub_tokens[8]):
+                        res.append('TPID')
             return res
 
     def _compl_cls_table(self, sub_tokens):
@@ -459,12 +695,15 @@ class SppVf(object):
 
             elif len(sub_tokens) == 3:
                 if sub_tokens[1] in subsub_cmds:
-                    for kw in ['mac', 'vlan']:
+                    for kw in ['mac', 'vlan', 'flow']:
                         if kw.startswith(sub_tokens[2]):
                             res.append(kw)
 
             elif len(sub_tokens) == 4:
-                if sub_tokens[1] == 'add':
+                if sub_tokens[2] == 'flow':
+                    if 'FLOW_RULES'.startswith(sub_tokens[3]):
+                        res.append('FLOW_RULES')
+                elif sub_tokens[1] == 'add':
                     if sub_tokens[2] == 'mac':
                         if 'MAC_ADDR'.startswith(sub_tokens[3]):
                             res.append('MAC_ADDR')
@@ -480,7 +719,10 @@ class SppVf(object):
                                 res.append('VID')
 
             elif len(sub_tokens) == 5:
-                if sub_tokens[1] == 'add':
+                if sub_tokens[2] == 'flow':
+                    if 'RES_UID'.startswith(sub_tokens[4]):
+                        res.append('RES_UID')
+                elif sub_tokens[1] == 'add':
                     if sub_tokens[2] == 'mac':
                         if 'RES_UID'.startswith(sub_tokens[4]):
                             res.append('RES_UID')
@@ -502,16 +744,92 @@ class SppVf(object):
                                 res.append('RES_UID')
             return res
 
+    def _compl_lb_table(self, sub_tokens):
+        if len(sub_tokens) < 7:
+            subsub_cmds = ['hash', 'weight', 'reta']
+            res = []
+
+            if len(sub_tokens) == 2:
+                for kw in self.worker_names:
+                    if kw.startswith(sub_tokens[1]):
+                        res.append(kw)
+
+            elif len(sub_tokens) == 3:
+                for kw in subsub_cmds:
+                    if kw.startswith(sub_tokens[2]):
+                        res.append(kw)
+
+            elif len(sub_tokens) == 4:
+                if sub_tokens[2] == 'hash':
+                    for kw in self.LB_HASH_TYPES:
+                        if kw.startswith(sub_tokens[3]):
+                            res.append(kw)
+                elif sub_tokens[2] == 'weight':
+                    if 'RES_UID'.startswith(sub_tokens[3]):
+                        res.append('RES_UID')
+                elif sub_tokens[2] == 'reta':
+                    if 'FIRST'.startswith(sub_tokens[3]):
+                        res.append('FIRST')
+
+            elif len(sub_tokens) == 5:
+                if sub_tokens[2] == 'weight':
+                    if 'WEIGHT'.startswith(sub_tokens[4]):
+                        res.append('WEIGHT')
+                elif sub_tokens[2] == 'reta':
+                    if 'LAST'.startswith(sub_tokens[4]):
+                        res.append('LAST')
+
+            elif len(sub_tokens) == 6:
+                if sub_tokens[2] == 'reta':
+                    for kw in ['RES_UID', 'none']:
+                        if kw.startswith(sub_tokens[5]):
+                            res.append(kw)
+            return res
+
+    def _compl_lat_probe(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        elif len(sub_tokens) == 3:
+            for kw in self.worker_names + ['RES_UID']:
+                if kw.startswith(sub_tokens[2]):
+                    res.append(kw)
+        return res
+
+    def _compl_chain_trace(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        return res
+
+    def _compl_flush_thresh(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            if 'RES_UID'.startswith(sub_tokens[1]):
+                res.append('RES_UID')
+        elif len(sub_tokens) == 3:
+            if 'NUM'.startswith(sub_tokens[2]):
+                res.append('NUM')
+        return res
+
     @classmethod
     def help(cls):
         msg = """Send a command to spp_vf.
 
         SPP VF is a secondary process for pseudo SR-IOV features. This
-        command has four sub commands.
+        command has eight sub commands.
           * status
           * component
           * port
           * classifier_table
+          * lb_table
+          * latency_probe
+          * chain_trace
+          * flush_thresh
 
         Each of sub commands other than 'status' takes several parameters
         for detailed operations. Notice that 'start' for launching a worker
@@ -526,12 +844,14 @@ class SppVf(object):
         # (2) launch or terminate a worker thread with arbitrary name
         #   NAME: arbitrary name used as identifier
         #   CORE_ID: one of unused cores referred from status
-        #   ROLE: role of workers, 'forward', 'merge' or 'classifier'
+        #   ROLE: role of workers, 'forward', 'merge', 'classifier' or
+        #         'load_balancer'
         spp > vf 1; component start NAME CORE_ID ROLE
         spp > vf 1; component stop NAME CORE_ID ROLE
 
         # (3) add or delete a port to worker of NAME
-        #   RES_UID: resource UID such as 'ring:0' or 'vhost:1'
+        #   RES_UID: resource UID such as 'ring:0' or 'vhost:1', and queue
+        #            can be given as 'phy:0:1' for multi-queue port
         #   DIR: 'rx' or 'tx'
         spp > vf 1; port add RES_UID DIR NAME
         spp > vf 1; port del RES_UID DIR NAME
@@ -545,6 +865,12 @@ class SppVf(object):
         # (5) add a port of deleting vlan tag
         spp > vf 1; port add RES_UID DIR NAME del_vlantag
 
+        # (5-1) push outer tag of QinQ, or remark PCP of outermost tag
+        #   TPID: 0x88a8 (default), 0x8100 or 0x9100
+        #   Operations added to the same port are applied in order.
+        spp > vf 1; port add RES_UID DIR NAME add_stag VID PCP [TPID]
+        spp > vf 1; port add RES_UID DIR NAME set_pcp PCP
+
         # (6) add or delete an entry of MAC address and resource to classify
         spp > vf 1; classifier_table add mac MAC_ADDR RES_UID
         spp > vf 1; classifier_table del mac MAC_ADDR RES_UID
@@ -552,6 +878,30 @@ class SppVf(object):
         # (7) add or delete an entry of MAC address and resource with vlan ID
         spp > vf 1; classifier_table add vlan VID MAC_ADDR RES_UID
         spp > vf 1; classifier_table del vlan VID MAC_ADDR RES_UID
+
+        # (8) set hash function, weight of TX port or entries of
+        #     indirection table of load balancer NAME
+        #   HASH: 'toeplitz' or 'crc'
+        #   WEIGHT: from 0 to 100, and 0 for not distributing to the port
+        #   FIRST, LAST: from 0 to 127, and 'none' for RES_UID to assign
+        #     the entries by weights again
+        spp > vf 1; lb_table NAME hash HASH
+        spp > vf 1; lb_table NAME weight RES_UID WEIGHT
+        spp > vf 1; lb_table NAME reta FIRST LAST RES_UID
+
+        # (9) turn on or off latency probe of a ring, or of all of rings
+        #     attached to worker of NAME
+        spp > vf 1; latency_probe on RES_UID
+        spp > vf 1; latency_probe off NAME
+
+        # (10) turn on or off tracing latency of service chain, of which
+        #     ingress and egress are phy ports
+        spp > vf 1; chain_trace on
+        spp > vf 1; chain_trace off
+
+        # (11) set num of packets buffered by classifiers for TX port
+        #   NUM: from 1 to 32
+        spp > vf 1; flush_thresh RES_UID NUM
         """
 
         print(msg)
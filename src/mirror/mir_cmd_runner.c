@@ -3,6 +3,7 @@
  */
 
 #include "spp_mirror.h"
+#include "shared/chain_trace.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
@@ -10,6 +11,7 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/port_stats.h"
 #include "shared/secondary/spp_worker_th/mirror_deps.h"
 
 #define RTE_LOGTYPE_MIR_CMD_RUNNER RTE_LOGTYPE_USER1
@@ -22,6 +24,7 @@ update_comp(enum sppwk_action wk_action, const char *name,
 {
 	int ret;
 	int ret_del;
+	int cnt;
 	int comp_lcore_id = 0;
 	unsigned int tmp_lcore_id = 0;
 	struct sppwk_comp_info *comp_info = NULL;
@@ -61,10 +64,15 @@ update_comp(enum sppwk_action wk_action, const char *name,
 			return SPPWK_RET_NG;
 		}
 
+		if (init_mirror_conf(comp_lcore_id) != SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+
 		core = &info->core[info->upd_index];
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
+		memset(&g_sppwk_comp_cycles[comp_lcore_id], 0x00,
+				sizeof(struct poll_cycles));
 		strcpy(comp_info->name, name);
 		comp_info->wk_type = wk_type;
 		comp_info->lcore_id = lcore_id;
@@ -84,6 +92,11 @@ update_comp(enum sppwk_action wk_action, const char *name,
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		tmp_lcore_id = comp_info->lcore_id;
+
+		/* Others sharing TX ports are updated to take over queues. */
+		for (cnt = 0; cnt < comp_info->nof_tx; cnt++)
+			set_component_change_port(comp_info->tx_ports[cnt],
+					SPPWK_PORT_DIR_TX);
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
 
 		info = (core_info + tmp_lcore_id);
@@ -107,6 +120,63 @@ update_comp(enum sppwk_action wk_action, const char *name,
 	return ret;
 }
 
+/* Update options of mirror given by mirror_table command. */
+static int
+update_mir_table(const struct sppwk_mir_cmd_attrs *mir_attrs)
+{
+	int ret;
+	int comp_lcore_id;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	int *change_component = NULL;
+
+	comp_lcore_id = sppwk_get_lcore_id(mir_attrs->name);
+	if (unlikely(comp_lcore_id < 0)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Unknown component by "
+				"mirror_table command. (component = %s)\n",
+				mir_attrs->name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
+			&change_component, NULL);
+	if (unlikely((comp_info_base + comp_lcore_id)->wk_type !=
+			SPPWK_TYPE_MIR)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Component `%s` is not "
+				"mirror.\n", mir_attrs->name);
+		return SPPWK_RET_NG;
+	}
+
+	switch (mir_attrs->opt) {
+	case SPPWK_MIR_OPT_COPY:
+		ret = set_mirror_copy_mode(comp_lcore_id,
+				mir_attrs->copy_mode);
+		break;
+	case SPPWK_MIR_OPT_FILTER:
+		ret = set_mirror_filter(comp_lcore_id, mir_attrs->filter);
+		break;
+	case SPPWK_MIR_OPT_SAMPLE:
+		ret = set_mirror_sample(comp_lcore_id, mir_attrs->val);
+		break;
+	case SPPWK_MIR_OPT_RATE:
+		ret = set_mirror_rate(comp_lcore_id, mir_attrs->val);
+		break;
+	case SPPWK_MIR_OPT_SNAPLEN:
+		ret = set_mirror_snaplen(comp_lcore_id, mir_attrs->val);
+		break;
+	case SPPWK_MIR_OPT_POLICY:
+		ret = set_mirror_policy(comp_lcore_id, mir_attrs->policy);
+		break;
+	default:
+		ret = SPPWK_RET_NG;
+		break;
+	}
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	*(change_component + comp_lcore_id) = 1;
+	return SPPWK_RET_OK;
+}
+
 /* Check if over the maximum num of rx and tx ports of component. */
 static int
 check_mir_port_count(enum sppwk_port_dir dir, int nof_rx, int nof_tx)
@@ -121,7 +191,7 @@ check_mir_port_count(enum sppwk_port_dir dir, int nof_rx, int nof_tx)
 	RTE_LOG(INFO, MIR_CMD_RUNNER, "Num of ports after count up,"
 				" port_type=%d, rx=%d, tx=%d\n",
 				dir, nof_rx, nof_tx);
-	if (nof_rx > 1 || nof_tx > 2)
+	if (nof_rx > 1)
 		return SPPWK_RET_NG;
 
 	return SPPWK_RET_OK;
@@ -144,6 +214,7 @@ update_port(enum sppwk_action wk_action,
 	struct sppwk_port_info *port_info = NULL;
 	int *nof_ports = NULL;
 	struct sppwk_port_info **ports = NULL;
+	uint16_t *queues = NULL;
 	struct sppwk_comp_info *comp_info_base = NULL;
 	int *change_component = NULL;
 
@@ -160,9 +231,11 @@ update_port(enum sppwk_action wk_action,
 	if (dir == SPPWK_PORT_DIR_RX) {
 		nof_ports = &comp_info->nof_rx;
 		ports = comp_info->rx_ports;
+		queues = comp_info->rx_queues;
 	} else {
 		nof_ports = &comp_info->nof_tx;
 		ports = comp_info->tx_ports;
+		queues = comp_info->tx_queues;
 	}
 
 	switch (wk_action) {
@@ -176,19 +249,16 @@ update_port(enum sppwk_action wk_action,
 		port_idx = get_idx_port_info(port_info, *nof_ports, ports);
 		if (port_idx >= SPPWK_RET_OK) {
 			/* registered */
-			/* TODO(yasufum) confirm it is needed for spp_mirror. */
-			if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VLAN) {
-				while ((cnt < PORT_CAPABL_MAX) &&
-					    (port_info->port_attrs[cnt].ops !=
-					    SPPWK_PORT_OPS_ADD_VLAN))
-					cnt++;
-				if (cnt >= PORT_CAPABL_MAX) {
-					RTE_LOG(ERR, MIR_CMD_RUNNER, "update VLAN tag "
-						"Non-registratio\n");
+			if (queues[port_idx] != port->queue_id) {
+				RTE_LOG(ERR, MIR_CMD_RUNNER, "Port is already "
+					"bound to queue %u.\n",
+					queues[port_idx]);
+				return SPPWK_RET_NG;
+			}
+			if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
+				if (sppwk_set_port_attrs(port_info, port_attrs) !=
+						SPPWK_RET_OK)
 					return SPPWK_RET_NG;
-				}
-				memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 
 				ret = SPPWK_RET_OK;
 				break;
@@ -202,23 +272,25 @@ update_port(enum sppwk_action wk_action,
 			return SPPWK_RET_NG;
 		}
 
+		/* Queue given to other lcore cannot be taken over. */
+		if (dir == SPPWK_PORT_DIR_TX &&
+				sppwk_is_lent_tx_queue(port_info,
+					port->queue_id, comp_info->lcore_id)) {
+			RTE_LOG(ERR, MIR_CMD_RUNNER, "Queue %u is used "
+				"by other lcore as free queue.\n",
+				port->queue_id);
+			return SPPWK_RET_NG;
+		}
+
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
-			while ((cnt < PORT_CAPABL_MAX) &&
-					(port_info->port_attrs[cnt].ops !=
-					SPPWK_PORT_OPS_NONE)) {
-				cnt++;
-			}
-			if (cnt >= PORT_CAPABL_MAX) {
-				RTE_LOG(ERR, MIR_CMD_RUNNER,
-						"No space of port port_attrs.\n");
+			if (sppwk_set_port_attrs(port_info, port_attrs) !=
+					SPPWK_RET_OK)
 				return SPPWK_RET_NG;
-			}
-			memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 		}
 
 		port_info->iface_type = port->iface_type;
 		ports[*nof_ports] = port_info;
+		queues[*nof_ports] = port->queue_id;
 		(*nof_ports)++;
 
 		ret = SPPWK_RET_OK;
@@ -235,7 +307,8 @@ update_port(enum sppwk_action wk_action,
 					sizeof(struct sppwk_port_attrs));
 		}
 
-		ret_del = delete_port_info(port_info, *nof_ports, ports);
+		ret_del = delete_port_info(port_info, *nof_ports, ports,
+				queues);
 		if (ret_del == 0)
 			(*nof_ports)--; /* If deleted, decrement number. */
 
@@ -246,6 +319,9 @@ update_port(enum sppwk_action wk_action,
 		return SPPWK_RET_NG;
 	}
 
+	/* Components sharing TX port are updated to resolve its queues. */
+	if (dir == SPPWK_PORT_DIR_TX)
+		set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
 	*(change_component + comp_lcore_id) = 1;
 	return ret;
 }
@@ -285,6 +361,28 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		}
 		break;
 
+	case SPPWK_CMDTYPE_LAT_PROBE:
+		/* Probes are referred by lcores directly, no need to flush. */
+		ret = sppwk_update_lat_probe(cmd->spec.lat_probe.on,
+				&cmd->spec.lat_probe.port,
+				cmd->spec.lat_probe.name);
+		break;
+
+	case SPPWK_CMDTYPE_MIR_TABLE:
+		ret = update_mir_table(&cmd->spec.mir_table);
+		if (ret == 0) {
+			RTE_LOG(INFO, MIR_CMD_RUNNER, "Exec flush.\n");
+			ret = flush_cmd();
+		}
+		break;
+
+	case SPPWK_CMDTYPE_CHAIN_TRACE:
+		if (chain_trace_set(cmd->spec.chain_trace.on) < 0)
+			ret = SPPWK_RET_NG;
+		else
+			ret = SPPWK_RET_OK;
+		break;
+
 	default:
 		/* Do nothing. */
 		ret = SPPWK_RET_OK;
@@ -380,10 +478,14 @@ update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp)
 	struct sppwk_comp_info *comp_info = NULL;
 
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
-		if (*(p_change_comp + cnt) == 0)
+		comp_info = (p_comp_info + cnt);
+		if (*(p_change_comp + cnt) == 0) {
+			/* Lcores do not refer stopped ones after updated. */
+			if (comp_info->name[0] == '\0')
+				release_mirror_txbufs(cnt);
 			continue;
+		}
 
-		comp_info = (p_comp_info + cnt);
 		sppwk_update_port_dir(comp_info);
 
 		ret = update_mirror(comp_info);
@@ -436,6 +538,14 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "ring", add_interface },
 		{ "master-lcore", add_master_lcore},
 		{ "core", add_core},
+		{ "port_stats", add_port_stats},
+		{ "lcore_cycles", add_lcore_cycles},
+		{ "comp_cycles", add_comp_cycles},
+		{ "ring_latency", add_ring_latency},
+		{ "chain_latency", add_chain_latency},
+		{ "mirror_table", add_mirror_table},
+		{ "mirror_ports", add_mirror_ports},
+		{ "mirror_pool", add_mirror_pool},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));
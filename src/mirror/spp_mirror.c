@@ -8,51 +8,132 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_pause.h>
+#ifdef RTE_LIBRTE_BPF
+#include <rte_bpf.h>
+#endif
 
 #include "spp_mirror.h"
 #include "shared/secondary/common.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/utils.h"
+#include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/mirror_deps.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/port_stats.h"
+#include "shared/secondary/spp_worker_th/telemetry.h"
+#include "shared/idle_policy.h"
+#include "shared/chain_trace.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
 
 /* Declare global variables */
 #define RTE_LOGTYPE_MIRROR RTE_LOGTYPE_USER1
 
 #define SPP_MIRROR_POOL_NAME "spp_mirror_pool"
+#define SPP_MIRROR_CLONE_POOL_NAME "spp_mirror_clone_pool"
 #define SPP_MIRROR_POOL_NAME_MAX 32
 #define MAX_PKT_MIRROR 4096
 #define MEMPOOL_CACHE_SIZE 256
 #define MIR_RX_DESC_DEFAULT 1024
 #define MIR_TX_DESC_DEFAULT 1024
 
+/* Max length of header copied in header copy mode. */
+#ifndef SPP_MIRROR_HDR_LEN
+#define SPP_MIRROR_HDR_LEN 128
+#endif
+
+/* Section of ELF file including BPF filter. */
+#ifndef SPP_MIRROR_BPF_SECTION
+#define SPP_MIRROR_BPF_SECTION ".text"
+#endif
+
+/* Num of copies buffered for each of mirror ports. */
+#ifndef SPP_MIRROR_TXBUF_SIZE
+#define SPP_MIRROR_TXBUF_SIZE (MAX_PKT_BURST * 4)
+#endif
+
+/* Max num of retries of TX burst for packets not to be dropped. */
+#ifndef SPP_MIRROR_TX_RETRY_MAX
+#define SPP_MIRROR_TX_RETRY_MAX 100000
+#endif
+
 /* getopt_long return value for long option */
 enum SPP_LONGOPT_RETVAL {
 	SPP_LONGOPT_RETVAL__ = 127,
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT,  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_QUEUES,  /* For `--vhost-queues` */
+	SPP_LONGOPT_RETVAL_IDLE_POLICY  /* For `--idle-policy` */
 };
 
 /* A set of port info of rx and tx */
 struct mirror_rxtx {
 	struct sppwk_port_info rx; /* rx port */
 	struct sppwk_port_info tx; /* tx port */
+	uint16_t rx_queue;  /* Queue of rx port */
+	uint16_t tx_queue;  /* Queue of tx port */
+	struct sppwk_tx_queue txq;  /* TX queue used by the lcore */
 };
 
+/* Options of mirror given by mirror_table command. */
+struct mirror_conf {
+	enum sppwk_mir_copy_mode copy_mode;
+	struct rte_bpf *bpf;  /* BPF filter, or NULL if not used. */
+	struct rte_bpf *bpf_retired;  /* Replaced filter to be destroyed. */
+	char filter[SPPWK_VAL_BUFSZ];  /* File of BPF filter. */
+	unsigned int sample;  /* Copy 1 in `sample` packets. */
+	unsigned int rate;  /* Max copies per sec, or 0 for unlimited. */
+	unsigned int snaplen;  /* Max length of copy, or 0 for whole. */
+	enum sppwk_mir_policy policy;
+};
+
+/**
+ * Counters and states of sampling of mirror, updated only by the lcore of
+ * the component.
+ */
+struct mirror_cnts {
+	uint64_t copies;  /* Num of copies made. */
+	uint64_t alloc_fails;  /* Num of copies failed to allocate mbuf. */
+	uint64_t filtered;  /* Num of packets not matched to filter. */
+	uint64_t unsampled;  /* Num of packets skipped by sampling. */
+	uint64_t nof_skipped;  /* Packets skipped since last sampled. */
+	uint64_t credit;  /* Cycles of credit for limiting rate. */
+	uint64_t last_tsc;  /* TSC of last burst for limiting rate. */
+} __rte_cache_aligned;
+
+/**
+ * Buffer of copies and counters of a TX port of mirror, updated only by the
+ * lcore of the component. Copies not accepted by the port are remained in
+ * the buffer and sent in the next loop.
+ */
+struct mirror_txbuf {
+	uint64_t sent;  /* Num of packets sent. */
+	uint64_t dropped;  /* Num of packets dropped. */
+	uint64_t retries;  /* Num of retries of TX burst. */
+	uint16_t len;  /* Num of copies in `pkts`. */
+	struct rte_mbuf *pkts[SPP_MIRROR_TXBUF_SIZE];
+} __rte_cache_aligned;
+
 /* Information on the path used for mirror. */
 struct mirror_path {
 	char name[STR_LEN_NAME];  /* component name */
 	volatile enum sppwk_worker_type wk_type;
+	enum sppwk_mir_copy_mode copy_mode;
+	struct rte_bpf *bpf;  /* BPF filter, or NULL if not used. */
+	uint64_t (*bpf_func)(void *);  /* JIT of filter, or NULL. */
+	unsigned int sample;  /* Copy 1 in `sample` packets. */
+	uint64_t rate_cycles;  /* Cycles for a copy, or 0 for unlimited. */
+	uint32_t snaplen;  /* Max length of copy, or 0 for whole. */
+	enum sppwk_mir_policy policy;
 	int nof_rx;  /* number of receive ports */
 	int nof_tx;  /* number of mirror ports */
 	struct mirror_rxtx ports[RTE_MAX_ETHPORTS];  /* used for mirror */
@@ -90,9 +171,42 @@ static struct cancel_backup_info g_backup_info;
 /* mirror info */
 static struct mirror_info g_mirror_info[RTE_MAX_LCORE];
 
-/* mirror mbuf pool */
+/* Options and counters of each of mirrors. */
+static struct mirror_conf g_mirror_conf[RTE_MAX_LCORE];
+static struct mirror_cnts g_mirror_cnts[RTE_MAX_LCORE];
+
+/**
+ * TX buffers of each of mirrors, allocated when the component is started.
+ * It is an array of RTE_MAX_ETHPORTS indexed with etherdev ID.
+ */
+static struct mirror_txbuf *g_mirror_txbufs[RTE_MAX_LCORE];
+
+/**
+ * List of copy mode. The order of items should be same as the order of
+ * enum `sppwk_mir_copy_mode` defined in cmd_utils.h.
+ */
+static const char *MIR_COPY_STR_LIST[] = {
+	"shallow",
+	"deep",
+	"header",
+};
+
+/**
+ * List of policy. The order of items should be same as the order of
+ * enum `sppwk_mir_policy` defined in cmd_utils.h.
+ */
+static const char *MIR_POLICY_STR_LIST[] = {
+	"drop_mirror",
+	"keep_original",
+	"block",
+};
+
+/* mirror mbuf pool for direct mbufs of deep copy and header copy */
 static struct rte_mempool *g_mirror_pool;
 
+/* mirror mbuf pool for indirect mbufs which have no data room */
+static struct rte_mempool *g_mirror_clone_pool;
+
 /* Print help message */
 static void
 usage(const char *progname)
@@ -100,11 +214,18 @@ usage(const char *progname)
 	RTE_LOG(INFO, MIRROR, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--vhost-queues NUM]"
+			" [--idle-policy PAUSE,SLEEP,MAX_US]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  : "
 				"Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --vhost-queues NUM        :"
+			" Num of RX and TX queues of vhost\n"
+			" --idle-policy PAUSE,SLEEP,MAX_US :"
+			" Num of empty polls to pause and to sleep,"
+			" and max usec of a sleep\n"
 			, progname);
 }
 
@@ -117,6 +238,7 @@ parse_app_args(int argc, char *argv[])
 	int ctl_port;  /* Port num to connect spp_ctl. */
 	int ret;
 	int cnt;
+	int nof_queues;  /* Num of queues of vhost. */
 	int option_index, opt;
 
 	int proc_flg = 0;
@@ -131,6 +253,10 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "vhost-queues", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_VHOST_QUEUES },
+			{ "idle-policy", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_IDLE_POLICY },
 			{ 0 },
 	};
 
@@ -162,6 +288,19 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_VHOST_QUEUES:
+			if ((spp_atoi(optarg, &nof_queues) != 0) ||
+					(set_vhost_nof_queues(nof_queues) != 0)) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_IDLE_POLICY:
+			if (parse_idle_policy(optarg) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			if (ret != SPPWK_RET_OK) {
@@ -185,12 +324,16 @@ parse_app_args(int argc, char *argv[])
 	}
 	RTE_LOG(INFO, MIRROR,
 			"Parsed app args (client_id=%d, server=%s:%d, "
-			"vhost_client=%d)\n",
-			cli_id, ctl_ip, ctl_port, get_vhost_cli_mode());
+			"vhost_client=%d, vhost_queues=%d)\n",
+			cli_id, ctl_ip, ctl_port, get_vhost_cli_mode(),
+			get_vhost_nof_queues());
 	return SPPWK_RET_OK;
 }
 
-/* mirror mbuf pool create */
+/**
+ * mirror mbuf pool create. Copy mode can be changed at runtime, so that
+ * both of pools of direct and indirect mbufs are created.
+ */
 static int
 mirror_pool_create(int id)
 {
@@ -203,24 +346,30 @@ mirror_pool_create(int id)
 	sprintf(pool_name, "%s_%d", SPP_MIRROR_POOL_NAME, id);
 	g_mirror_pool = rte_mempool_lookup(pool_name);
 	if (g_mirror_pool == NULL) {
-#ifdef SPP_MIRROR_SHALLOWCOPY
 		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
 						nb_mbufs,
 						MEMPOOL_CACHE_SIZE,
 						0,
-						RTE_PKTMBUF_HEADROOM,
+						RTE_MBUF_DEFAULT_BUF_SIZE,
 						rte_socket_id());
-#else
-		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
+	}
+	if (g_mirror_pool == NULL) {
+		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool\n");
+		return SPPWK_RET_NG;
+	}
+
+	sprintf(pool_name, "%s_%d", SPP_MIRROR_CLONE_POOL_NAME, id);
+	g_mirror_clone_pool = rte_mempool_lookup(pool_name);
+	if (g_mirror_clone_pool == NULL) {
+		g_mirror_clone_pool = rte_pktmbuf_pool_create(pool_name,
 						nb_mbufs,
 						MEMPOOL_CACHE_SIZE,
 						0,
-						RTE_MBUF_DEFAULT_BUF_SIZE,
+						RTE_PKTMBUF_HEADROOM,
 						rte_socket_id());
-#endif /* SPP_MIRROR_SHALLOWCOPY */
 	}
-	if (g_mirror_pool == NULL) {
-		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool\n");
+	if (g_mirror_clone_pool == NULL) {
+		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool for clone\n");
 		return SPPWK_RET_NG;
 	}
 
@@ -233,12 +382,202 @@ mirror_proc_init(void)
 {
 	int cnt = 0;
 	memset(&g_mirror_info, 0x00, sizeof(g_mirror_info));
+	memset(&g_mirror_conf, 0x00, sizeof(g_mirror_conf));
+	memset(&g_mirror_cnts, 0x00, sizeof(g_mirror_cnts));
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
 		g_mirror_info[cnt].ref_index = 0;
 		g_mirror_info[cnt].upd_index = 1;
 	}
 }
 
+/* Destroy BPF filter of mirror. */
+static void
+mirror_bpf_destroy(struct rte_bpf *bpf)
+{
+#ifdef RTE_LIBRTE_BPF
+	if (bpf != NULL)
+		rte_bpf_destroy(bpf);
+#else
+	RTE_SET_USED(bpf);
+#endif
+}
+
+/**
+ * Clear options, counters and TX buffers of mirror. Filter and copies
+ * remained by the component stopped before are released because they are
+ * not referred anymore.
+ */
+int
+init_mirror_conf(int comp_id)
+{
+	int port_id, buf;
+	struct mirror_conf *conf = &g_mirror_conf[comp_id];
+	struct mirror_txbuf *txbuf;
+
+	if (g_mirror_txbufs[comp_id] == NULL) {
+		g_mirror_txbufs[comp_id] = rte_zmalloc(NULL,
+				sizeof(struct mirror_txbuf) * RTE_MAX_ETHPORTS,
+				RTE_CACHE_LINE_SIZE);
+		if (unlikely(g_mirror_txbufs[comp_id] == NULL)) {
+			RTE_LOG(ERR, MIRROR,
+					"Cannot alloc TX buffers of mirror.\n");
+			return SPPWK_RET_NG;
+		}
+	}
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		txbuf = &g_mirror_txbufs[comp_id][port_id];
+		for (buf = 0; buf < txbuf->len; buf++)
+			rte_pktmbuf_free(txbuf->pkts[buf]);
+		memset(txbuf, 0x00, sizeof(struct mirror_txbuf));
+	}
+
+	mirror_bpf_destroy(conf->bpf);
+	mirror_bpf_destroy(conf->bpf_retired);
+	memset(conf, 0x00, sizeof(struct mirror_conf));
+	conf->sample = 1;
+	memset(&g_mirror_cnts[comp_id], 0x00, sizeof(struct mirror_cnts));
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Release TX buffers of mirror stopped. Copies remained in the buffers are
+ * freed because the component is not referred by the lcore anymore.
+ */
+void
+release_mirror_txbufs(int comp_id)
+{
+	int port_id, buf;
+	struct mirror_txbuf *txbuf;
+
+	if (g_mirror_txbufs[comp_id] == NULL)
+		return;
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		txbuf = &g_mirror_txbufs[comp_id][port_id];
+		for (buf = 0; buf < txbuf->len; buf++)
+			rte_pktmbuf_free(txbuf->pkts[buf]);
+	}
+	rte_free(g_mirror_txbufs[comp_id]);
+	g_mirror_txbufs[comp_id] = NULL;
+}
+
+/* Set copy mode of mirror. */
+int
+set_mirror_copy_mode(int comp_id, enum sppwk_mir_copy_mode copy_mode)
+{
+	if (unlikely(copy_mode != SPPWK_MIR_COPY_SHALLOW &&
+			copy_mode != SPPWK_MIR_COPY_DEEP &&
+			copy_mode != SPPWK_MIR_COPY_HEADER)) {
+		RTE_LOG(ERR, MIRROR, "Invalid copy mode %d.\n", copy_mode);
+		return SPPWK_RET_NG;
+	}
+
+	g_mirror_conf[comp_id].copy_mode = copy_mode;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Load BPF filter of mirror from ELF file, or remove it if `fname` is empty.
+ * Replaced filter might be still referred by the lcore, so that it is
+ * destroyed after the component is updated.
+ */
+int
+set_mirror_filter(int comp_id, const char *fname)
+{
+	struct mirror_conf *conf = &g_mirror_conf[comp_id];
+	struct rte_bpf *bpf = NULL;
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf_prm prm;
+
+	if (fname[0] != '\0') {
+		memset(&prm, 0x00, sizeof(prm));
+		prm.prog_arg.type = RTE_BPF_ARG_PTR_MBUF;
+		prm.prog_arg.size = sizeof(struct rte_mbuf);
+		prm.prog_arg.buf_size = RTE_MBUF_DEFAULT_BUF_SIZE;
+		bpf = rte_bpf_elf_load(&prm, fname, SPP_MIRROR_BPF_SECTION);
+		if (unlikely(bpf == NULL)) {
+			RTE_LOG(ERR, MIRROR,
+					"Cannot load BPF filter `%s` (%s).\n",
+					fname, rte_strerror(rte_errno));
+			return SPPWK_RET_NG;
+		}
+	}
+#else
+	if (fname[0] != '\0') {
+		RTE_LOG(ERR, MIRROR, "BPF is not supported in DPDK.\n");
+		return SPPWK_RET_NG;
+	}
+#endif
+
+	/**
+	 * Current filter is not referred by the lcore if another one is
+	 * remained to be destroyed, because update was failed.
+	 */
+	if (conf->bpf_retired == NULL)
+		conf->bpf_retired = conf->bpf;
+	else
+		mirror_bpf_destroy(conf->bpf);
+
+	conf->bpf = bpf;
+	strcpy(conf->filter, fname);
+	return SPPWK_RET_OK;
+}
+
+/* Set interval of 1-in-N sampling of mirror. */
+int
+set_mirror_sample(int comp_id, unsigned int sample)
+{
+	if (unlikely(sample == 0 || sample > SPPWK_MIR_SAMPLE_MAX)) {
+		RTE_LOG(ERR, MIRROR, "Invalid sample %u.\n", sample);
+		return SPPWK_RET_NG;
+	}
+
+	g_mirror_conf[comp_id].sample = sample;
+	return SPPWK_RET_OK;
+}
+
+/* Set max rate of copies of mirror. */
+int
+set_mirror_rate(int comp_id, unsigned int rate)
+{
+	if (unlikely(rate > SPPWK_MIR_RATE_MAX)) {
+		RTE_LOG(ERR, MIRROR, "Invalid rate %u.\n", rate);
+		return SPPWK_RET_NG;
+	}
+
+	g_mirror_conf[comp_id].rate = rate;
+	return SPPWK_RET_OK;
+}
+
+/* Set max length of copies of mirror. */
+int
+set_mirror_snaplen(int comp_id, unsigned int snaplen)
+{
+	if (unlikely(snaplen > SPPWK_MIR_SNAPLEN_MAX)) {
+		RTE_LOG(ERR, MIRROR, "Invalid snaplen %u.\n", snaplen);
+		return SPPWK_RET_NG;
+	}
+
+	g_mirror_conf[comp_id].snaplen = snaplen;
+	return SPPWK_RET_OK;
+}
+
+/* Set policy of mirror for packets not accepted by TX port. */
+int
+set_mirror_policy(int comp_id, enum sppwk_mir_policy policy)
+{
+	if (unlikely(policy != SPPWK_MIR_POLICY_DROP_MIRROR &&
+			policy != SPPWK_MIR_POLICY_KEEP_ORIGINAL &&
+			policy != SPPWK_MIR_POLICY_BLOCK)) {
+		RTE_LOG(ERR, MIRROR, "Invalid policy %d.\n", policy);
+		return SPPWK_RET_NG;
+	}
+
+	g_mirror_conf[comp_id].policy = policy;
+	return SPPWK_RET_OK;
+}
+
 /* Update mirror info */
 int
 update_mirror(struct sppwk_comp_info *wk_comp)
@@ -248,20 +587,18 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	int nof_tx = wk_comp->nof_tx;
 	struct mirror_info *info = &g_mirror_info[wk_comp->comp_id];
 	struct mirror_path *path = &info->path[info->upd_index];
+	struct mirror_conf *conf = &g_mirror_conf[wk_comp->comp_id];
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf_jit jit;
+#endif
 
-	/* Check mirror has just one RX and two TX port. */
+	/* Check mirror has just one RX port. */
 	if (unlikely(nof_rx > 1)) {
 		RTE_LOG(ERR, MIRROR,
 			"Invalid num of RX (id=%d, type=%d, nof_rx=%d)\n",
 			wk_comp->comp_id, wk_comp->wk_type, nof_rx);
 		return SPPWK_RET_NG;
 	}
-	if (unlikely(nof_tx > 2)) {
-		RTE_LOG(ERR, MIRROR,
-			"Invalid num of TX (id=%d, type=%d, nof_tx=%d)\n",
-			wk_comp->comp_id, wk_comp->wk_type, nof_tx);
-		return SPPWK_RET_NG;
-	}
 
 	memset(path, 0x00, sizeof(struct mirror_path));
 
@@ -271,21 +608,44 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 
 	memcpy(&path->name, wk_comp->name, STR_LEN_NAME);
 	path->wk_type = wk_comp->wk_type;
+	path->copy_mode = conf->copy_mode;
+	path->bpf = conf->bpf;
+#ifdef RTE_LIBRTE_BPF
+	/* Filter is run by the interpreter if JIT is not supported. */
+	if (conf->bpf != NULL && rte_bpf_get_jit(conf->bpf, &jit) == 0)
+		path->bpf_func = jit.func;
+#endif
+	path->sample = conf->sample;
+	if (conf->rate != 0)
+		path->rate_cycles = rte_get_tsc_hz() / conf->rate;
+	path->snaplen = conf->snaplen;
+	path->policy = conf->policy;
 	path->nof_rx = wk_comp->nof_rx;
 	path->nof_tx = wk_comp->nof_tx;
-	for (cnt = 0; cnt < nof_rx; cnt++)
+	for (cnt = 0; cnt < nof_rx; cnt++) {
 		memcpy(&path->ports[cnt].rx, wk_comp->rx_ports[cnt],
 				sizeof(struct sppwk_port_info));
+		path->ports[cnt].rx_queue = wk_comp->rx_queues[cnt];
+	}
 
 	/* Transmit port is set according with larger nof_rx / nof_tx. */
-	for (cnt = 0; cnt < nof_tx; cnt++)
+	for (cnt = 0; cnt < nof_tx; cnt++) {
 		memcpy(&path->ports[cnt].tx, wk_comp->tx_ports[cnt],
 				sizeof(struct sppwk_port_info));
+		path->ports[cnt].tx_queue = wk_comp->tx_queues[cnt];
+		if (unlikely(sppwk_get_tx_queue(wk_comp, cnt,
+				&path->ports[cnt].txq) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+	}
 
 	info->upd_index = info->ref_index;
 	while (likely(info->ref_index == info->upd_index))
 		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
 
+	/* Replaced filter is not referred by the lcore anymore. */
+	mirror_bpf_destroy(conf->bpf_retired);
+	conf->bpf_retired = NULL;
+
 	RTE_LOG(INFO, MIRROR,
 			"Done update mirror (id=%d, name=%s, type=%d)\n",
 			wk_comp->comp_id, wk_comp->name, wk_comp->wk_type);
@@ -293,6 +653,35 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Release copies buffered for ports which are not mirror ports of given
+ * path anymore. They are counted as dropped.
+ */
+static void
+mirror_txbuf_prune(int id, const struct mirror_path *path)
+{
+	int port_id, cnt, buf;
+	struct mirror_txbuf *txbuf;
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		txbuf = &g_mirror_txbufs[id][port_id];
+		if (likely(txbuf->len == 0))
+			continue;
+
+		for (cnt = 1; cnt < path->nof_tx; cnt++) {
+			if (path->ports[cnt].tx.ethdev_port_id == port_id)
+				break;
+		}
+		if (cnt < path->nof_tx)
+			continue;
+
+		for (buf = 0; buf < txbuf->len; buf++)
+			rte_pktmbuf_free(txbuf->pkts[buf]);
+		txbuf->dropped += txbuf->len;
+		txbuf->len = 0;
+	}
+}
+
 /* Change index of mirror info */
 static inline void
 change_mirror_index(int id)
@@ -302,14 +691,494 @@ change_mirror_index(int id)
 	/* Change reference index of port ability. */
 		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
 		info->ref_index = (info->upd_index+1) % TWO_SIDES;
+		mirror_txbuf_prune(id, &info->path[info->ref_index]);
+	}
+}
+
+/* Copy metadata of the first segment of packet. */
+static inline void
+copy_pkt_meta(struct rte_mbuf *dst, const struct rte_mbuf *src)
+{
+	dst->port = src->port;
+	dst->vlan_tci = src->vlan_tci;
+	dst->tx_offload = src->tx_offload;
+	dst->hash = src->hash;
+	dst->ol_flags = src->ol_flags;
+	dst->packet_type = src->packet_type;
+	dst->udata64 = 0;  /* Not to count stamp of chain trace again. */
+}
+
+/* Copy data of a segment. */
+static inline void
+copy_seg_data(struct rte_mbuf *dst, const struct rte_mbuf *src)
+{
+	dst->data_off = src->data_off;
+	dst->data_len = src->data_len;
+	rte_memcpy(rte_pktmbuf_mtod(dst, char *),
+			rte_pktmbuf_mtod(src, char *), src->data_len);
+}
+
+/**
+ * Clone packets with indirect mbufs allocated in bulk. Packets of multiple
+ * segments are cloned one by one because an indirect mbuf is needed for
+ * each of segments.
+ */
+static int
+mirror_clone_bulk(struct mirror_cnts *cnts, struct rte_mbuf **pkts,
+		struct rte_mbuf **copies, int nb_pkts)
+{
+	int i;
+	int nb_copies = 0;
+	struct rte_mbuf *copy;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(g_mirror_clone_pool, copies,
+			nb_pkts) != 0)) {
+		cnts->alloc_fails += nb_pkts;
+		return 0;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(pkts[i]->nb_segs == 1)) {
+			copy = copies[i];
+			rte_pktmbuf_attach(copy, pkts[i]);
+		} else {
+			rte_pktmbuf_free(copies[i]);
+			copy = rte_pktmbuf_clone(pkts[i], g_mirror_clone_pool);
+			if (unlikely(copy == NULL)) {
+				cnts->alloc_fails++;
+				continue;
+			}
+		}
+		/* Not to count stamp of chain trace again. */
+		copy->udata64 = 0;
+		copies[nb_copies++] = copy;
+	}
+	return nb_copies;
+}
+
+/**
+ * Copy packets with direct mbufs allocated in bulk. Mbufs of the second
+ * and later segments are allocated one by one.
+ */
+static int
+mirror_deep_copy_bulk(struct mirror_cnts *cnts, struct rte_mbuf **pkts,
+		struct rte_mbuf **copies, int nb_pkts)
+{
+	int i;
+	int nb_copies = 0;
+	struct rte_mbuf *copy, *last, *seg;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(g_mirror_pool, copies,
+			nb_pkts) != 0)) {
+		cnts->alloc_fails += nb_pkts;
+		return 0;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		copy = copies[i];
+		copy_pkt_meta(copy, pkts[i]);
+		copy_seg_data(copy, pkts[i]);
+		copy->pkt_len = pkts[i]->pkt_len;
+		copy->nb_segs = pkts[i]->nb_segs;
+
+		last = copy;
+		for (seg = pkts[i]->next; seg != NULL; seg = seg->next) {
+			last->next = rte_pktmbuf_alloc(g_mirror_pool);
+			if (unlikely(last->next == NULL))
+				break;
+			last = last->next;
+			copy_seg_data(last, seg);
+		}
+		if (unlikely(seg != NULL)) {
+			rte_pktmbuf_free(copy);
+			cnts->alloc_fails++;
+			continue;
+		}
+		copies[nb_copies++] = copy;
+	}
+	return nb_copies;
+}
+
+/**
+ * Copy header of packets to direct mbufs, and chain the rest of packets as
+ * indirect mbufs. Header of the copy can be modified, such as for VLAN
+ * tagging of the mirror port, without copying whole of payload.
+ */
+static int
+mirror_hdr_copy_bulk(struct mirror_cnts *cnts, struct rte_mbuf **pkts,
+		struct rte_mbuf **copies, int nb_pkts)
+{
+	int i;
+	int nb_copies = 0;
+	uint16_t hdr_len;
+	struct rte_mbuf *clones[MAX_PKT_BURST];
+	struct rte_mbuf *copy, *payload, *seg;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(g_mirror_pool, copies,
+			nb_pkts) != 0)) {
+		cnts->alloc_fails += nb_pkts;
+		return 0;
+	}
+	if (unlikely(rte_pktmbuf_alloc_bulk(g_mirror_clone_pool, clones,
+			nb_pkts) != 0)) {
+		for (i = 0; i < nb_pkts; i++)
+			rte_pktmbuf_free(copies[i]);
+		cnts->alloc_fails += nb_pkts;
+		return 0;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		copy = copies[i];
+		hdr_len = RTE_MIN(pkts[i]->data_len,
+				(uint16_t)SPP_MIRROR_HDR_LEN);
+		copy_pkt_meta(copy, pkts[i]);
+		copy->data_len = hdr_len;
+		copy->pkt_len = hdr_len;
+		rte_memcpy(rte_pktmbuf_mtod(copy, char *),
+				rte_pktmbuf_mtod(pkts[i], char *), hdr_len);
+
+		/* Whole of packet is in the header. */
+		if (pkts[i]->pkt_len == hdr_len) {
+			rte_pktmbuf_free(clones[i]);
+			copies[nb_copies++] = copy;
+			continue;
+		}
+
+		if (likely(pkts[i]->nb_segs == 1)) {
+			payload = clones[i];
+			rte_pktmbuf_attach(payload, pkts[i]);
+		} else {
+			rte_pktmbuf_free(clones[i]);
+			payload = rte_pktmbuf_clone(pkts[i],
+					g_mirror_clone_pool);
+			if (unlikely(payload == NULL)) {
+				rte_pktmbuf_free(copy);
+				cnts->alloc_fails++;
+				continue;
+			}
+		}
+		rte_pktmbuf_adj(payload, hdr_len);
+
+		/* Drop first segment of payload if it is consumed by header. */
+		if (payload->data_len == 0) {
+			seg = payload->next;
+			seg->pkt_len = payload->pkt_len;
+			seg->nb_segs = payload->nb_segs - 1;
+			rte_pktmbuf_free_seg(payload);
+			payload = seg;
+		}
+		if (unlikely(rte_pktmbuf_chain(copy, payload) != 0)) {
+			rte_pktmbuf_free(copy);
+			rte_pktmbuf_free(payload);
+			cnts->alloc_fails++;
+			continue;
+		}
+		copies[nb_copies++] = copy;
+	}
+	return nb_copies;
+}
+
+/* Truncate packet to `snaplen` bytes if it is longer. */
+static inline void
+mirror_truncate(struct rte_mbuf *pkt, uint32_t snaplen)
+{
+	uint32_t len = 0;
+	uint16_t nb_segs = 1;
+	struct rte_mbuf *seg = pkt;
+
+	if (pkt->pkt_len <= snaplen)
+		return;
+
+	while (len + seg->data_len < snaplen) {
+		len += seg->data_len;
+		seg = seg->next;
+		nb_segs++;
+	}
+	seg->data_len = (uint16_t)(snaplen - len);
+	if (seg->next != NULL) {
+		rte_pktmbuf_free(seg->next);
+		seg->next = NULL;
+	}
+	pkt->pkt_len = snaplen;
+	pkt->nb_segs = nb_segs;
+}
+
+/**
+ * Select packets to be copied with BPF filter and sampling. It is done
+ * before copying, so that no mbuf is consumed for packets not selected.
+ *
+ * @return Num of selected packets in `sel`.
+ */
+static inline int
+mirror_select_pkts(const struct mirror_path *path, struct mirror_cnts *cnts,
+		struct rte_mbuf **pkts, struct rte_mbuf **sel, int nb_pkts)
+{
+	int i;
+	int nb_sel = 0;
+	uint64_t now, max_credit;
+	uint64_t rc[MAX_PKT_BURST];
+
+	if (path->bpf != NULL) {
+		if (path->bpf_func != NULL) {
+			for (i = 0; i < nb_pkts; i++)
+				rc[i] = path->bpf_func(pkts[i]);
+		} else {
+#ifdef RTE_LIBRTE_BPF
+			rte_bpf_exec_burst(path->bpf, (void **)pkts, rc,
+					nb_pkts);
+#endif
+		}
+	}
+
+	/* Refill credit for the cycles passed since last burst. */
+	if (path->rate_cycles != 0) {
+		now = rte_get_tsc_cycles();
+		max_credit = path->rate_cycles * MAX_PKT_BURST;
+		cnts->credit += now - cnts->last_tsc;
+		if (cnts->credit > max_credit)
+			cnts->credit = max_credit;
+		cnts->last_tsc = now;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (path->bpf != NULL && rc[i] == 0) {
+			cnts->filtered++;
+			continue;
+		}
+		if (path->sample > 1 &&
+				++cnts->nof_skipped < path->sample) {
+			cnts->unsampled++;
+			continue;
+		}
+		if (path->rate_cycles != 0) {
+			if (cnts->credit < path->rate_cycles) {
+				cnts->unsampled++;
+				continue;
+			}
+			cnts->credit -= path->rate_cycles;
+		}
+		cnts->nof_skipped = 0;
+		sel[nb_sel++] = pkts[i];
+	}
+	return nb_sel;
+}
+
+/**
+ * Make copies of packets in copy mode of given path, and truncate them to
+ * snaplen. Copies failed to be allocated are not included in `copies`.
+ *
+ * @return Num of copies.
+ */
+static inline int
+mirror_copy_pkts(const struct mirror_path *path,
+		struct mirror_cnts *cnts, struct rte_mbuf **pkts,
+		struct rte_mbuf **copies, int nb_pkts)
+{
+	int i, nb_copies;
+
+	switch (path->copy_mode) {
+	case SPPWK_MIR_COPY_DEEP:
+		for (i = 0; i < nb_pkts; i++)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+		nb_copies = mirror_deep_copy_bulk(cnts, pkts, copies, nb_pkts);
+		break;
+	case SPPWK_MIR_COPY_HEADER:
+		for (i = 0; i < nb_pkts; i++)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+		nb_copies = mirror_hdr_copy_bulk(cnts, pkts, copies, nb_pkts);
+		break;
+	default:
+		nb_copies = mirror_clone_bulk(cnts, pkts, copies, nb_pkts);
+		break;
+	}
+
+	if (path->snaplen != 0) {
+		for (i = 0; i < nb_copies; i++)
+			mirror_truncate(copies[i], path->snaplen);
+	}
+
+	cnts->copies += nb_copies;
+	return nb_copies;
+}
+
+/**
+ * Send packets to TX port of mirror, and count packets sent. If `retry` is
+ * 1, packets not accepted are sent again until the port accepts all of them
+ * or retries are exceeded. It makes the component slow down to the port.
+ *
+ * @return Num of packets sent.
+ */
+static inline uint16_t
+mirror_tx_burst(struct mirror_rxtx *port, struct mirror_txbuf *txbuf,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, int retry)
+{
+	uint16_t nb_tx;
+	unsigned int nof_retries = 0;
+
+	nb_tx = sppwk_eth_tx_burst(port->tx.ethdev_port_id, &port->txq,
+			pkts, nb_pkts);
+	while (retry && nb_tx < nb_pkts &&
+			nof_retries < SPP_MIRROR_TX_RETRY_MAX) {
+		rte_pause();
+		nb_tx += sppwk_eth_tx_burst(port->tx.ethdev_port_id,
+				&port->txq, pkts + nb_tx, nb_pkts - nb_tx);
+		nof_retries++;
+	}
+
+	txbuf->retries += nof_retries;
+	txbuf->sent += nb_tx;
+	return nb_tx;
+}
+
+/* Send copies in TX buffer, and keep ones not sent in the buffer. */
+static inline void
+mirror_txbuf_flush(struct mirror_rxtx *port, struct mirror_txbuf *txbuf,
+		int retry)
+{
+	uint16_t nb_tx;
+
+	if (txbuf->len == 0)
+		return;
+
+	nb_tx = mirror_tx_burst(port, txbuf, txbuf->pkts, txbuf->len, retry);
+	if (nb_tx < txbuf->len)
+		memmove(txbuf->pkts, txbuf->pkts + nb_tx,
+				sizeof(struct rte_mbuf *) *
+				(txbuf->len - nb_tx));
+	txbuf->len -= nb_tx;
+}
+
+/**
+ * Make copies of packets for mirror ports, which are TX ports other than
+ * the first one, and add them to TX buffers of the ports. Copies more than
+ * the room of a buffer are dropped, or the buffer is flushed until it has
+ * the room in block policy. In shallow copy mode, a set of copies is shared
+ * among phy mirror ports by adding to refcnt of mbufs because the copies are
+ * not writable anyway. Ring and vhost ports are given their own clones
+ * because packets passed to them can be modified by other processes. In
+ * other modes, each of mirror ports is given its own copies so that they
+ * can be modified independently.
+ */
+static inline void
+mirror_buffer_copies(int id, struct mirror_path *path,
+		struct rte_mbuf **pkts, int nb_pkts)
+{
+	int cnt, buf;
+	int nb_copy = 0;
+	int nb_max = 0;
+	int nof_mirs = 0;
+	int nb_take;
+	int16_t nof_refs;
+	int mir_ports[RTE_MAX_ETHPORTS];
+	int rooms[RTE_MAX_ETHPORTS];
+	int shared[RTE_MAX_ETHPORTS];
+	struct mirror_rxtx *port;
+	struct mirror_txbuf *txbuf;
+	struct mirror_cnts *cnts = &g_mirror_cnts[id];
+	struct rte_mbuf *sel[MAX_PKT_BURST];
+	struct rte_mbuf *copybufs[MAX_PKT_BURST];
+	struct rte_mbuf *ownbufs[MAX_PKT_BURST];
+	struct rte_mbuf **bufs;
+
+	for (cnt = 1; cnt < path->nof_tx; cnt++) {
+		if (path->ports[cnt].tx.ethdev_port_id >= 0)
+			mir_ports[nof_mirs++] = cnt;
+	}
+	if (unlikely(nof_mirs == 0))
+		return;
+
+	if (path->bpf != NULL || path->sample > 1 || path->rate_cycles != 0) {
+		nb_pkts = mirror_select_pkts(path, cnts, pkts, sel, nb_pkts);
+		if (nb_pkts == 0)
+			return;
+		pkts = sel;
+	}
+
+	/* Copies are not made for ports of no room in its buffer. */
+	for (cnt = 0; cnt < nof_mirs; cnt++) {
+		port = &path->ports[mir_ports[cnt]];
+		txbuf = &g_mirror_txbufs[id][port->tx.ethdev_port_id];
+		if (path->policy == SPPWK_MIR_POLICY_BLOCK &&
+				SPP_MIRROR_TXBUF_SIZE - txbuf->len < nb_pkts)
+			mirror_txbuf_flush(port, txbuf, 1);
+		rooms[cnt] = RTE_MIN(nb_pkts,
+				SPP_MIRROR_TXBUF_SIZE - txbuf->len);
+		shared[cnt] = (path->copy_mode == SPPWK_MIR_COPY_SHALLOW &&
+				port->tx.iface_type == PHY);
+		if (shared[cnt])
+			nb_max = RTE_MAX(nb_max, rooms[cnt]);
+	}
+
+	/**
+	 * Each of shared ports takes copies from the head of `copybufs` as
+	 * many as its room, so that a copy is referred by shared ports of room
+	 * larger than the index of the copy.
+	 */
+	if (nb_max > 0) {
+		nb_copy = mirror_copy_pkts(path, cnts, pkts, copybufs,
+				nb_max);
+		for (buf = 0; buf < nb_copy; buf++) {
+			nof_refs = 0;
+			for (cnt = 0; cnt < nof_mirs; cnt++) {
+				if (shared[cnt] && rooms[cnt] > buf)
+					nof_refs++;
+			}
+			if (nof_refs > 1)
+				rte_pktmbuf_refcnt_update(copybufs[buf],
+						(int16_t)(nof_refs - 1));
+		}
+	}
+
+	for (cnt = 0; cnt < nof_mirs; cnt++) {
+		port = &path->ports[mir_ports[cnt]];
+		txbuf = &g_mirror_txbufs[id][port->tx.ethdev_port_id];
+		if (shared[cnt]) {
+			bufs = copybufs;
+			nb_take = RTE_MIN(rooms[cnt], nb_copy);
+		} else {
+			bufs = ownbufs;
+			nb_take = 0;
+			if (rooms[cnt] > 0)
+				nb_take = mirror_copy_pkts(path, cnts, pkts,
+						ownbufs, rooms[cnt]);
+		}
+
+		/* Count copies not given to the port as dropped. */
+		txbuf->dropped += nb_pkts - nb_take;
+		if (nb_take == 0)
+			continue;
+		memcpy(&txbuf->pkts[txbuf->len], bufs,
+				sizeof(struct rte_mbuf *) * nb_take);
+		txbuf->len += nb_take;
+	}
+}
+
+/**
+ * Send copies in TX buffers of mirror ports. Copies are retried until sent
+ * in block policy, or remained in the buffers to be sent in the next loop.
+ */
+static inline void
+mirror_flush_copies(int id, struct mirror_path *path)
+{
+	int cnt;
+	struct mirror_rxtx *port;
+
+	for (cnt = 1; cnt < path->nof_tx; cnt++) {
+		port = &path->ports[cnt];
+		if (port->tx.ethdev_port_id < 0)
+			continue;
+		mirror_txbuf_flush(port,
+				&g_mirror_txbufs[id][port->tx.ethdev_port_id],
+				path->policy == SPPWK_MIR_POLICY_BLOCK);
 	}
 }
 
 /**
  * Mirroring packets as mirror_proc
  *
- * Behavior of forwarding is defined as core_info->type which is given
- * as an argument of void and typecasted to spp_config_info.
+ * Original packets are sent to the first TX port, and copies are sent to
+ * the rest of TX ports. Copies are sent after the original, so that the
+ * original is not delayed by sending copies to slow mirror ports.
  */
 static int
 mirror_proc(int id)
@@ -317,124 +1186,59 @@ mirror_proc(int id)
 	int cnt, buf;
 	int nb_rx = 0;
 	int nb_tx = 0;
-	int nb_tx1 = 0;
-	int nb_tx2 = 0;
 	struct mirror_info *info = &g_mirror_info[id];
 	struct mirror_path *path = NULL;
 	struct sppwk_port_info *rx = NULL;
 	struct sppwk_port_info *tx = NULL;
+	struct mirror_txbuf *txbuf;
 	struct rte_mbuf *bufs[MAX_PKT_BURST];
-	struct rte_mbuf *copybufs[MAX_PKT_BURST];
-	struct rte_mbuf *org_mbuf = NULL;
 
 	change_mirror_index(id);
 	path = &info->path[info->ref_index];
 
 	/* Practice condition check */
-	if (!(path->nof_tx == 2 && path->nof_rx == 1))
+	if (!(path->nof_tx >= 2 && path->nof_rx == 1))
 		return SPPWK_RET_OK;
 
 	rx = &path->ports[0].rx;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	nb_rx = sppwk_eth_ring_stats_rx_burst(rx->ethdev_port_id,
-			rx->iface_type, rx->iface_no, 0, bufs, MAX_PKT_BURST);
-#else
-	nb_rx = rte_eth_rx_burst(rx->ethdev_port_id, 0, bufs, MAX_PKT_BURST);
-#endif
+	nb_rx = sppwk_eth_rx_burst(rx->ethdev_port_id, path->ports[0].rx_queue,
+			bufs, MAX_PKT_BURST);
 
-	if (unlikely(nb_rx == 0))
-		return SPPWK_RET_OK;
+	/* Send packets staged by other lcores sharing TX queues. */
+	for (cnt = 0; cnt < path->nof_tx; cnt++) {
+		tx = &path->ports[cnt].tx;
+		if (tx->ethdev_port_id >= 0)
+			sppwk_eth_tx_drain(tx->ethdev_port_id,
+					&path->ports[cnt].txq);
+	}
 
-	/* mirror */
-	tx = &path->ports[1].tx;
-	if (tx->ethdev_port_id >= 0) {
-		nb_tx2 = 0;
-		for (cnt = 0; cnt < nb_rx; cnt++) {
-			org_mbuf = bufs[cnt];
-			rte_prefetch0(rte_pktmbuf_mtod(org_mbuf, void *));
-#ifdef SPP_MIRROR_SHALLOWCOPY
-			/* Shallow Copy */
-			copybufs[cnt] = rte_pktmbuf_clone(org_mbuf,
-							g_mirror_pool);
-#else
-			struct rte_mbuf *mirror_mbuf = NULL;
-			struct rte_mbuf **mirror_mbufs = &mirror_mbuf;
-			struct rte_mbuf *copy_mbuf = NULL;
-			/* Deep Copy */
-			do {
-				copy_mbuf = rte_pktmbuf_alloc(g_mirror_pool);
-				if (unlikely(copy_mbuf == NULL)) {
-					rte_pktmbuf_free(mirror_mbuf);
-					mirror_mbuf = NULL;
-					RTE_LOG(INFO, MIRROR,
-						"copy mbuf alloc NG!\n");
-					break;
-				}
-
-				copy_mbuf->data_off = org_mbuf->data_off;
-				copy_mbuf->data_len = org_mbuf->data_len;
-				copy_mbuf->port = org_mbuf->port;
-				copy_mbuf->vlan_tci = org_mbuf->vlan_tci;
-				copy_mbuf->tx_offload = org_mbuf->tx_offload;
-				copy_mbuf->hash = org_mbuf->hash;
-
-				copy_mbuf->next = NULL;
-				copy_mbuf->pkt_len = org_mbuf->pkt_len;
-				copy_mbuf->nb_segs = org_mbuf->nb_segs;
-				copy_mbuf->ol_flags = org_mbuf->ol_flags;
-				copy_mbuf->packet_type = org_mbuf->packet_type;
-
-				rte_memcpy(rte_pktmbuf_mtod(copy_mbuf, char *),
-					rte_pktmbuf_mtod(org_mbuf, char *),
-					org_mbuf->data_len);
-
-				*mirror_mbufs = copy_mbuf;
-				mirror_mbufs = &copy_mbuf->next;
-			} while ((org_mbuf = org_mbuf->next) != NULL);
-			copybufs[cnt] = mirror_mbuf;
-
-#endif /* SPP_MIRROR_SHALLOWCOPY */
+	if (likely(nb_rx != 0)) {
+		/**
+		 * Make copies before sending the original, because it might
+		 * be released before copied if it is sent.
+		 */
+		mirror_buffer_copies(id, path, bufs, nb_rx);
+
+		/* orginal */
+		tx = &path->ports[0].tx;
+		if (tx->ethdev_port_id >= 0) {
+			txbuf = &g_mirror_txbufs[id][tx->ethdev_port_id];
+			nb_tx = mirror_tx_burst(&path->ports[0], txbuf, bufs,
+					nb_rx, path->policy !=
+					SPPWK_MIR_POLICY_DROP_MIRROR);
+			txbuf->dropped += nb_rx - nb_tx;
 		}
 
-		if (cnt != 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx2 = sppwk_eth_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, copybufs, cnt);
-#else
-			nb_tx2 = rte_eth_tx_burst(tx->ethdev_port_id, 0,
-					copybufs, cnt);
-#endif
+		/* Discard remained packets to release mbuf */
+		if (unlikely(nb_tx < nb_rx)) {
+			for (buf = nb_tx; buf < nb_rx; buf++)
+				rte_pktmbuf_free(bufs[buf]);
+		}
 	}
 
-	/* orginal */
-	tx = &path->ports[0].tx;
-	if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		nb_tx1 = sppwk_eth_ring_stats_tx_burst(tx->ethdev_port_id,
-				tx->iface_type, tx->iface_no, 0, bufs, nb_rx);
-#else
-		nb_tx1 = rte_eth_tx_burst(tx->ethdev_port_id, 0, bufs, nb_rx);
-#endif
-	nb_tx = nb_tx1;
-
-	if (nb_tx1 != nb_tx2)
-		RTE_LOG(INFO, MIRROR,
-			"mirror paket drop nb_rx=%d nb_tx1=%d nb_tx2=%d\n",
-							nb_rx, nb_tx1, nb_tx2);
-
-	/* Discard remained packets to release mbuf */
-	if (nb_tx1 < nb_tx2)
-		nb_tx = nb_tx2;
-	if (unlikely(nb_tx < nb_rx)) {
-		for (buf = nb_tx; buf < nb_rx; buf++)
-			rte_pktmbuf_free(bufs[buf]);
-	}
-	if (unlikely(nb_tx2 < nb_rx)) {
-		for (buf = nb_tx2; buf < nb_rx; buf++)
-			rte_pktmbuf_free(copybufs[buf]);
-	}
+	/* Copies remained in the last loop are also sent. */
+	mirror_flush_copies(id, path);
 	return SPPWK_RET_OK;
 }
 
@@ -448,14 +1252,19 @@ slave_main(void *arg __attribute__ ((unused)))
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
 	struct core_mng_info *info = &g_core_info[lcore_id];
 	struct core_info *core = get_core_info(lcore_id);
+	struct sppwk_lcore_cnts *cnts = sppwk_lcore_cnts();
+	uint64_t start, nof_rx, nof_rx_poll;
+	struct idle_state idle = { 0 };
 
 	RTE_LOG(INFO, MIRROR, "Slave started on lcore %d.\n", lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_IDLING);
 
 	while ((status = sppwk_get_lcore_status(lcore_id)) !=
 			SPPWK_LCORE_REQ_STOP) {
-		if (status != SPPWK_LCORE_RUNNING)
+		if (status != SPPWK_LCORE_RUNNING) {
+			idle_policy_stopped(&idle);
 			continue;
+		}
 
 		if (sppwk_is_lcore_updated(lcore_id) == 1) {
 			/* Setting with the flush command trigger. */
@@ -463,14 +1272,19 @@ slave_main(void *arg __attribute__ ((unused)))
 			core = get_core_info(lcore_id);
 		}
 
+		nof_rx_poll = cnts->nof_rx;
 		for (cnt = 0; cnt < core->num; cnt++) {
 			/*
 			 * mirror returns at once.
 			 * It is for processing multiple components.
 			 */
+			start = rte_rdtsc();
+			nof_rx = cnts->nof_rx;
 			ret = mirror_proc(core->id[cnt]);
 			if (unlikely(ret != 0))
 				break;
+			sppwk_cnt_cycles(core->id[cnt], rte_rdtsc() - start,
+					cnts->nof_rx - nof_rx);
 		}
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, MIRROR,
@@ -478,6 +1292,7 @@ slave_main(void *arg __attribute__ ((unused)))
 					lcore_id, core->id[cnt]);
 			break;
 		}
+		idle_policy_poll(&idle, cnts->nof_rx - nof_rx_poll);
 	}
 
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
@@ -568,24 +1383,13 @@ main(int argc, char *argv[])
 		if (unlikely(ret_cmd_init != SPPWK_RET_OK))
 			break;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		int port_type, port_id;
-		char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
-		int nof_rings = 0;
-		for (int i = 0; i < RTE_MAX_ETHPORTS; i++) {
-			if (!rte_eth_dev_is_valid_port(i))
-				continue;
-			rte_eth_dev_get_name_by_port(i, dev_name);
-			ret = parse_dev_name(dev_name, &port_type, &port_id);
-			if (port_type == RING)
-				nof_rings++;
-		}
-		int ret_ringlatency = sppwk_init_ring_latency_stats(
-				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL,
-				nof_rings);
-		if (unlikely(ret_ringlatency != SPPWK_RET_OK))
+		sppwk_init_ring_latency_stats(
+				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL);
+		chain_trace_init(CHAIN_TRACE_SAMPLING_INTERVAL);
+
+		if (unlikely(sppwk_telemetry_init(get_client_id(), "mirror")
+				!= SPPWK_RET_OK))
 			break;
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 
 		/* Start worker threads of classifier and forwarder */
 		lcore_id = 0;
@@ -601,13 +1405,7 @@ main(int argc, char *argv[])
 
 		/* Start forwarding */
 		set_all_core_status(SPPWK_LCORE_RUNNING);
-#ifdef SPP_MIRROR_SHALLOWCOPY
-		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling messagei(ShallowCopy)\n", 0);
-#else
-		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling message(DeepCopy)\n", 0);
-#endif /* #ifdef SPP_MIRROR_SHALLOWCOPY */
+		RTE_LOG(INFO, MIRROR, "My ID %d start handling message\n", 0);
 		RTE_LOG(INFO, MIRROR, "[Press Ctrl-C to quit ...]\n");
 
 		/* Backup the management information after initialization */
@@ -627,10 +1425,7 @@ main(int argc, char *argv[])
 			 * here for 100 ms.
 			 */
 			usleep(100);
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			print_ring_latency_stats(&g_iface_info);
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+			sppwk_telemetry_update(sppwk_fill_telemetry);
 		}
 
 		if (unlikely(ret_do != SPPWK_RET_OK)) {
@@ -651,9 +1446,8 @@ main(int argc, char *argv[])
 	 /* Remove vhost sock file if not running in vhost-client mode. */
 	del_vhost_sockfile(g_iface_info.vhost);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 	sppwk_clean_ring_latency_stats();
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+	chain_trace_clean();
 
 	RTE_LOG(INFO, MIRROR, "Exit spp_mirror.\n");
 	return ret;
@@ -685,12 +1479,14 @@ get_mirror_status(unsigned int lcore_id, int id,
 	for (cnt = 0; cnt < path->nof_rx; cnt++) {
 		rx_ports[cnt].iface_type = path->ports[cnt].rx.iface_type;
 		rx_ports[cnt].iface_no   = path->ports[cnt].rx.iface_no;
+		rx_ports[cnt].queue_id   = path->ports[cnt].rx_queue;
 	}
 
 	memset(tx_ports, 0x00, sizeof(tx_ports));
 	for (cnt = 0; cnt < path->nof_tx; cnt++) {
 		tx_ports[cnt].iface_type = path->ports[cnt].tx.iface_type;
 		tx_ports[cnt].iface_no   = path->ports[cnt].tx.iface_no;
+		tx_ports[cnt].queue_id   = path->ports[cnt].tx_queue;
 	}
 
 	/* Set the information with the function specified by the command. */
@@ -702,3 +1498,223 @@ get_mirror_status(unsigned int lcore_id, int id,
 
 	return SPPWK_RET_OK;
 }
+
+/* Add options and counters of a mirror in JSON. */
+static int
+append_mirror_table_value(char **output, int id,
+		const struct mirror_path *path)
+{
+	int ret;
+	const struct mirror_cnts *cnts = &g_mirror_cnts[id];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_str_value(&tmp_buff, "name", path->name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "copy",
+				MIR_COPY_STR_LIST[path->copy_mode]);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "filter",
+				g_mirror_conf[id].filter);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "sample",
+				g_mirror_conf[id].sample);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "rate",
+				g_mirror_conf[id].rate);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "snaplen",
+				g_mirror_conf[id].snaplen);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "policy",
+				MIR_POLICY_STR_LIST[path->policy]);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "copies",
+				cnts->copies);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "alloc_fails",
+				cnts->alloc_fails);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "filtered",
+				cnts->filtered);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "unsampled",
+				cnts->unsampled);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add options and counters of each of mirrors in JSON. */
+int
+add_mirror_table(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int id;
+	int ret = SPPWK_RET_OK;
+	struct mirror_info *info;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (id = 0; id < RTE_MAX_LCORE && ret == SPPWK_RET_OK; id++) {
+		if (sppwk_get_comp_type(id) != SPPWK_TYPE_MIR)
+			continue;
+
+		info = &g_mirror_info[id];
+		ret = append_mirror_table_value(&tmp_buff, id,
+				&info->path[info->ref_index]);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add counters of a TX port of a mirror in JSON. */
+static int
+append_mirror_port_value(char **output, const char *name,
+		const struct sppwk_port_info *tx, int is_orig,
+		const struct mirror_txbuf *txbuf)
+{
+	int ret;
+	char port_uid[STR_LEN_SHORT];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_port_uid(port_uid, tx->iface_type, tx->iface_no);
+	ret = append_json_str_value(&tmp_buff, "name", name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "port", port_uid);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "role",
+				is_orig ? "original" : "mirror");
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "sent",
+				txbuf->sent);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "dropped",
+				txbuf->dropped);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "retries",
+				txbuf->retries);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "queued",
+				txbuf->len);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Add counters of each of TX ports of mirrors in JSON. Counters are read
+ * while lcores update them, so the result might be slightly behind.
+ */
+int
+add_mirror_ports(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int id, cnt;
+	int ret = SPPWK_RET_OK;
+	struct mirror_info *info;
+	struct mirror_path *path;
+	struct sppwk_port_info *tx;
+	struct mirror_txbuf *txbufs;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (id = 0; id < RTE_MAX_LCORE && ret == SPPWK_RET_OK; id++) {
+		if (sppwk_get_comp_type(id) != SPPWK_TYPE_MIR ||
+				g_mirror_txbufs[id] == NULL)
+			continue;
+
+		info = &g_mirror_info[id];
+		path = &info->path[info->ref_index];
+		txbufs = g_mirror_txbufs[id];
+		for (cnt = 0; cnt < path->nof_tx && ret == SPPWK_RET_OK;
+				cnt++) {
+			tx = &path->ports[cnt].tx;
+			if (tx->ethdev_port_id < 0)
+				continue;
+			ret = append_mirror_port_value(&tmp_buff, path->name,
+					tx, cnt == 0,
+					&txbufs[tx->ethdev_port_id]);
+		}
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add num of mbufs in use of a mempool in JSON. */
+static int
+append_mirror_pool_value(char **output, const struct rte_mempool *mp)
+{
+	int ret;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_str_value(&tmp_buff, "name", mp->name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "size", mp->size);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "in_use",
+				rte_mempool_in_use_count(mp));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Add usage of mempools of mirror in JSON. Num of mbufs in use includes
+ * ones in caches of lcores.
+ */
+int
+add_mirror_pool(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_mirror_pool_value(&tmp_buff, g_mirror_pool);
+	if (ret == SPPWK_RET_OK)
+		ret = append_mirror_pool_value(&tmp_buff, g_mirror_clone_pool);
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
@@ -25,4 +25,97 @@
 int get_mirror_status(unsigned int lcore_id, int id,
 		struct sppwk_lcore_params *params);
 
+/**
+ * Clear options, counters and TX buffers of mirror. TX buffers are
+ * allocated if they are not allocated yet or released before.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int init_mirror_conf(int comp_id);
+
+/**
+ * Release TX buffers of mirror with copies remained in them. It must be
+ * called after the lcore stopped referring the component.
+ *
+ * @param[in] comp_id Unique component ID.
+ */
+void release_mirror_txbufs(int comp_id);
+
+/**
+ * Set copy mode of mirror. It is applied to the component after flushed.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] copy_mode Shallow, deep or header.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_copy_mode(int comp_id, enum sppwk_mir_copy_mode copy_mode);
+
+/**
+ * Load BPF filter of mirror from ELF file. Only packets for which the filter
+ * returns non-zero are copied. It is applied to the component after flushed.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] fname ELF file of the filter, or empty string for removing it.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_filter(int comp_id, const char *fname);
+
+/**
+ * Set interval of sampling of mirror to copy 1 in `sample` packets.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] sample Interval of sampling, or 1 for all of packets.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_sample(int comp_id, unsigned int sample);
+
+/**
+ * Set max rate of copies of mirror.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] rate Packets per second, or 0 for unlimited.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_rate(int comp_id, unsigned int rate);
+
+/**
+ * Set max length of copies of mirror. Copies are truncated to the length.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] snaplen Length in bytes, or 0 for whole of packet.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_snaplen(int comp_id, unsigned int snaplen);
+
+/**
+ * Set policy of mirror for packets not accepted by TX ports. Copies are
+ * dropped if TX buffer is full in `drop_mirror` and `keep_original`, and
+ * originals are retried in `keep_original` and `block`.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] policy drop_mirror, keep_original or block.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_mirror_policy(int comp_id, enum sppwk_mir_policy policy);
+
+/* Add options and counters of each of mirrors to status in JSON. */
+int add_mirror_table(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/* Add counters of each of TX ports of mirrors to status in JSON. */
+int add_mirror_ports(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/* Add usage of mempools of mirror to status in JSON. */
+int add_mirror_pool(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
 #endif /* __SPP_MIRROR_H__ */
@@ -9,6 +9,7 @@
 #include "shared/secondary/common.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
+#include "shared/chain_trace.h"
 
 #define RTE_LOGTYPE_SPP_NFV RTE_LOGTYPE_USER1
 
@@ -345,6 +346,29 @@ parse_command(char *str)
 				"\"result\"", result,
 				"\"command\"", "\"del\"",
 				"\"port\"", port_set);
+
+	} else if (!strcmp(token_list[0], "chain_trace")) {
+		RTE_LOG(DEBUG, SPP_NFV, "chain_trace\n");
+
+		if (max_token <= 1)
+			return 0;
+
+		if (!strcmp(token_list[1], "on") &&
+				chain_trace_set(1) == 0)
+			sprintf(result, "%s", "\"succeeded\"");
+		else if (!strcmp(token_list[1], "off") &&
+				chain_trace_set(0) == 0)
+			sprintf(result, "%s", "\"succeeded\"");
+		else {
+			RTE_LOG(ERR, SPP_NFV, "Failed to chain_trace %s\n",
+					token_list[1]);
+			sprintf(result, "%s", "\"failed\"");
+		}
+
+		memset(str, '\0', MSG_SIZE);
+		sprintf(str, "{%s:%s,%s:%s}",
+				"\"result\"", result,
+				"\"command\"", "\"chain_trace\"");
 	}
 
 	return ret;
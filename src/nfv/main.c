@@ -17,6 +17,8 @@
 #include "shared/secondary/common.h"
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
+#include "shared/idle_policy.h"
+#include "shared/chain_trace.h"
 
 #include "params.h"
 #include "nfv_status.h"
@@ -38,10 +40,12 @@ uint8_t lcore_id_used[RTE_MAX_LCORE] = {};
 enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_ENABLE_VHOST_CLI,
+	CMD_OPT_IDLE_POLICY,
 };
 
 static struct option lgopts[] = {
 	{"vhost-client", no_argument, NULL, CMD_OPT_ENABLE_VHOST_CLI},
+	{"idle-policy", required_argument, NULL, CMD_OPT_IDLE_POLICY},
 	{0}
 };
 
@@ -52,9 +56,9 @@ static void
 usage(const char *progname)
 {
 	RTE_LOG(INFO, SPP_NFV,
-		"Usage: %s [EAL args] -- %s %s %s\n\n",
+		"Usage: %s [EAL args] -- %s %s %s %s\n\n",
 		progname, "-n <client_id>", "-s <ipaddr:port>",
-		"--vhost-client");
+		"--vhost-client", "--idle-policy <pause,sleep,max_us>");
 }
 
 /*
@@ -80,6 +84,12 @@ parse_app_args(int argc, char *argv[])
 		case CMD_OPT_ENABLE_VHOST_CLI:
 			set_vhost_cli_mode(1);
 			break;
+		case CMD_OPT_IDLE_POLICY:
+			if (parse_idle_policy(optarg) != 0) {
+				usage(progname);
+				return -1;
+			}
+			break;
 		case 'n':
 			if (parse_client_id(&cli_id, optarg) != 0) {
 				usage(progname);
@@ -110,16 +120,16 @@ static void
 nfv_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	struct idle_state idle = { 0 };
 
 	RTE_LOG(INFO, SPP_NFV, "entering main loop on lcore %u\n", lcore_id);
 
 	while (1) {
 		if (unlikely(cmd == STOP)) {
-			sleep(1);
-			/*RTE_LOG(INFO, SPP_NFV, "Idling\n");*/
+			idle_policy_stopped(&idle);
 			continue;
 		} else if (cmd == FORWARD) {
-			forward();
+			idle_policy_poll(&idle, forward_with_cycles(lcore_id));
 		}
 	}
 }
@@ -225,6 +235,8 @@ main(int argc, char *argv[])
 
 	}
 
+	chain_trace_init(CHAIN_TRACE_SAMPLING_INTERVAL);
+
 	/* Inspect lcores in use. */
 	RTE_LCORE_FOREACH(lcore_id) {
 		lcore_id_used[lcore_id] = 1;
@@ -273,6 +285,7 @@ main(int argc, char *argv[])
 	/* exit */
 	close(sock);
 	sock = SOCK_RESET;
+	chain_trace_clean();
 	RTE_LOG(INFO, SPP_NFV, "spp_nfv exit.\n");
 	return 0;
 }
@@ -5,7 +5,10 @@
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include "shared/common.h"
+#include "shared/basic_forwarder.h"
+#include "shared/chain_trace.h"
 #include "nfv_status.h"
 
 /*
@@ -22,6 +25,13 @@
  *     "patches": [
  *       {"src":"phy:0","dst": "ring:0"},
  *       {"src":"ring:0","dst": "vhost:0"}
+ *     ],
+ *     "lcore_cycles": [
+ *       {"core": 1, "busy": 1024, "idle": 2048, "pkts": 32}
+ *     ],
+ *     "chain_latency": [
+ *       {"port": "ring:0", "point": "hop", "count": 120,
+ *        "p50": 1536, "p99": 3072, "p999": 4096, "max": 5120}
  *     ]
  *   }
  */
@@ -32,6 +42,8 @@ get_sec_stats_json(char *str, int cli_id,
 		struct port *ports_fwd_array,
 		struct port_map *port_map)
 {
+	int nof_omitted;
+
 	sprintf(str, "{\"client-id\":%d,", cli_id);
 
 	sprintf(str + strlen(str), "\"status\":");
@@ -44,6 +56,18 @@ get_sec_stats_json(char *str, int cli_id,
 	sprintf(str + strlen(str), ",");
 
 	append_patch_info_json(str, ports_fwd_array, port_map);
+	sprintf(str + strlen(str), ",");
+
+	/* Keep space for `,` and closing `}`. */
+	nof_omitted = append_lcore_cycles_json(str, MSG_SIZE - 2);
+	if (nof_omitted > 0)
+		RTE_LOG(ERR, SHARED, "Cannot send lcore_cycles of %d lcores\n",
+				nof_omitted);
+	sprintf(str + strlen(str), ",");
+
+	/* Keep space for closing `}`. */
+	append_chain_latency_json(str, MSG_SIZE - 1, ports_fwd_array,
+			port_map);
 	sprintf(str + strlen(str), "}");
 
 	/* Make sure to be terminated with null character. */
@@ -285,3 +309,62 @@ append_patch_info_json(char *str,
 
 	return 0;
 }
+
+/*
+ * Append percentiles of latency from the ingress of service chain to sec
+ * status. It is called from get_sec_stats_json(). Phy ports are egress and
+ * ring ports are hops of the chain. Here is an example.
+ *
+ *     "chain_latency": [
+ *       {"port":"phy:1","point":"egress","count":120,
+ *        "p50":1536,"p99":3072,"p999":4096,"max":5120}
+ *      ]
+ */
+int
+append_chain_latency_json(char *str, size_t size,
+		struct port *ports_fwd_array,
+		struct port_map *port_map)
+{
+	unsigned int i;
+	size_t len = strlen(str);
+	char entry[256];
+	int nof_entries = 0;
+	enum chain_trace_point point;
+	struct lat_hist hist;
+	struct lat_summary summary;
+
+	/* Keep space for closing `]` and terminating null character. */
+	if (len + strlen("\"chain_latency\":[]") >= size)
+		return -1;
+	len += sprintf(str + len, "\"chain_latency\":[");
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (ports_fwd_array[i].in_port_id == PORT_RESET)
+			continue;
+		if (port_map[i].port_type != PHY &&
+				port_map[i].port_type != RING)
+			continue;
+		if (chain_trace_get_hist(i, &point, &hist) < 0)
+			continue;
+		lat_hist_summarize(&hist, rte_get_tsc_hz(), &summary);
+
+		snprintf(entry, sizeof(entry),
+				"%s{\"port\":\"%s:%u\",\"point\":\"%s\""
+				",\"count\":%"PRIu64",\"p50\":%"PRIu64
+				",\"p99\":%"PRIu64",\"p999\":%"PRIu64
+				",\"max\":%"PRIu64"}",
+				nof_entries > 0 ? "," : "",
+				port_map[i].port_type == PHY ? "phy" : "ring",
+				port_map[i].id,
+				point == CHAIN_TRACE_EDGE ? "egress" : "hop",
+				summary.count, summary.p50, summary.p99,
+				summary.p999, summary.max);
+		/* Omit ports which cannot be contained in the buffer. */
+		if (len + strlen(entry) + 1 >= size)
+			break;
+		len += sprintf(str + len, "%s", entry);
+		nof_entries++;
+	}
+	sprintf(str + len, "]");
+	return 0;
+}
@@ -25,4 +25,12 @@ int append_patch_info_json(char *str,
 		struct port *ports_fwd_array,
 		struct port_map *port_map);
 
+/**
+ * Append latency of service chain to sec status, called from
+ * get_sec_stats_json(). Entries are omitted if exceeding `size`.
+ */
+int append_chain_latency_json(char *str, size_t size,
+		struct port *ports_fwd_array,
+		struct port_map *port_map);
+
 #endif
@@ -4,6 +4,7 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include <rte_log.h>
 
@@ -120,6 +121,30 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Append JSON formatted tag and its value of uint64 to given `output` val.
+ * It is used for counters such as `"rx": 100`.
+ */
+static int
+append_json_uint64_value(const char *name, char **output, uint64_t value)
+{
+	int len = strlen(*output);
+	/* extend the buffer */
+	*output = spp_strbuf_append(*output, "",
+			strlen(name) + CMD_TAG_APPEND_SIZE*3);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, PCAP_RUNNER,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %"PRIu64")\n",
+				name, value);
+		return SPPWK_RET_NG;
+	}
+
+	sprintf(&(*output)[len], JSON_APPEND_VALUE("%"PRIu64),
+			JSON_APPEND_COMMA(len), name, value);
+	return SPPWK_RET_OK;
+}
+
 /**
  * Append JSON formatted tag and its value to given `output` val. For example,
  * `output` is `"client-id": 1`
@@ -493,6 +518,54 @@ append_pcap_core_element_value(
 	return ret;
 }
 
+/* append counters of the port to be captured in JSON format */
+static int
+append_port_stats_value(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_NG;
+	char port_str[CMD_TAG_APPEND_SIZE];
+	struct sppwk_port_idx port;
+	struct sppwk_port_cnts cnts;
+	char *tmp_buff, *tmp_port;
+
+	spp_pcap_get_port_cnts(&port, &cnts);
+	if (port.iface_type == UNDEF)
+		return append_json_array_brackets(name, output, "");
+
+	tmp_port = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_port == NULL)) {
+		RTE_LOG(ERR, PCAP_RUNNER,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_port_uid(port_str, port.iface_type, port.iface_no);
+	ret = append_json_str_value("port", &tmp_port, port_str);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value("rx", &tmp_port, cnts.rx);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value("rx_drop", &tmp_port,
+				cnts.rx_drop);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		spp_strbuf_free(tmp_port);
+		return SPPWK_RET_NG;
+	}
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		spp_strbuf_free(tmp_port);
+		return SPPWK_RET_NG;
+	}
+	ret = append_json_block_brackets("", &tmp_buff, tmp_port);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(name, output, tmp_buff);
+
+	spp_strbuf_free(tmp_port);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /* append master lcore in JSON format */
 static int
 append_master_lcore_value(const char *name, char **output,
@@ -605,6 +678,7 @@ struct cmd_res_formatter_ops response_info_list[] = {
 	{ "status",           append_capture_status_value },
 	{ "master-lcore",     append_master_lcore_value },
 	{ "core",             append_core_value },
+	{ "port_stats",       append_port_stats_value },
 	COMMAND_RESP_TAG_LIST_EMPTY
 };
 
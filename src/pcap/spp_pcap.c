@@ -9,6 +9,9 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_hash_crc.h>
 
 #include <lz4frame.h>
 
@@ -22,10 +25,8 @@
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-#include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
+#include "shared/secondary/spp_worker_th/port_stats.h"
+#include "shared/secondary/spp_worker_th/telemetry.h"
 
 /* Declare global variables */
 #define RTE_LOGTYPE_SPP_PCAP RTE_LOGTYPE_USER2
@@ -35,8 +36,8 @@
 #define PCAP_FNAME_STRLEN 64
 #define PCAP_FDATE_STRLEN 16
 
-/* Used to identify pcap files */
-#define TCPDUMP_MAGIC 0xa1b2c3d4
+/* Used to identify pcap files of timestamp in nanosec */
+#define TCPDUMP_MAGIC_NSEC 0xa1b23c4d
 
 /* Indicates major verions of libpcap file */
 #define PCAP_VERSION_MAJOR 2
@@ -65,7 +66,14 @@ enum SPP_LONGOPT_RETVAL {
 	 */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,  /* --client-id */
 	SPP_LONGOPT_RETVAL_OUT_DIR,    /* --out-dir */
-	SPP_LONGOPT_RETVAL_FILE_SIZE   /* --fsize */
+	SPP_LONGOPT_RETVAL_FILE_SIZE,  /* --fsize */
+	SPP_LONGOPT_RETVAL_DIST   /* --dist */
+};
+
+/* Method of distributing packets to writer threads */
+enum pcap_dist_mode {
+	PCAP_DIST_RR,  /* Round-robin for each of bursts */
+	PCAP_DIST_HASH  /* Hash of flow for each of packets */
 };
 
 /* capture thread type */
@@ -111,7 +119,7 @@ struct __attribute__((__packed__)) pcap_header {
 /* pcap packet header */
 struct pcap_packet_header {
 	uint32_t ts_sec;   /* time stamp seconds */
-	uint32_t ts_usec;  /* time stamp micro seconds */
+	uint32_t ts_nsec;  /* time stamp nano seconds */
 	uint32_t write_len;   /* write length */
 	uint32_t packet_len;  /* packet length */
 };
@@ -119,11 +127,14 @@ struct pcap_packet_header {
 /* Option for pcap. */
 struct pcap_option {
 	struct timespec start_time;  /* start time */
+	uint64_t start_tsc;  /* TSC at start time */
 	uint64_t fsize_limit;  /* file size limit */
 	char compress_file_path[PCAP_FPATH_STRLEN];  /* file path */
 	char compress_file_date[PCAP_FDATE_STRLEN];  /* file name date */
 	struct sppwk_port_info port_cap;  /* capture port */
-	struct rte_ring *cap_ring;  /* RTE ring structure */
+	enum pcap_dist_mode dist_mode;  /* distributing to writers */
+	int nof_writers;  /* num of writer threads */
+	struct rte_ring *write_rings[RTE_MAX_LCORE];  /* ring of each writer */
 };
 
 /**
@@ -141,6 +152,7 @@ struct pcap_mng_info {
 	size_t outbuf_capacity;  /* compress date buffer size */
 	void *outbuff;  /* compress date buffer */
 	uint64_t file_size;  /* file write size */
+	struct rte_ring *write_ring;  /* SPSC ring from receiver to writer */
 };
 
 /* Pcap status info. */
@@ -182,12 +194,15 @@ usage(const char *progname)
 		" -s IPADDR:PORT"
 		" -c CAP_PORT"
 		" [--out-dir OUTPUT_DIR]"
-		" [--fsize MAX_FILE_SIZE]\n"
+		" [--fsize MAX_FILE_SIZE]"
+		" [--dist MODE]\n"
 		" --client-id CLIENT_ID: My client ID\n"
 		" -s IPADDR:PORT: IP addr and sec port for spp-ctl\n"
 		" -c: Captured port (e.g. 'phy:0' or 'ring:1')\n"
 		" --out-dir: Output dir (Default is /tmp)\n"
 		" --fsize: Maximum captured file size (Default is 1GiB)\n"
+		" --dist: Distributing packets to writers, 'rr' or 'hash'"
+		" (Default is rr)\n"
 		, progname);
 }
 
@@ -278,6 +293,8 @@ parse_app_args(int argc, char *argv[])
 			SPP_LONGOPT_RETVAL_OUT_DIR },
 		{ "fsize", required_argument, NULL,
 			SPP_LONGOPT_RETVAL_FILE_SIZE},
+		{ "dist", required_argument, NULL,
+			SPP_LONGOPT_RETVAL_DIST},
 		{ 0 },
 	};
 	/**
@@ -320,6 +337,16 @@ parse_app_args(int argc, char *argv[])
 				return SPPWK_RET_NG;
 			}
 			break;
+		case SPP_LONGOPT_RETVAL_DIST:
+			if (strcmp(optarg, "rr") == 0)
+				g_pcap_option.dist_mode = PCAP_DIST_RR;
+			else if (strcmp(optarg, "hash") == 0)
+				g_pcap_option.dist_mode = PCAP_DIST_HASH;
+			else {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 'c':  /* captured port */
 			strcpy(cap_port_str, optarg);
 			if (parse_captured_port(optarg,
@@ -355,10 +382,13 @@ parse_app_args(int argc, char *argv[])
 
 	RTE_LOG(INFO, SPP_PCAP,
 			"Parsed app args ('--client-id %d', '-s %s:%d', "
-			"'-c %s', '--out-dir %s', '--fsize %ld')\n",
+			"'-c %s', '--out-dir %s', '--fsize %ld', "
+			"'--dist %s')\n",
 			cli_id, ctl_ip, ctl_port, cap_port_str,
 			g_pcap_option.compress_file_path,
-			g_pcap_option.fsize_limit);
+			g_pcap_option.fsize_limit,
+			g_pcap_option.dist_mode == PCAP_DIST_HASH ?
+			"hash" : "rr");
 	return SPPWK_RET_OK;
 }
 
@@ -405,6 +435,44 @@ spp_pcap_get_core_status(
 	return SPPWK_RET_OK;
 }
 
+/* Get counters of the port to be captured. */
+void
+spp_pcap_get_port_cnts(struct sppwk_port_idx *port,
+		struct sppwk_port_cnts *cnts)
+{
+	memset(port, 0x00, sizeof(struct sppwk_port_idx));
+	port->iface_type = g_pcap_option.port_cap.iface_type;
+	port->iface_no = g_pcap_option.port_cap.iface_no;
+
+	if (g_pcap_option.port_cap.ethdev_port_id < 0) {
+		memset(cnts, 0x00, sizeof(struct sppwk_port_cnts));
+		return;
+	}
+	sppwk_sum_port_cnts(g_pcap_option.port_cap.ethdev_port_id, cnts);
+}
+
+/* Add capture port and threads of receive and write to telemetry. */
+static void
+fill_telemetry(struct sppwk_telemetry *tm)
+{
+	unsigned int lcore_id;
+	const struct pcap_mng_info *info;
+
+	sppwk_telemetry_add_port(tm, g_pcap_option.port_cap.iface_type,
+			g_pcap_option.port_cap.iface_no,
+			g_pcap_option.port_cap.ethdev_port_id);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		info = &g_pcap_info[lcore_id];
+		if (info->type == PCAP_RECEIVE)
+			sppwk_telemetry_add_comp(tm, "", "receive", lcore_id,
+					NULL);
+		else if (info->type == PCAP_WRITE)
+			sppwk_telemetry_add_comp(tm, info->compress_file_name,
+					"write", lcore_id, NULL);
+	}
+}
+
 /* write compressed data into file  */
 static int output_pcap_file(FILE *compress_fp, void *srcbuf, size_t write_len)
 {
@@ -622,7 +690,7 @@ static int file_compression_operation(struct pcap_mng_info *info,
 	info->file_size = headerSize;
 
 	/* init the common pcap header */
-	pcap_h.magic_number = TCPDUMP_MAGIC;
+	pcap_h.magic_number = TCPDUMP_MAGIC_NSEC;
 	pcap_h.major_ver = PCAP_VERSION_MAJOR;
 	pcap_h.minor_ver = PCAP_VERSION_MINOR;
 	pcap_h.thiszone = 0;
@@ -649,7 +717,7 @@ static int compress_file_packet(struct pcap_mng_info *info,
 {
 	unsigned int write_packet_length;
 	unsigned int packet_length;
-	struct timespec cap_time;
+	uint64_t cap_time;
 	struct pcap_packet_header pcap_packet_h;
 	unsigned int remaining_bytes;
 	int bytes_to_write;
@@ -671,12 +739,12 @@ static int compress_file_packet(struct pcap_mng_info *info,
 	write_packet_length = TRANCATE_SNAPLEN(PCAP_SNAPLEN_MAX,
 							packet_length);
 
-	/* get time */
-	clock_gettime(CLOCK_REALTIME, &cap_time);
+	/* get time tagged by receiver */
+	cap_time = cap_pkt->udata64;
 
 	/* write block header */
-	pcap_packet_h.ts_sec = (int32_t)cap_time.tv_sec;
-	pcap_packet_h.ts_usec = (int32_t)(cap_time.tv_nsec / 1000);
+	pcap_packet_h.ts_sec = (uint32_t)(cap_time / NS_PER_S);
+	pcap_packet_h.ts_nsec = (uint32_t)(cap_time % NS_PER_S);
 	pcap_packet_h.write_len = write_packet_length;
 	pcap_packet_h.packet_len = packet_length;
 
@@ -711,18 +779,176 @@ static int compress_file_packet(struct pcap_mng_info *info,
 	return SPPWK_RET_OK;
 }
 
-/* Receive packets from shared ring buffer */
+/**
+ * Get time in nanosec calculated from TSC and the time capturing is
+ * started, instead of getting realtime for each of bursts.
+ */
+static inline uint64_t
+pcap_rx_time_ns(void)
+{
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t cycles = rte_rdtsc() - g_pcap_option.start_tsc;
+
+	return (uint64_t)g_pcap_option.start_time.tv_sec * NS_PER_S +
+			g_pcap_option.start_time.tv_nsec +
+			cycles / hz * NS_PER_S + cycles % hz * NS_PER_S / hz;
+}
+
+/**
+ * Tag packets with timestamp which is increased for each of packets, so that
+ * it is unique among all of files and used as sequence number for merging
+ * the files in the order of receiving. Timestamp is kept in `udata64` of
+ * mbuf, which is cleared by latency probe of ring while receiving, and
+ * cleared in pcap_free_pkt() after the packet is written or dropped.
+ */
+static inline void
+pcap_tag_pkts(struct rte_mbuf **bufs, int nb_rx)
+{
+	static uint64_t last_ts;
+	uint64_t ts = pcap_rx_time_ns();
+	int buf;
+
+	for (buf = 0; buf < nb_rx; buf++) {
+		if (unlikely(ts <= last_ts))
+			ts = last_ts + 1;
+		bufs[buf]->udata64 = ts;
+		last_ts = ts;
+	}
+}
+
+/**
+ * Free packet tagged with timestamp. The timestamp is cleared not to be
+ * taken as a timestamp by the next user of the mbuf.
+ */
+static inline void
+pcap_free_pkt(struct rte_mbuf *pkt)
+{
+	pkt->udata64 = 0;
+	rte_pktmbuf_free(pkt);
+}
+
+/**
+ * Get hash of flow of packet from IP addresses, or MAC addresses if it is
+ * not IP. It is symmetric so that both directions of a flow are written to
+ * the same file.
+ */
+static inline uint32_t
+pcap_hash_pkt(struct rte_mbuf *pkt)
+{
+	uint32_t l2_len = sizeof(struct rte_ether_hdr);
+	uint16_t ether_type;
+	struct rte_ether_hdr *eth;
+	struct rte_vlan_hdr *vh;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+
+	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	ether_type = eth->ether_type;
+	while ((ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) ||
+			ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_QINQ)) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_vlan_hdr)) {
+		vh = rte_pktmbuf_mtod_offset(pkt, struct rte_vlan_hdr *,
+				l2_len);
+		ether_type = vh->eth_proto;
+		l2_len += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_ipv4_hdr)) {
+		ip4 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv4_hdr *,
+				l2_len);
+		return rte_hash_crc_4byte(ip4->src_addr, 0) ^
+				rte_hash_crc_4byte(ip4->dst_addr, 0);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_ipv6_hdr)) {
+		ip6 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv6_hdr *,
+				l2_len);
+		return rte_hash_crc(ip6->src_addr, sizeof(ip6->src_addr), 0) ^
+				rte_hash_crc(ip6->dst_addr,
+						sizeof(ip6->dst_addr), 0);
+	}
+
+	return rte_hash_crc(&eth->s_addr, sizeof(eth->s_addr), 0) ^
+			rte_hash_crc(&eth->d_addr, sizeof(eth->d_addr), 0);
+}
+
+/**
+ * Send a burst to the ring of a writer in round-robin. Packets not enqueued
+ * are released.
+ *
+ * @return Num of packets enqueued.
+ */
+static inline int
+pcap_dist_rr(struct rte_mbuf **bufs, int nb_rx)
+{
+	static int next_writer;
+	int buf, nb_tx;
+	struct rte_ring *ring = g_pcap_option.write_rings[next_writer];
+
+	if (++next_writer >= g_pcap_option.nof_writers)
+		next_writer = 0;
+
+	nb_tx = rte_ring_sp_enqueue_burst(ring, (void *)bufs, nb_rx, NULL);
+	for (buf = nb_tx; buf < nb_rx; buf++)
+		pcap_free_pkt(bufs[buf]);
+	return nb_tx;
+}
+
+/**
+ * Send packets to rings of writers decided from hash of flow, so that
+ * packets of a flow are in the same file. Packets not enqueued are released.
+ *
+ * @return Num of packets enqueued.
+ */
+static inline int
+pcap_dist_hash(struct rte_mbuf **bufs, int nb_rx)
+{
+	int buf, writer, nb_pkts, nb_enq;
+	int nb_tx = 0;
+	int nb_left = nb_rx;
+	uint16_t writers[MAX_PCAP_BURST];
+	struct rte_mbuf *pkts[MAX_PCAP_BURST];
+
+	for (buf = 0; buf < nb_rx; buf++)
+		writers[buf] = pcap_hash_pkt(bufs[buf]) %
+				g_pcap_option.nof_writers;
+
+	for (writer = 0; writer < g_pcap_option.nof_writers && nb_left > 0;
+			writer++) {
+		nb_pkts = 0;
+		for (buf = 0; buf < nb_rx; buf++) {
+			if (writers[buf] == writer)
+				pkts[nb_pkts++] = bufs[buf];
+		}
+		if (nb_pkts == 0)
+			continue;
+
+		nb_enq = rte_ring_sp_enqueue_burst(
+				g_pcap_option.write_rings[writer],
+				(void *)pkts, nb_pkts, NULL);
+		for (buf = nb_enq; buf < nb_pkts; buf++)
+			pcap_free_pkt(pkts[buf]);
+		nb_tx += nb_enq;
+		nb_left -= nb_pkts;
+	}
+	return nb_tx;
+}
+
+/* Receive packets and distribute them to rings of writers */
 static int pcap_proc_receive(int lcore_id)
 {
 	struct timespec cur_time;  /* Used as timestamp for the file name */
 	struct tm l_time;
-	int buf;
 	int nb_rx = 0;
 	int nb_tx = 0;
 	struct sppwk_port_info *rx;
 	struct rte_mbuf *bufs[MAX_PCAP_BURST];
 	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
-	struct rte_ring *write_ring = g_pcap_option.cap_ring;
 	static long long total_rx;
 	static long long total_drop;
 
@@ -750,6 +976,8 @@ static int pcap_proc_receive(int lcore_id)
 		localtime_r(&cur_time.tv_sec, &l_time);
 		strftime(g_pcap_option.compress_file_date, PCAP_FDATE_STRLEN,
 					"%Y%m%d%H%M%S", &l_time);
+		g_pcap_option.start_time = cur_time;
+		g_pcap_option.start_tsc = rte_rdtsc();
 		info->status = SPP_CAPTURE_RUNNING;
 		g_capture_status = SPP_CAPTURE_RUNNING;
 
@@ -769,24 +997,23 @@ static int pcap_proc_receive(int lcore_id)
 
 	/* Receive packets */
 	rx = &g_pcap_option.port_cap;
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	nb_rx = sppwk_eth_ring_stats_rx_burst(rx->ethdev_port_id,
-			rx->iface_type, rx->iface_no, 0, bufs, MAX_PCAP_BURST);
-#else
-	nb_rx = rte_eth_rx_burst(rx->ethdev_port_id, 0, bufs, MAX_PCAP_BURST);
-#endif
+	nb_rx = sppwk_eth_rx_burst(rx->ethdev_port_id, 0, bufs,
+			MAX_PCAP_BURST);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
-	/* Forward to ring for writer thread */
-	nb_tx = rte_ring_enqueue_burst(write_ring, (void *)bufs, nb_rx, NULL);
+	/* Forward to rings for writer threads */
+	pcap_tag_pkts(bufs, nb_rx);
+	if (g_pcap_option.dist_mode == PCAP_DIST_HASH)
+		nb_tx = pcap_dist_hash(bufs, nb_rx);
+	else
+		nb_tx = pcap_dist_rr(bufs, nb_rx);
 
-	/* Discard remained packets to release mbuf */
+	/* Remained packets are already released */
 	if (unlikely(nb_tx < nb_rx)) {
+		sppwk_cnt_rx(rx->ethdev_port_id, 0, nb_rx - nb_tx);
 		RTE_LOG(ERR, SPP_PCAP, "drop packets(receve) %d\n",
 							(nb_rx - nb_tx));
-		for (buf = nb_tx; buf < nb_rx; buf++)
-			rte_pktmbuf_free(bufs[buf]);
 	}
 
 	total_rx += nb_rx;
@@ -804,7 +1031,7 @@ static int pcap_proc_write(int lcore_id)
 	struct rte_mbuf *bufs[MAX_PCAP_BURST];
 	struct rte_mbuf *mbuf = NULL;
 	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
-	struct rte_ring *read_ring = g_pcap_option.cap_ring;
+	struct rte_ring *read_ring = info->write_ring;
 
 	if (g_capture_status == SPP_CAPTURE_IDLE) {
 		if (info->status == SPP_CAPTURE_IDLE)
@@ -822,8 +1049,8 @@ static int pcap_proc_write(int lcore_id)
 		g_total_write[lcore_id] = 0;
 	}
 
-	/* Read packets from shared ring */
-	nb_rx =  rte_ring_mc_dequeue_burst(read_ring, (void *)bufs,
+	/* Read packets from the ring of this writer */
+	nb_rx =  rte_ring_sc_dequeue_burst(read_ring, (void *)bufs,
 					   MAX_PCAP_BURST, NULL);
 	if (unlikely(nb_rx == 0)) {
 		if (g_capture_status == SPP_CAPTURE_IDLE) {
@@ -862,12 +1089,53 @@ static int pcap_proc_write(int lcore_id)
 
 	/* Free mbuf */
 	for (buf = 0; buf < nb_rx; buf++)
-		rte_pktmbuf_free(bufs[buf]);
+		pcap_free_pkt(bufs[buf]);
 
 	g_total_write[lcore_id] += nb_rx;
 	return ret;
 }
 
+/**
+ * Create a SPSC ring for each of writer threads. The first slave lcore is
+ * for receiver, and the rest of lcores are for writers.
+ */
+static int
+create_write_rings(void)
+{
+	unsigned int lcore_id;
+	unsigned int thread_no = 0;
+	struct rte_ring *ring;
+	char ring_name[RTE_RING_NAMESIZE];
+
+	g_pcap_option.nof_writers = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (thread_no++ == 0)
+			continue;
+
+		snprintf(ring_name, sizeof(ring_name), "cap_ring_%d_%u",
+				get_client_id(), thread_no - 1);
+		ring = rte_ring_create(ring_name, rte_align32pow2(RING_SIZE),
+				rte_socket_id(),
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (ring == NULL) {
+			RTE_LOG(ERR, SPP_PCAP, "ring create error(%s).\n",
+						rte_strerror(rte_errno));
+			return SPPWK_RET_NG;
+		}
+		RTE_LOG(DEBUG, SPP_PCAP, "Ring port name=%s, flags=0x%x\n",
+				ring->name, ring->flags);
+
+		g_pcap_info[lcore_id].write_ring = ring;
+		g_pcap_option.write_rings[g_pcap_option.nof_writers++] = ring;
+	}
+
+	if (g_pcap_option.nof_writers == 0) {
+		RTE_LOG(ERR, SPP_PCAP, "No lcore for writer thread.\n");
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
 /* Main process of slave core */
 static int
 slave_main(void *arg __attribute__ ((unused)))
@@ -928,6 +1196,7 @@ main(int argc, char *argv[])
 	unsigned int master_lcore;
 	unsigned int lcore_id;
 	unsigned int thread_no;
+	int cnt;
 
 #ifdef SPP_DEMONIZE
 	/* Daemonize process */
@@ -1029,22 +1298,13 @@ main(int argc, char *argv[])
 				port_cap->iface_type, port_cap->iface_no,
 				port_cap->ethdev_port_id);
 
-		/* create ring */
-		char ring_name[PORT_STR_SIZE];
-		memset(ring_name, 0x00, PORT_STR_SIZE);
-		snprintf(ring_name, PORT_STR_SIZE, "cap_ring_%d",
-				get_client_id());
-		g_pcap_option.cap_ring = rte_ring_create(ring_name,
-					rte_align32pow2(RING_SIZE),
-					rte_socket_id(), 0);
-		if (g_pcap_option.cap_ring == NULL) {
-			RTE_LOG(ERR, SPP_PCAP, "ring create error(%s).\n",
-						rte_strerror(rte_errno));
+		/* create rings */
+		if (create_write_rings() != SPPWK_RET_OK)
+			break;
+
+		ret = sppwk_telemetry_init(get_client_id(), "pcap");
+		if (unlikely(ret != SPPWK_RET_OK))
 			break;
-		}
-		RTE_LOG(DEBUG, SPP_PCAP, "Ring port name=%s, flags=0x%x\n",
-				g_pcap_option.cap_ring->name,
-				g_pcap_option.cap_ring->flags);
 
 		/* Start worker threads of recive or write */
 		g_pcap_thread_info.thread_cnt = 0;
@@ -1080,6 +1340,8 @@ main(int argc, char *argv[])
 			 * Wait to avoid CPU overloaded.
 			 */
 			usleep(100);
+
+			sppwk_telemetry_update(fill_telemetry);
 		}
 
 		if (unlikely(ret_do != SPPWK_RET_OK)) {
@@ -1098,8 +1360,8 @@ main(int argc, char *argv[])
 		RTE_LOG(ERR, SPP_PCAP, "Failed to terminate master thread.\n");
 
 	/* capture write ring free */
-	if (g_pcap_option.cap_ring != NULL)
-		rte_ring_free(g_pcap_option.cap_ring);
+	for (cnt = 0; cnt < g_pcap_option.nof_writers; cnt++)
+		rte_ring_free(g_pcap_option.write_rings[cnt]);
 
 
 	RTE_LOG(INFO, SPP_PCAP, "Exit spp_pcap.\n");
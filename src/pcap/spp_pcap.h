@@ -6,6 +6,7 @@
 #define __SPP_PCAP_H__
 
 #include "cmd_utils.h"
+#include "shared/secondary/spp_worker_th/port_stats.h"
 
 /**
  * Pcap get core status
@@ -21,4 +22,13 @@ int spp_pcap_get_core_status(
 		unsigned int lcore_id,
 		struct sppwk_lcore_params *params);
 
+/**
+ * Get counters of the port to be captured.
+ *
+ * @param[out] port Port to be captured.
+ * @param[out] cnts Counters of the port summed up for all of lcores.
+ */
+void spp_pcap_get_port_cnts(struct sppwk_port_idx *port,
+		struct sppwk_port_cnts *cnts);
+
 #endif /* __SPP_PCAP_H__ */
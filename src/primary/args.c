@@ -8,12 +8,15 @@
 #include <rte_memory.h>
 
 #include "shared/common.h"
+#include "shared/idle_policy.h"
 #include "args.h"
 #include "init.h"
 #include "primary.h"
 
 /* global var for number of rings - extern in header */
 uint16_t num_rings;
+uint16_t nof_phy_queues = 1;
+int vlan_offload;
 char *server_ip;
 int server_port;
 
@@ -29,10 +32,16 @@ int do_forwarding;
 enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_DISP_STATS,
+	CMD_OPT_PHY_QUEUES,
+	CMD_OPT_VLAN_OFFLOAD,
+	CMD_OPT_IDLE_POLICY,
 };
 
 struct option lgopts[] = {
 	{"disp-stats", no_argument, NULL, CMD_OPT_DISP_STATS},
+	{"phy-queues", required_argument, NULL, CMD_OPT_PHY_QUEUES},
+	{"vlan-offload", no_argument, NULL, CMD_OPT_VLAN_OFFLOAD},
+	{"idle-policy", required_argument, NULL, CMD_OPT_IDLE_POLICY},
 	{0}
 };
 
@@ -45,9 +54,15 @@ static void
 usage(void)
 {
 	RTE_LOG(INFO, PRIMARY,
-	    "%s [EAL options] -- -p PORTMASK -n NUM_CLIENTS [-s NUM_SOCKETS]\n"
+	    "%s [EAL options] -- -p PORTMASK -n NUM_CLIENTS [-s NUM_SOCKETS]"
+	    " [--phy-queues NUM] [--vlan-offload]"
+	    " [--idle-policy PAUSE,SLEEP,MAX_US]\n"
 	    " -p PORTMASK: hexadecimal bitmask of ports to use\n"
 	    " -n NUM_RINGS: number of ring ports used from secondaries\n"
+	    " --phy-queues NUM: number of RX and TX queues of each port\n"
+	    " --vlan-offload: insert VLAN tag by port if supported\n"
+	    " --idle-policy PAUSE,SLEEP,MAX_US: num of empty polls to pause"
+	    " and to sleep, and max usec of a sleep of forwarding lcores\n"
 	    , progname);
 }
 
@@ -131,6 +146,28 @@ parse_nof_rings(uint16_t *num_clients, const char *clients)
 	return 0;
 }
 
+/**
+ * Take the number of queues passed with `--phy-queues` option. Packets are
+ * distributed to RX queues with RSS.
+ */
+static int
+parse_nof_phy_queues(uint16_t *nof_queues, const char *queues)
+{
+	char *end = NULL;
+	unsigned long temp;
+
+	if (queues == NULL || *queues == '\0')
+		return -1;
+
+	temp = strtoul(queues, &end, 10);
+	if (end == NULL || *end != '\0' || temp == 0 ||
+			temp > RTE_MAX_QUEUES_PER_PORT)
+		return -1;
+
+	*nof_queues = (uint16_t)temp;
+	return 0;
+}
+
 /**
  * The application specific arguments follow the DPDK-specific
  * arguments which are stripped by the DPDK init. This function
@@ -152,6 +189,22 @@ parse_app_args(uint16_t max_ports, int argc, char *argv[])
 		case CMD_OPT_DISP_STATS:
 			set_forwarding_flg(0);
 			break;
+		case CMD_OPT_PHY_QUEUES:
+			if (parse_nof_phy_queues(&nof_phy_queues,
+					optarg) != 0) {
+				usage();
+				return -1;
+			}
+			break;
+		case CMD_OPT_VLAN_OFFLOAD:
+			vlan_offload = 1;
+			break;
+		case CMD_OPT_IDLE_POLICY:
+			if (parse_idle_policy(optarg) != 0) {
+				usage();
+				return -1;
+			}
+			break;
 		case 'p':
 			if (parse_portmask(ports, max_ports, optarg) != 0) {
 				usage();
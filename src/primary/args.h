@@ -10,6 +10,8 @@
 #include "shared/common.h"
 
 extern uint16_t num_rings;
+extern uint16_t nof_phy_queues;
+extern int vlan_offload;
 extern char *server_ip;
 extern int server_port;
 
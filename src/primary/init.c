@@ -257,12 +257,18 @@ int
 init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 {
 	/* for port configuration all features are off by default */
-	const struct rte_eth_conf port_conf = {
+	struct rte_eth_conf port_conf = {
 		.rxmode = {
 			.mq_mode = ETH_MQ_RX_RSS,
 		},
+		.rx_adv_conf = {
+			.rss_conf = {
+				.rss_key = NULL,
+				.rss_hf = ETH_RSS_IP | ETH_RSS_TCP | ETH_RSS_UDP,
+			},
+		},
 	};
-	const uint16_t rx_rings = 1, tx_rings = 1;
+	uint16_t rx_rings = nof_phy_queues, tx_rings = nof_phy_queues;
 	const uint16_t rx_ring_size = RTE_MP_RX_DESC_DEFAULT;
 	const uint16_t tx_ring_size = RTE_MP_TX_DESC_DEFAULT;
 	uint16_t q;
@@ -281,6 +287,23 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 	txq_conf = dev_info.default_txconf;
 	txq_conf.offloads = local_port_conf.txmode.offloads;
 
+	/* Queues are distributed with RSS of supported flow types. */
+	if (rx_rings > dev_info.max_rx_queues)
+		rx_rings = dev_info.max_rx_queues;
+	if (tx_rings > dev_info.max_tx_queues)
+		tx_rings = dev_info.max_tx_queues;
+	port_conf.rx_adv_conf.rss_conf.rss_hf &=
+		dev_info.flow_type_rss_offloads;
+
+	/* VLAN tag of secondaries is inserted by port instead of software. */
+	if (vlan_offload &&
+			(dev_info.tx_offload_capa & DEV_TX_OFFLOAD_VLAN_INSERT))
+		port_conf.txmode.offloads |= DEV_TX_OFFLOAD_VLAN_INSERT;
+	if (rx_rings != nof_phy_queues || tx_rings != nof_phy_queues)
+		RTE_LOG(WARNING, PRIMARY,
+			"Port %u has %u RX and %u TX queues, not %u.\n",
+			port_num, rx_rings, tx_rings, nof_phy_queues);
+
 	/*
 	 * Standard DPDK port initialisation - config port, then set up
 	 * rx and tx rings
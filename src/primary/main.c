@@ -13,6 +13,7 @@
 #include <rte_eth_ring.h>
 
 #include "shared/common.h"
+#include "shared/idle_policy.h"
 #include "args.h"
 #include "init.h"
 #include "primary.h"
@@ -22,10 +23,13 @@
 #include "shared/secondary/utils.h"
 
 /*
- * Buffer sizes of status message of primary. Total number of size
- * must be equal to MSG_SIZE 2048 defined in `shared/common.h`.
+ * Buffer sizes of status message of primary. Ring ports take the rest of
+ * MSG_SIZE 2048 defined in `shared/common.h` after other parts, so that
+ * PRI_BUF_SIZE_RING is the upper limit in case of not forwarding.
  */
 #define PRI_BUF_SIZE_LCORE 128
+#define PRI_BUF_SIZE_FWD 512
+#define PRI_BUF_SIZE_CYCLES 256
 #define PRI_BUF_SIZE_PHY 512
 #define PRI_BUF_SIZE_RING (MSG_SIZE - PRI_BUF_SIZE_LCORE - PRI_BUF_SIZE_PHY)
 
@@ -170,15 +174,16 @@ static void
 forward_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	struct idle_state idle = { 0 };
 
 	RTE_LOG(INFO, PRIMARY, "entering main loop on lcore %u\n", lcore_id);
 
 	while (1) {
 		if (unlikely(cmd == STOP)) {
-			sleep(1);
+			idle_policy_stopped(&idle);
 			continue;
 		} else if (cmd == FORWARD) {
-			forward();
+			idle_policy_poll(&idle, forward_with_cycles(lcore_id));
 		}
 	}
 }
@@ -666,13 +671,16 @@ phy_port_stats_json(char *str)
 	return 0;
 }
 
+/* Make ring port stats not exceeding `size` including null character. */
 static int
-ring_port_stats_json(char *str)
+ring_port_stats_json(char *str, int size)
 {
 	int i;
 	int buf_size = 256;  /* size of temp buffer */
 	char buf_ring_ports[PRI_BUF_SIZE_RING];
 	char ring_port[buf_size];
+	int buf_limit = RTE_MIN((int)sizeof(buf_ring_ports),
+			size - (int)strlen("\"ring_ports\":[]"));
 	memset(ring_port, '\0', sizeof(ring_port));
 	memset(buf_ring_ports, '\0', sizeof(buf_ring_ports));
 
@@ -694,7 +702,7 @@ ring_port_stats_json(char *str)
 
 		int cur_buf_size = (int)strlen(buf_ring_ports) +
 			(int)strlen(ring_port);
-		if (cur_buf_size >  PRI_BUF_SIZE_RING - 1) {
+		if (cur_buf_size > buf_limit - 1) {
 			RTE_LOG(ERR, PRIMARY,
 				"Cannot send all of ring_port stats (%d/%d)\n",
 				i, num_rings);
@@ -709,7 +717,7 @@ ring_port_stats_json(char *str)
 		if (i < num_rings - 1)
 			sprintf(buf_ring_ports, "%s,", buf_ring_ports);
 	}
-	sprintf(str, "\"ring_ports\":[%s]", buf_ring_ports);
+	snprintf(str, size, "\"ring_ports\":[%s]", buf_ring_ports);
 	return 0;
 }
 
@@ -726,6 +734,14 @@ ring_port_stats_json(char *str)
  *         "ports": ["phy:0", "phy:1"],
  *         "patches": ["src": "phy:0", "dst": "phy:1"]
  *     },
+ *     "lcore_cycles": [
+ *     {
+ *         "core": 1,
+ *         "busy": 1024,
+ *         "idle": 2048,
+ *         "pkts": 32
+ *     }
+ *     ],
  *     "ring_ports": [
  *     {
  *         "id": 0,
@@ -751,6 +767,7 @@ ring_port_stats_json(char *str)
 static int
 get_status_json(char *str)
 {
+	int len, nof_omitted;
 	char buf_lcores[PRI_BUF_SIZE_LCORE];
 	char buf_phy_ports[PRI_BUF_SIZE_PHY];
 	char buf_ring_ports[PRI_BUF_SIZE_RING];
@@ -760,24 +777,35 @@ get_status_json(char *str)
 
 	append_lcore_info_json(buf_lcores, lcore_id_used);
 	phy_port_stats_json(buf_phy_ports);
-	ring_port_stats_json(buf_ring_ports);
 
-	RTE_LOG(INFO, PRIMARY, "%s, %s\n", buf_phy_ports, buf_ring_ports);
+	len = snprintf(str, MSG_SIZE, "{%s,", buf_lcores);
 
 	if (get_forwarding_flg() == 1) {
-		char tmp_buf[512];
+		char tmp_buf[PRI_BUF_SIZE_FWD];
+		char buf_cycles[PRI_BUF_SIZE_CYCLES];
 		memset(tmp_buf, '\0', sizeof(tmp_buf));
+		memset(buf_cycles, '\0', sizeof(buf_cycles));
 		forwarder_status_json(tmp_buf);
+		nof_omitted = append_lcore_cycles_json(buf_cycles,
+				sizeof(buf_cycles));
+		if (nof_omitted > 0)
+			RTE_LOG(ERR, PRIMARY,
+				"Cannot send lcore_cycles of %d lcores\n",
+				nof_omitted);
 
-		sprintf(str, "{%s,%s,%s,%s}",
-				buf_lcores, tmp_buf, buf_phy_ports,
-				buf_ring_ports);
-
-	} else {
-		sprintf(str, "{%s,%s,%s}",
-				buf_lcores, buf_phy_ports, buf_ring_ports);
+		len += snprintf(str + len, MSG_SIZE - len, "%s,%s,",
+				tmp_buf, buf_cycles);
 	}
 
+	len += snprintf(str + len, MSG_SIZE - len, "%s,", buf_phy_ports);
+
+	/* Ring ports take the rest of message except for closing `}`. */
+	ring_port_stats_json(buf_ring_ports,
+			RTE_MIN(MSG_SIZE - len - 1, PRI_BUF_SIZE_RING));
+	snprintf(str + len, MSG_SIZE - len, "%s}", buf_ring_ports);
+
+	RTE_LOG(INFO, PRIMARY, "%s, %s\n", buf_phy_ports, buf_ring_ports);
+
 	return 0;
 }
 
@@ -3,12 +3,19 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
+#include "shared/chain_trace.h"
 
-void
+struct poll_cycles fwd_lcore_cycles[RTE_MAX_LCORE];
+
+unsigned int
 forward(void)
 {
+	unsigned int nb_total = 0;
 	uint16_t nb_rx;
 	uint16_t nb_tx;
 	int in_port;
@@ -38,8 +45,11 @@ forward(void)
 			continue;
 
 		port_map[in_port].stats->rx += nb_rx;
+		nb_total += nb_rx;
+		chain_trace_rx(in_port, bufs, nb_rx);
 
 		/* Send burst of TX packets, to second port of pair. */
+		chain_trace_tx(out_port, bufs, nb_rx);
 		nb_tx = ports_fwd_array[out_port].tx_func(out_port, 0, bufs,
 			nb_rx);
 
@@ -52,4 +62,38 @@ forward(void)
 				rte_pktmbuf_free(bufs[buf]);
 		}
 	}
+	return nb_total;
+}
+
+int
+append_lcore_cycles_json(char *str, size_t size)
+{
+	unsigned int lcore_id;
+	size_t len = strlen(str);
+	char entry[128];
+	int nof_entries = 0, nof_omitted = 0;
+	const struct poll_cycles *pc;
+
+	/* Keep space for closing `]` and terminating null character. */
+	if (len + strlen("\"lcore_cycles\":[]") >= size)
+		return (int)rte_lcore_count() - 1;
+	len += sprintf(str + len, "\"lcore_cycles\":[");
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		pc = &fwd_lcore_cycles[lcore_id];
+		snprintf(entry, sizeof(entry),
+				"%s{\"core\":%u,\"busy\":%"PRIu64
+				",\"idle\":%"PRIu64",\"pkts\":%"PRIu64"}",
+				nof_entries > 0 ? "," : "",
+				lcore_id, pc->busy, pc->idle, pc->pkts);
+		/* Omit lcores which cannot be contained in the buffer. */
+		if (nof_omitted > 0 || len + strlen(entry) + 1 >= size) {
+			nof_omitted++;
+			continue;
+		}
+		len += sprintf(str + len, "%s", entry);
+		nof_entries++;
+	}
+	sprintf(str + len, "]");
+	return nof_omitted;
 }
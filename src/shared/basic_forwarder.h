@@ -5,11 +5,46 @@
 #ifndef __SHARED_BASIC_FORWARDER_H__
 #define __SHARED_BASIC_FORWARDER_H__
 
+#include <rte_cycles.h>
 #include "shared/common.h"
 
 struct port_map port_map[RTE_MAX_ETHPORTS];
 struct port ports_fwd_array[RTE_MAX_ETHPORTS];
 
-void forward(void);
+/* Cycles of each of lcores running forward(). */
+extern struct poll_cycles fwd_lcore_cycles[RTE_MAX_LCORE];
+
+/**
+ * Forward packets of each of patches.
+ *
+ * @return Num of received packets.
+ */
+unsigned int forward(void);
+
+/**
+ * Run forward() and count its cycles as of the caller lcore.
+ *
+ * @return Num of received packets.
+ */
+static inline unsigned int
+forward_with_cycles(unsigned int lcore_id)
+{
+	uint64_t start = rte_rdtsc();
+	unsigned int nb_rx = forward();
+
+	poll_cycles_add(&fwd_lcore_cycles[lcore_id], rte_rdtsc() - start,
+			nb_rx);
+	return nb_rx;
+}
+
+/**
+ * Append cycles of lcores forwarding packets in JSON such as
+ * `"lcore_cycles":[{"core":1,"busy":100,"idle":200,"pkts":32}]`.
+ *
+ * @param[in,out] str Buffer to be appended.
+ * @param[in] size Size of the buffer.
+ * @return Number of lcores omitted because of lack of the buffer.
+ */
+int append_lcore_cycles_json(char *str, size_t size);
 
 #endif
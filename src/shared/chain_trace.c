@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include "shared/common.h"
+#include "shared/chain_trace.h"
+
+#define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
+
+#define NS_PER_SEC 1000000000ULL
+
+/* Trace of a port on a lcore. */
+struct chain_trace_stats {
+	uint64_t timer_tsc;  /* Cycles passed from the last stamp. */
+	uint64_t prev_tsc;  /* TSC of the last received packet. */
+	struct lat_hist hist;  /* Latency from the ingress. */
+} __rte_cache_aligned;
+
+volatile int g_chain_trace_on;
+
+/* Interval of stamping in cycles. */
+static uint64_t g_samp_intvl;
+
+/* Trace points of ports, resolved by lcores at the first use. */
+static volatile enum chain_trace_point g_points[RTE_MAX_ETHPORTS];
+
+/**
+ * Stats of ports of each of lcores, indexed with rte_lcore_index() and
+ * etherdev ID. It is allocated when tracing is turned on at first.
+ */
+static struct chain_trace_stats *g_stats;
+
+/* Get stats of the port on the caller lcore, or NULL if not counted. */
+static inline struct chain_trace_stats *
+get_stats(uint16_t port_id)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE || port_id >= RTE_MAX_ETHPORTS))
+		return NULL;
+	return &g_stats[rte_lcore_index(lcore_id) * RTE_MAX_ETHPORTS +
+			port_id];
+}
+
+/* Get trace point of the port, or resolve it from the name of ethdev. */
+static enum chain_trace_point
+get_point(uint16_t port_id)
+{
+	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
+	int port_type, iface_no;
+	enum chain_trace_point point = g_points[port_id];
+
+	if (likely(point != CHAIN_TRACE_UNKNOWN))
+		return point;
+
+	/* Not to be cached until the port is added. */
+	if (rte_eth_dev_get_name_by_port(port_id, dev_name) != 0 ||
+			parse_dev_name(dev_name, &port_type, &iface_no) != 0)
+		return CHAIN_TRACE_NONE;
+
+	if (port_type == PHY)
+		point = CHAIN_TRACE_EDGE;
+	else if (port_type == RING)
+		point = CHAIN_TRACE_HOP;
+	else
+		point = CHAIN_TRACE_NONE;
+	g_points[port_id] = point;
+	return point;
+}
+
+void
+chain_trace_init(uint64_t samp_intvl)
+{
+	g_samp_intvl = samp_intvl * rte_get_tsc_hz() / NS_PER_SEC;
+	g_chain_trace_on = 0;
+}
+
+void
+chain_trace_clean(void)
+{
+	g_chain_trace_on = 0;
+	rte_free(g_stats);
+	g_stats = NULL;
+}
+
+int
+chain_trace_set(int on)
+{
+	int port_id;
+
+	if (on && g_stats == NULL) {
+		g_stats = rte_zmalloc("chain_trace_stats",
+				sizeof(struct chain_trace_stats) *
+				rte_lcore_count() * RTE_MAX_ETHPORTS,
+				RTE_CACHE_LINE_SIZE);
+		if (unlikely(g_stats == NULL)) {
+			RTE_LOG(ERR, SHARED, "Cannot allocate memory "
+					"for chain trace.\n");
+			return -1;
+		}
+	}
+
+	/* Ports might be changed while tracing is off. */
+	if (on) {
+		for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++)
+			g_points[port_id] = CHAIN_TRACE_UNKNOWN;
+	}
+	rte_smp_wmb();
+	g_chain_trace_on = on;
+
+	RTE_LOG(INFO, SHARED, "Turn %s chain trace.\n", on ? "on" : "off");
+	return 0;
+}
+
+/* Get latency of a stamped packet. */
+static inline uint64_t
+get_latency(const struct rte_mbuf *pkt, uint64_t now)
+{
+	return now - (pkt->udata64 & ~CHAIN_TRACE_STAMP_BIT);
+}
+
+/**
+ * Stamp packets received from ingress in every sampling interval, or count
+ * latency of stamped packets received from hop. Stamps of packets received
+ * from other than hop are of recycled mbufs, and cleared.
+ */
+void
+chain_trace_recv(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+	uint64_t now;
+	enum chain_trace_point point = get_point(port_id);
+	struct chain_trace_stats *stats;
+
+	if (point != CHAIN_TRACE_HOP) {
+		for (i = 0; i < nb_pkts; i++) {
+			if (unlikely(chain_trace_stamped(pkts[i])))
+				pkts[i]->udata64 = 0;
+		}
+	}
+	if (point != CHAIN_TRACE_EDGE && point != CHAIN_TRACE_HOP)
+		return;
+	stats = get_stats(port_id);
+	if (unlikely(stats == NULL))
+		return;
+
+	now = rte_rdtsc();
+	if (point == CHAIN_TRACE_EDGE) {
+		/* Stamp the first packet of the burst if interval passed. */
+		stats->timer_tsc += now - stats->prev_tsc;
+		stats->prev_tsc = now;
+		if (stats->timer_tsc < g_samp_intvl)
+			return;
+		stats->timer_tsc = 0;
+		pkts[0]->udata64 = now | CHAIN_TRACE_STAMP_BIT;
+		return;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(!chain_trace_stamped(pkts[i])))
+			continue;
+		lat_hist_add(&stats->hist, get_latency(pkts[i], now));
+	}
+}
+
+/* Count latency of stamped packets sent to egress, and clear the stamp. */
+void
+chain_trace_send(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+	uint64_t now;
+	struct chain_trace_stats *stats;
+
+	if (get_point(port_id) != CHAIN_TRACE_EDGE)
+		return;
+	stats = get_stats(port_id);
+	if (unlikely(stats == NULL))
+		return;
+
+	now = rte_rdtsc();
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(!chain_trace_stamped(pkts[i])))
+			continue;
+		lat_hist_add(&stats->hist, get_latency(pkts[i], now));
+		pkts[i]->udata64 = 0;
+	}
+}
+
+/* Get trace point and histogram of a port merged from all of lcores. */
+int
+chain_trace_get_hist(uint16_t port_id, enum chain_trace_point *point,
+		struct lat_hist *hist)
+{
+	unsigned int lcore_idx;
+
+	memset(hist, 0x00, sizeof(*hist));
+	if (g_stats == NULL || port_id >= RTE_MAX_ETHPORTS)
+		return -1;
+
+	*point = get_point(port_id);
+	if (*point != CHAIN_TRACE_EDGE && *point != CHAIN_TRACE_HOP)
+		return -1;
+
+	for (lcore_idx = 0; lcore_idx < rte_lcore_count(); lcore_idx++)
+		lat_hist_merge(hist, &g_stats[lcore_idx * RTE_MAX_ETHPORTS +
+				port_id].hist);
+	if (hist->count == 0)
+		return -1;
+	return 0;
+}
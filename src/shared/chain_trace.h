@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_CHAIN_TRACE_H__
+#define __SHARED_CHAIN_TRACE_H__
+
+/**
+ * @file
+ * Tracing latency of service chain
+ *
+ * Packets received from phy ports, which are the ingress of a service chain,
+ * are stamped with TSC once in every sampling interval. The stamp is
+ * carried in `udata64` of mbuf, which is also used by ring latency probes,
+ * and marked with CHAIN_TRACE_STAMP_BIT of it. `timestamp` is not used
+ * because it can be set by PMDs. Mbufs are shared among processes via
+ * MProc_pktmbuf_pool, so the stamp is passed to other processes through
+ * ring ports. Latency from the ingress is counted as hop latency when a
+ * stamped packet is received from a ring port, and as end-to-end latency
+ * when it is sent to a phy port, which is the egress of the chain.
+ *
+ * `udata64` is not cleared when a mbuf is allocated, so the stamp is
+ * cleared when a packet is sent to the egress, or received from ports other
+ * than ring, not to count the stamp of a recycled mbuf. Ring latency probes
+ * leave stamped packets as they are. The stamp is lost at vhost ports
+ * because packets are copied from or to guest.
+ *
+ * Tracing is turned on or off at runtime, and costs a branch for each of
+ * bursts if it is off.
+ */
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include "shared/latency_hist.h"
+
+/* Bit of `udata64` of mbuf for packets stamped at the ingress. */
+#define CHAIN_TRACE_STAMP_BIT (1ULL << 63)
+
+/* Default interval of stamping of each of ingress ports in nano sec. */
+#define CHAIN_TRACE_SAMPLING_INTERVAL 1000000
+
+/* Trace point of a port, resolved from the name of ethdev. */
+enum chain_trace_point {
+	CHAIN_TRACE_UNKNOWN,  /* Not resolved yet. */
+	CHAIN_TRACE_NONE,  /* Not traced, such as vhost. */
+	CHAIN_TRACE_EDGE,  /* Phy, ingress for RX and egress for TX. */
+	CHAIN_TRACE_HOP,  /* Ring, hop for RX. */
+};
+
+/* 1 while tracing, written only by the master thread. */
+extern volatile int g_chain_trace_on;
+
+/**
+ * Initialize chain trace.
+ *
+ * @param[in] samp_intvl Interval of stamping in nano sec.
+ */
+void chain_trace_init(uint64_t samp_intvl);
+
+/* Stop tracing and free histograms. */
+void chain_trace_clean(void);
+
+/**
+ * Turn on or off tracing. Histograms are allocated at the first time it is
+ * turned on, and kept while it is off.
+ *
+ * @param[in] on 1 for turning on, or 0 for off.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int chain_trace_set(int on);
+
+/* Stamp or count packets received from a port. */
+void chain_trace_recv(uint16_t port_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts);
+
+/* Count packets sent to a port. */
+void chain_trace_send(uint16_t port_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts);
+
+/**
+ * Get the trace point and the histogram of a port merged from all of lcores.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[out] point Trace point of the port.
+ * @param[out] hist Histogram of latency from the ingress.
+ * @return 0 if succeeded, or -1 if the port is not traced or no stamped
+ *   packet is counted.
+ */
+int chain_trace_get_hist(uint16_t port_id, enum chain_trace_point *point,
+		struct lat_hist *hist);
+
+/* Return 1 if the packet is stamped at the ingress, or 0 if not. */
+static inline int
+chain_trace_stamped(const struct rte_mbuf *pkt)
+{
+	return (pkt->udata64 & CHAIN_TRACE_STAMP_BIT) != 0;
+}
+
+/* Trace packets received from a port if tracing is on. */
+static inline void
+chain_trace_rx(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	if (unlikely(g_chain_trace_on))
+		chain_trace_recv(port_id, pkts, nb_pkts);
+}
+
+/* Trace packets to be sent to a port if tracing is on. */
+static inline void
+chain_trace_tx(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	if (unlikely(g_chain_trace_on))
+		chain_trace_send(port_id, pkts, nb_pkts);
+}
+
+#endif
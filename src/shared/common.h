@@ -75,6 +75,28 @@ struct port_info {
 	struct stats client_stats[MAX_CLIENT];
 };
 
+/*
+ * Cycles of TSC spent for polling, counted for an lcore or a component. A
+ * poll is busy if it receives any packets, or idle if not. It is written
+ * only by the lcore running the poll.
+ */
+struct poll_cycles {
+	uint64_t busy;  /* Cycles of polls receiving packets. */
+	uint64_t idle;  /* Cycles of empty polls. */
+	uint64_t pkts;  /* Packets received in busy polls. */
+} __rte_cache_aligned;
+
+/* Add cycles of a poll which received `nb_pkts` packets. */
+static inline void
+poll_cycles_add(struct poll_cycles *pc, uint64_t cycles, uint64_t nb_pkts)
+{
+	if (nb_pkts > 0) {
+		pc->busy += cycles;
+		pc->pkts += nb_pkts;
+	} else
+		pc->idle += cycles;
+}
+
 enum port_type {
 	PHY,
 	RING,
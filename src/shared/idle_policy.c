@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <rte_log.h>
+#include "shared/idle_policy.h"
+
+#define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
+
+struct idle_policy g_idle_policy = {
+	.pause_thresh = IDLE_PAUSE_THRESH,
+	.sleep_thresh = IDLE_SLEEP_THRESH,
+	.max_sleep_us = IDLE_MAX_SLEEP_US,
+};
+
+/* Parse an unsigned value followed by `delim`, and return next of it. */
+static const char *
+parse_idle_val(const char *str, char delim, uint32_t *val)
+{
+	char *endptr = NULL;
+	unsigned long res;
+
+	errno = 0;
+	res = strtoul(str, &endptr, 10);
+	if (errno != 0 || endptr == str || *endptr != delim ||
+			res > UINT32_MAX)
+		return NULL;
+
+	*val = (uint32_t)res;
+	return endptr + 1;
+}
+
+/* Parse idle policy and set it to `g_idle_policy`. */
+int
+parse_idle_policy(const char *str)
+{
+	struct idle_policy policy;
+
+	str = parse_idle_val(str, ',', &policy.pause_thresh);
+	if (str != NULL)
+		str = parse_idle_val(str, ',', &policy.sleep_thresh);
+	if (str != NULL)
+		str = parse_idle_val(str, '\0', &policy.max_sleep_us);
+	if (str == NULL) {
+		RTE_LOG(ERR, SHARED, "Invalid idle policy, expected "
+				"PAUSE_THRESH,SLEEP_THRESH,MAX_SLEEP_US.\n");
+		return -1;
+	}
+
+	if (policy.sleep_thresh < policy.pause_thresh) {
+		RTE_LOG(ERR, SHARED, "Sleep threshold %u of idle policy "
+				"is less than pause threshold %u.\n",
+				policy.sleep_thresh, policy.pause_thresh);
+		return -1;
+	}
+
+	g_idle_policy = policy;
+	RTE_LOG(INFO, SHARED, "Idle policy: pause after %u, sleep after %u "
+			"empty polls, max sleep %u us.\n",
+			policy.pause_thresh, policy.sleep_thresh,
+			policy.max_sleep_us);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_IDLE_POLICY_H__
+#define __SHARED_IDLE_POLICY_H__
+
+/**
+ * @file
+ * Adaptive idle policy of worker lcores
+ *
+ * Worker lcore is busy polling while it receives packets. If it continues
+ * to receive no packets, it calls rte_pause() after `pause_thresh` empty
+ * polls, and sleeps after `sleep_thresh` empty polls. Duration of sleep is
+ * doubled from 1 usec for each of empty polls, but not exceeding
+ * `max_sleep_us` which is the upper bound of latency added to the first
+ * packet after idle. Sleeping is disabled if `max_sleep_us` is 0.
+ */
+
+#include <stdint.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_pause.h>
+
+#define IDLE_PAUSE_THRESH 256  /* Default num of empty polls to pause. */
+#define IDLE_SLEEP_THRESH 4096  /* Default num of empty polls to sleep. */
+#define IDLE_MAX_SLEEP_US 0  /* Default max sleep, not sleep if 0. */
+
+/* Sleep of lcore while no component or patch is running, in usec. */
+#define IDLE_STOP_SLEEP_US 1000
+
+/* Thresholds of idle policy given by `--idle-policy` option. */
+struct idle_policy {
+	uint32_t pause_thresh;  /* Num of empty polls to start pausing. */
+	uint32_t sleep_thresh;  /* Num of empty polls to start sleeping. */
+	uint32_t max_sleep_us;  /* Max duration of a sleep in usec. */
+};
+
+/* Idle state of a lcore, initialized with zero. */
+struct idle_state {
+	uint32_t nof_empty;  /* Num of consecutive empty polls. */
+	uint32_t sleep_us;  /* Duration of the last sleep. */
+};
+
+/* Idle policy shared with all lcores. It is not changed after launched. */
+extern struct idle_policy g_idle_policy;
+
+/**
+ * Update idle state with the result of a poll, and pause or sleep if
+ * the lcore has been idle long enough.
+ *
+ * @param[in,out] st Idle state of the caller lcore.
+ * @param[in] nb_pkts Num of packets received in the poll.
+ */
+static inline void
+idle_policy_poll(struct idle_state *st, unsigned int nb_pkts)
+{
+	const struct idle_policy *policy = &g_idle_policy;
+
+	if (likely(nb_pkts > 0)) {
+		st->nof_empty = 0;
+		st->sleep_us = 0;
+		return;
+	}
+
+	if (st->nof_empty < policy->sleep_thresh)
+		st->nof_empty++;
+	if (st->nof_empty < policy->pause_thresh)
+		return;
+
+	if (policy->max_sleep_us == 0 ||
+			st->nof_empty < policy->sleep_thresh) {
+		rte_pause();
+		return;
+	}
+
+	if (st->sleep_us == 0)
+		st->sleep_us = 1;
+	else if (st->sleep_us < policy->max_sleep_us / 2)
+		st->sleep_us *= 2;
+	else
+		st->sleep_us = policy->max_sleep_us;
+	rte_delay_us_sleep(st->sleep_us);
+}
+
+/**
+ * Sleep while the lcore has nothing to run, and reset its idle state so
+ * that it starts busy polling when it gets something.
+ *
+ * @param[in,out] st Idle state of the caller lcore.
+ */
+static inline void
+idle_policy_stopped(struct idle_state *st)
+{
+	st->nof_empty = 0;
+	st->sleep_us = 0;
+	rte_delay_us_sleep(IDLE_STOP_SLEEP_US);
+}
+
+/**
+ * Parse idle policy of the form `PAUSE_THRESH,SLEEP_THRESH,MAX_SLEEP_US`
+ * such as `256,4096,100` and set it to `g_idle_policy`.
+ *
+ * @param[in] str Value of `--idle-policy` option.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int parse_idle_policy(const char *str);
+
+#endif
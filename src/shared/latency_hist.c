@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+#include <rte_common.h>
+#include "shared/latency_hist.h"
+
+void
+lat_hist_merge(struct lat_hist *dst, const struct lat_hist *src)
+{
+	unsigned int i;
+
+	for (i = 0; i < LAT_HIST_NOF_ENT; i++)
+		dst->distr[i] += src->distr[i];
+	dst->count += src->count;
+	dst->max = RTE_MAX(dst->max, src->max);
+}
+
+/* Get p50, p99, p99.9 and max of latency in nano sec. */
+void
+lat_hist_summarize(const struct lat_hist *hist, uint64_t tsc_hz,
+		struct lat_summary *summary)
+{
+	unsigned int i;
+	uint64_t sum = 0;
+	uint64_t cycles_per_us = tsc_hz / 1000000;
+	/* Num of packets less than each of percentiles, per 10000. */
+	const uint64_t pcts[] = { 5000, 9900, 9990 };
+	uint64_t *vals[] = { &summary->p50, &summary->p99, &summary->p999 };
+	unsigned int nof_vals = 0;
+
+	memset(summary, 0x00, sizeof(*summary));
+	summary->count = hist->count;
+	if (hist->count == 0)
+		return;
+	if (unlikely(cycles_per_us == 0))
+		cycles_per_us = 1;
+
+	/* Convert cycles to nano sec without floating point. */
+	summary->max = hist->max * 1000 / cycles_per_us;
+	for (i = 0; i < LAT_HIST_NOF_ENT && nof_vals < RTE_DIM(pcts); i++) {
+		sum += hist->distr[i];
+		while (nof_vals < RTE_DIM(pcts) &&
+				sum * 10000 >= hist->count * pcts[nof_vals]) {
+			*vals[nof_vals] = RTE_MIN(lat_hist_bucket_upper(i),
+					hist->max) * 1000 / cycles_per_us;
+			nof_vals++;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_LATENCY_HIST_H__
+#define __SHARED_LATENCY_HIST_H__
+
+/**
+ * @file
+ * Histogram of latency
+ *
+ * Latency is counted in TSC cycles with log-linear histogram like HDR
+ * histogram. Latency less than LAT_HIST_SUB_CNT cycles is counted in the
+ * entry of each of cycles. Larger latency is counted in one of
+ * LAT_HIST_SUB_CNT entries dividing the range between its power of two and
+ * the next one, so the error of each of entries is less than
+ * 1/LAT_HIST_SUB_CNT. If the latency is larger than 2^LAT_HIST_MAX_BITS
+ * cycles, it is added to the last entry.
+ */
+
+#include <stdint.h>
+#include <rte_branch_prediction.h>
+
+#define LAT_HIST_SUB_BITS 4
+#define LAT_HIST_SUB_CNT (1 << LAT_HIST_SUB_BITS)
+#define LAT_HIST_MAX_BITS 36
+#define LAT_HIST_NOF_ENT \
+	((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB_CNT)
+
+/* Histogram of latency in cycles. */
+struct lat_hist {
+	uint64_t count;  /* num of measured packets */
+	uint64_t max;  /* max latency in cycles */
+	uint64_t distr[LAT_HIST_NOF_ENT]; /* distribution of cycles */
+};
+
+/* Percentiles of latency in nano sec. */
+struct lat_summary {
+	uint64_t count;  /* num of measured packets */
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t p999;
+	uint64_t max;
+};
+
+/* Get index of entry of histogram for given latency in cycles. */
+static inline unsigned int
+lat_hist_bucket(uint64_t cycles)
+{
+	unsigned int msb, shift;
+
+	if (cycles < LAT_HIST_SUB_CNT)
+		return (unsigned int)cycles;
+
+	msb = 63 - __builtin_clzll(cycles);
+	if (unlikely(msb >= LAT_HIST_MAX_BITS))
+		return LAT_HIST_NOF_ENT - 1;
+
+	shift = msb - LAT_HIST_SUB_BITS;
+	return (shift + 1) * LAT_HIST_SUB_CNT +
+		(unsigned int)((cycles >> shift) & (LAT_HIST_SUB_CNT - 1));
+}
+
+/* Get the largest latency in cycles counted in the entry of given index. */
+static inline uint64_t
+lat_hist_bucket_upper(unsigned int idx)
+{
+	unsigned int shift;
+
+	if (idx < LAT_HIST_SUB_CNT)
+		return idx;
+
+	shift = idx / LAT_HIST_SUB_CNT - 1;
+	return ((uint64_t)(LAT_HIST_SUB_CNT + idx % LAT_HIST_SUB_CNT)
+			<< shift) + (1ULL << shift) - 1;
+}
+
+/* Count a latency in cycles. */
+static inline void
+lat_hist_add(struct lat_hist *hist, uint64_t cycles)
+{
+	hist->distr[lat_hist_bucket(cycles)]++;
+	hist->count++;
+	if (cycles > hist->max)
+		hist->max = cycles;
+}
+
+/**
+ * Add counts of a histogram to another one. It is used to merge histograms
+ * counted by each of lcores.
+ *
+ * @param[in,out] dst Histogram to be added to.
+ * @param[in] src Histogram to be added.
+ */
+void lat_hist_merge(struct lat_hist *dst, const struct lat_hist *src);
+
+/**
+ * Get p50, p99, p99.9 and max of latency in nano sec. Each of percentiles
+ * is the upper bound of the entry, but not larger than max.
+ *
+ * @param[in] hist Histogram of latency.
+ * @param[in] tsc_hz Frequency of TSC.
+ * @param[out] summary Percentiles of latency.
+ */
+void lat_hist_summarize(const struct lat_hist *hist, uint64_t tsc_hz,
+		struct lat_summary *summary);
+
+#endif
@@ -146,7 +146,7 @@ add_vhost_pmd(int index)
 	};
 	struct rte_mempool *mp;
 	uint16_t vhost_port_id;
-	int nr_queues = 1;
+	int nr_queues = get_vhost_nof_queues();
 	const char *name;
 	char devargs[64];
 	char *iface;
@@ -177,7 +177,7 @@ add_vhost_pmd(int index)
 		return ret;
 	}
 
-	/* Allocate and set up 1 RX queue per Ethernet port. */
+	/* Allocate and set up RX queues per Ethernet port. */
 	for (q = 0; q < nr_queues; q++) {
 		ret = rte_eth_rx_queue_setup(vhost_port_id, q, NR_DESCS,
 			rte_eth_dev_socket_id(vhost_port_id), NULL, mp);
@@ -190,7 +190,7 @@ add_vhost_pmd(int index)
 		}
 	}
 
-	/* Allocate and set up 1 TX queue per Ethernet port. */
+	/* Allocate and set up TX queues per Ethernet port. */
 	for (q = 0; q < nr_queues; q++) {
 		ret = rte_eth_tx_queue_setup(vhost_port_id, q, NR_DESCS,
 			rte_eth_dev_socket_id(vhost_port_id), NULL);
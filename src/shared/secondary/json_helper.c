@@ -40,6 +40,27 @@ append_json_uint_value(char **output, const char *name, unsigned int value)
 	return SPPWK_RET_OK;
 }
 
+/* Add a uint64 value to given JSON string. */
+int
+append_json_uint64_value(char **output, const char *name, uint64_t value)
+{
+	int len = strlen(*output);
+
+	*output = spp_strbuf_append(*output, "",
+			strlen(name) + JSON_APPEND_LEN*3);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, WK_JSON_HELPER,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %"PRIu64")\n",
+				name, value);
+		return SPPWK_RET_NG;
+	}
+
+	sprintf(&(*output)[len], JSON_APPEND_VALUE("%"PRIu64),
+			JSON_APPEND_COMMA(len), name, value);
+	return SPPWK_RET_OK;
+}
+
 /* Add an int value to given JSON string. */
 int
 append_json_int_value(char **output, const char *name, int value)
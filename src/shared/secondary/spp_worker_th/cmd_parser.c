@@ -75,6 +75,18 @@ sppwk_cmd_type_str(enum sppwk_cmd_type ctype)
 		return "component";
 	case SPPWK_CMDTYPE_PORT:
 		return "port";
+	case SPPWK_CMDTYPE_LB_HASH:
+	case SPPWK_CMDTYPE_LB_WEIGHT:
+	case SPPWK_CMDTYPE_LB_RETA:
+		return "lb_table";
+	case SPPWK_CMDTYPE_LAT_PROBE:
+		return "latency_probe";
+	case SPPWK_CMDTYPE_CHAIN_TRACE:
+		return "chain_trace";
+	case SPPWK_CMDTYPE_MIR_TABLE:
+		return "mirror_table";
+	case SPPWK_CMDTYPE_FLUSH_THRESH:
+		return "flush_thresh";
 	default:
 		return "unknown";
 	}
@@ -89,6 +101,54 @@ const char *CLS_TYPE_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"flow",
+	"",  /* termination */
+};
+
+/**
+ * List of hash function of load balancer. The order of items should be same
+ * as the order of enum `sppwk_lb_hash_type` defined in cmd_utils.h.
+ */
+const char *LB_HASH_LIST[] = {
+	"none",
+	"toeplitz",
+	"crc",
+	"",  /* termination */
+};
+
+/**
+ * List of copy mode of mirror. The order of items should be same as the
+ * order of enum `sppwk_mir_copy_mode` defined in cmd_utils.h.
+ */
+const char *MIR_COPY_LIST[] = {
+	"shallow",
+	"deep",
+	"header",
+	"",  /* termination */
+};
+
+/**
+ * List of policies of mirror. The order of items should be same as the
+ * order of enum `sppwk_mir_policy` defined in cmd_utils.h.
+ */
+const char *MIR_POLICY_LIST[] = {
+	"drop_mirror",
+	"keep_original",
+	"block",
+	"",  /* termination */
+};
+
+/**
+ * List of options of mirror_table command. The order of items should be same
+ * as the order of enum `sppwk_mir_opt` defined in cmd_parser.h.
+ */
+const char *MIR_OPT_LIST[] = {
+	"copy",
+	"filter",
+	"sample",
+	"rate",
+	"snaplen",
+	"policy",
 	"",  /* termination */
 };
 
@@ -113,6 +173,8 @@ const char *PORT_ABILITY_LIST[] = {
 	"none",
 	"add_vlantag",
 	"del_vlantag",
+	"add_stag",
+	"set_pcp",
 	"",  /* termination */
 };
 
@@ -311,6 +373,45 @@ parse_port_uid(void *output, const char *arg_val)
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Parse given res UID of port with optional queue ID, such as `phy:0:1`.
+ * Queue 0 is used if queue ID is omitted as `phy:0`.
+ */
+static int
+parse_port_queue_uid(struct sppwk_port_idx *port, const char *arg_val)
+{
+	int ret;
+	unsigned int queue_id = 0;
+	char res_uid[SPPWK_VAL_BUFSZ];
+	char *queue_str = NULL;
+
+	if (strlen(arg_val) >= SPPWK_VAL_BUFSZ)
+		return SPPWK_RET_NG;
+	strcpy(res_uid, arg_val);
+
+	/* Queue ID is given after the second delimiter. */
+	queue_str = strchr(res_uid, ':');
+	if (queue_str != NULL)
+		queue_str = strchr(queue_str + 1, ':');
+	if (queue_str != NULL) {
+		*queue_str = '\0';
+		ret = get_uint_in_range(&queue_id, queue_str + 1, 0,
+				RTE_MAX_QUEUES_PER_PORT - 1);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid queue ID in '%s'.\n", arg_val);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = parse_port_uid(port, res_uid);
+	if (ret < SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	port->queue_id = queue_id;
+	return SPPWK_RET_OK;
+}
+
 /* Parse given lcore ID. */
 static int
 parse_lcore_id(void *output, const char *arg_val)
@@ -420,6 +521,35 @@ parse_comp_type(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Parse given capacity of classifier table of `arg_val` in `component`
+ * command. It is accepted only for starting classifier.
+ */
+static int
+parse_comp_cls_tbl_size(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int ret;
+	struct sppwk_cmd_comp *component = output;
+
+	if (unlikely(component->wk_action != SPPWK_ACT_START ||
+			component->wk_type != SPPWK_TYPE_CLS)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Table size is only for classifier '%s'.\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	ret = get_uint_in_range(&component->cls_tbl_size, arg_val,
+			SPPWK_CLS_TBL_SIZE_MIN, SPPWK_CLS_TBL_SIZE_MAX);
+	if (unlikely(ret < 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid table size '%s'.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
 /* Parse given action for port of `arg_val` in `port` command. */
 static int
 parse_port_action(void *output, const char *arg_val,
@@ -450,34 +580,20 @@ parse_port_action(void *output, const char *arg_val,
 
 /* Parse given port uid in port command. */
 static int
-parse_port(void *output, const char *arg_val, int allow_override)
+parse_port(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
 {
 	int ret;
 	struct sppwk_port_idx tmp_port;
 	struct sppwk_cmd_port *port = output;
 
-	ret = parse_port_uid(&tmp_port, arg_val);
+	ret = parse_port_queue_uid(&tmp_port, arg_val);
 	if (ret < SPPWK_RET_OK)
 		return SPPWK_RET_NG;
 
-	/* If action is `add`, check the port is already used for rx and tx. */
-	if (allow_override == 0) {
-		if ((port->wk_action == SPPWK_ACT_ADD) &&
-				(sppwk_check_used_port(tmp_port.iface_type,
-						tmp_port.iface_no,
-						SPPWK_PORT_DIR_RX) >= 0) &&
-				(sppwk_check_used_port(tmp_port.iface_type,
-						tmp_port.iface_no,
-						SPPWK_PORT_DIR_TX) >= 0)) {
-			RTE_LOG(ERR, WK_CMD_PARSER,
-				"Port `%s` is already used.\n",
-				arg_val);
-			return SPPWK_RET_NG;
-		}
-	}
-
 	port->port.iface_type = tmp_port.iface_type;
 	port->port.iface_no   = tmp_port.iface_no;
+	port->port.queue_id   = tmp_port.queue_id;
 	return SPPWK_RET_OK;
 }
 
@@ -495,11 +611,16 @@ parse_port_direction(void *output, const char *arg_val, int allow_override)
 		return SPPWK_RET_NG;
 	}
 
-	/* add vlantag command check */
-	if (allow_override == 0) {
+	/**
+	 * RX queue is dedicated to a component, but TX queue can be shared
+	 * among components because it is resolved to a queue or staging ring
+	 * for each of lcores when components are updated.
+	 */
+	if ((allow_override == 0) && (ret == SPPWK_PORT_DIR_RX)) {
 		if ((port->wk_action == SPPWK_ACT_ADD) &&
 				(sppwk_check_used_port(port->port.iface_type,
-					port->port.iface_no, ret) >= 0)) {
+					port->port.iface_no,
+					port->port.queue_id, ret) >= 0)) {
 			RTE_LOG(ERR, WK_CMD_PARSER,
 				"Port in used. (port command) val=%s\n",
 				arg_val);
@@ -507,6 +628,17 @@ parse_port_direction(void *output, const char *arg_val, int allow_override)
 		}
 	}
 
+	/* Check if the port has the queue in given direction. */
+	if ((port->wk_action == SPPWK_ACT_ADD) &&
+			(port->port.queue_id >= sppwk_get_nof_queues(
+				get_sppwk_port(port->port.iface_type,
+					port->port.iface_no), ret))) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+			"No queue %u of port for %s.\n",
+			port->port.queue_id, arg_val);
+		return SPPWK_RET_NG;
+	}
+
 	port->dir = ret;
 	return SPPWK_RET_OK;
 }
@@ -557,6 +689,9 @@ parse_port_vlan_ops(void *output, const char *arg_val,
 		}
 		port_attrs->ops = ret;
 		port_attrs->dir = port->dir;
+		if (ret == SPPWK_PORT_OPS_ADD_STAG)
+			port_attrs->capability.vlantag.tpid =
+					RTE_ETHER_TYPE_QINQ;
 		break;
 	case SPPWK_PORT_OPS_ADD_VLAN:
 		/* Nothing to do. */
@@ -580,6 +715,7 @@ parse_port_vid(void *output, const char *arg_val,
 
 	switch (port_attrs->ops) {
 	case SPPWK_PORT_OPS_ADD_VLAN:
+	case SPPWK_PORT_OPS_ADD_STAG:
 		vlan_id = get_int_in_range(&port_attrs->capability.vlantag.vid,
 			arg_val, 0, ETH_VLAN_ID_MAX);
 		if (unlikely(vlan_id < SPPWK_RET_OK)) {
@@ -590,6 +726,17 @@ parse_port_vid(void *output, const char *arg_val,
 		}
 		port_attrs->capability.vlantag.pcp = -1;
 		break;
+	case SPPWK_PORT_OPS_SET_PCP:
+		/* PCP is given instead of VLAN ID for `set_pcp`. */
+		if (unlikely(get_int_in_range(
+				&port_attrs->capability.vlantag.pcp,
+				arg_val, 0, SPP_VLAN_PCP_MAX) < SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid `%s` for parsing PCP.\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+		break;
 	default:
 		/* Not used. */
 		break;
@@ -609,6 +756,7 @@ parse_port_pcp(void *output, const char *arg_val,
 
 	switch (port_attrs->ops) {
 	case SPPWK_PORT_OPS_ADD_VLAN:
+	case SPPWK_PORT_OPS_ADD_STAG:
 		pcp = get_int_in_range(&port_attrs->capability.vlantag.pcp,
 				arg_val, 0, SPP_VLAN_PCP_MAX);
 		if (unlikely(pcp < SPPWK_RET_OK)) {
@@ -626,6 +774,37 @@ parse_port_pcp(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/* Parse TPID of outer tag for port command. */
+static int
+parse_port_tpid(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int tpid;
+	struct sppwk_cmd_port *port = output;
+	struct sppwk_port_attrs *port_attrs = &port->port_attrs;
+
+	switch (port_attrs->ops) {
+	case SPPWK_PORT_OPS_ADD_STAG:
+		if (unlikely(get_int_in_range(&tpid, arg_val, 0,
+				UINT16_MAX) < SPPWK_RET_OK) ||
+				unlikely(tpid != RTE_ETHER_TYPE_VLAN &&
+				tpid != RTE_ETHER_TYPE_QINQ &&
+				tpid != SPP_ETHER_TYPE_QINQ_OLD)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid `%s` for parsing TPID.\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+		port_attrs->capability.vlantag.tpid = tpid;
+		break;
+	default:
+		/* Not used. */
+		break;
+	}
+
+	return SPPWK_RET_OK;
+}
+
 /* Parse mac address string. */
 static int
 parse_mac_addr(void *output, const char *arg_val,
@@ -650,6 +829,46 @@ parse_mac_addr(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/* Parse mac address of classifier_table command which takes VLAN ID. */
+static int
+parse_cls_mac_addr(void *cls_cmd_attr, const char *arg_val,
+		int allow_override)
+{
+	struct sppwk_cls_cmd_attrs *cls_attrs = cls_cmd_attr;
+
+	if (unlikely(cls_attrs->cls_type == SPPWK_CLS_TYPE_FLOW)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"VLAN ID cannot be given for flow rules.\n");
+		return SPPWK_RET_NG;
+	}
+
+	return parse_mac_addr(cls_attrs->mac, arg_val, allow_override);
+}
+
+/* Parse mac address or flow rules depending on type of classifier. */
+static int
+parse_cls_addr(void *cls_cmd_attr, const char *arg_val,
+		int allow_override)
+{
+	struct sppwk_cls_cmd_attrs *cls_attrs = cls_cmd_attr;
+	struct sppwk_flow_rule rules[SPPWK_MAX_FLOW_RULES];
+
+	if (cls_attrs->cls_type != SPPWK_CLS_TYPE_FLOW)
+		return parse_mac_addr(cls_attrs->mac, arg_val,
+				allow_override);
+
+	/* Check if the given rules are valid. */
+	if (unlikely(sppwk_parse_flow_rules(arg_val, rules,
+			SPPWK_MAX_FLOW_RULES) < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid flow rules `%s`.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	strcpy(cls_attrs->flow_rules, arg_val);
+	return SPPWK_RET_OK;
+}
+
 /**
  * Parse given action for getting index of actions for `classifier_table`
  * command.
@@ -735,7 +954,13 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 	if (cls_attrs->cls_type == SPPWK_CLS_TYPE_MAC)
 		cls_attrs->vid = ETH_VLAN_ID_MAX;
 
-	if (unlikely(cls_attrs->wk_action == SPPWK_ACT_ADD)) {
+	/**
+	 * Flow rules are not bound to the MAC address of port, and several
+	 * of rules can be added to the same port.
+	 */
+	if (cls_attrs->cls_type == SPPWK_CLS_TYPE_FLOW) {
+		cls_attrs->vid = ETH_VLAN_ID_MAX;
+	} else if (unlikely(cls_attrs->wk_action == SPPWK_ACT_ADD)) {
 		if (!is_used_with_addr(ETH_VLAN_ID_MAX, 0,
 				tmp_port.iface_type, tmp_port.iface_no)) {
 			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
@@ -763,6 +988,305 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/* Check keyword `hash` of lb_table command. */
+static int
+parse_lb_hash_keyword(void *output __attribute__ ((unused)),
+		const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	if (unlikely(strcmp(arg_val, "hash") != 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown lb_table keyword. val=%s\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Check keyword `weight` of lb_table command. */
+static int
+parse_lb_weight_keyword(void *output __attribute__ ((unused)),
+		const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	if (unlikely(strcmp(arg_val, "weight") != 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown lb_table keyword. val=%s\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Check keyword `reta` of lb_table command. */
+static int
+parse_lb_reta_keyword(void *output __attribute__ ((unused)),
+		const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	if (unlikely(strcmp(arg_val, "reta") != 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown lb_table keyword. val=%s\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse hash function for lb_table command. */
+static int
+parse_lb_hash_type(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int idx;
+	idx = get_list_idx(arg_val, LB_HASH_LIST);
+	if (unlikely(idx <= 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown hash function. val=%s\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	*(int *)output = idx;
+	return SPPWK_RET_OK;
+}
+
+/* Parse TX port for lb_table command. */
+static int
+parse_lb_port(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int ret;
+	struct sppwk_port_idx tmp_port;
+
+	ret = parse_port_uid(&tmp_port, arg_val);
+	if (ret < SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	if (is_added_port(tmp_port.iface_type, tmp_port.iface_no) == 0) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Port not added. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	memcpy(output, &tmp_port, sizeof(tmp_port));
+	return SPPWK_RET_OK;
+}
+
+/* Parse TX port of entries of indirection table, or `none` for weights. */
+static int
+parse_lb_reta_port(void *output, const char *arg_val, int allow_override)
+{
+	struct sppwk_port_idx *port = output;
+
+	if (strcmp(arg_val, "none") == 0) {
+		port->iface_type = UNDEF;
+		port->iface_no = 0;
+		return SPPWK_RET_OK;
+	}
+	return parse_lb_port(output, arg_val, allow_override);
+}
+
+/* Parse index of entry of indirection table for lb_table command. */
+static int
+parse_lb_reta_idx(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int ret;
+	ret = get_uint_in_range(output, arg_val, 0, SPPWK_LB_RETA_SIZE - 1);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid index of indirection table `%s`.\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse weight of TX port for lb_table command. */
+static int
+parse_lb_weight(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int ret;
+	ret = get_uint_in_range(output, arg_val, 0, SPPWK_LB_WEIGHT_MAX);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Invalid weight `%s`.\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse option keyword of mirror_table command. */
+static int
+parse_mir_opt(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int idx;
+
+	idx = get_list_idx(arg_val, MIR_OPT_LIST);
+	if (unlikely(idx < 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown mirror_table keyword. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	*(enum sppwk_mir_opt *)output = idx;
+	return SPPWK_RET_OK;
+}
+
+/* Parse value of option of mirror_table command. */
+static int
+parse_mir_opt_val(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int idx;
+	int ret = SPPWK_RET_OK;
+	struct sppwk_mir_cmd_attrs *attrs = output;
+
+	switch (attrs->opt) {
+	case SPPWK_MIR_OPT_COPY:
+		idx = get_list_idx(arg_val, MIR_COPY_LIST);
+		if (unlikely(idx < 0)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Unknown copy mode. val=%s\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+		attrs->copy_mode = idx;
+		break;
+	case SPPWK_MIR_OPT_FILTER:
+		/* Filter is removed with `off`. */
+		if (strcmp(arg_val, "off") == 0)
+			attrs->filter[0] = '\0';
+		else if (strlen(arg_val) < SPPWK_VAL_BUFSZ)
+			strcpy(attrs->filter, arg_val);
+		else {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Too long BPF file. val=%s\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+		break;
+	case SPPWK_MIR_OPT_SAMPLE:
+		ret = get_uint_in_range(&attrs->val, arg_val, 1,
+				SPPWK_MIR_SAMPLE_MAX);
+		break;
+	case SPPWK_MIR_OPT_RATE:
+		ret = get_uint_in_range(&attrs->val, arg_val, 0,
+				SPPWK_MIR_RATE_MAX);
+		break;
+	case SPPWK_MIR_OPT_SNAPLEN:
+		ret = get_uint_in_range(&attrs->val, arg_val, 0,
+				SPPWK_MIR_SNAPLEN_MAX);
+		break;
+	case SPPWK_MIR_OPT_POLICY:
+		idx = get_list_idx(arg_val, MIR_POLICY_LIST);
+		if (unlikely(idx < 0)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Unknown mirror policy. val=%s\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+		attrs->policy = idx;
+		break;
+	default:
+		return SPPWK_RET_NG;
+	}
+
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid value of %s. val=%s\n",
+				MIR_OPT_LIST[attrs->opt], arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse `on` or `off` for latency_probe or chain_trace command. */
+static int
+parse_switch(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	if (strcmp(arg_val, "on") == 0)
+		*(int *)output = 1;
+	else if (strcmp(arg_val, "off") == 0)
+		*(int *)output = 0;
+	else {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown switch, not on or off. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse target of latency_probe command, which is a ring port or name of
+ * component.
+ */
+static int
+parse_lat_probe_target(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	struct sppwk_lat_probe_cmd_attrs *attrs = output;
+
+	memset(&attrs->port, 0x00, sizeof(attrs->port));
+	attrs->port.iface_type = UNDEF;
+	attrs->name[0] = '\0';
+
+	/* Component name is given if it is not a port UID. */
+	if (strchr(arg_val, ':') == NULL)
+		return parse_comp_name_portcmd(attrs->name, arg_val, 0);
+
+	if (parse_port_uid(&attrs->port, arg_val) < SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	if (attrs->port.iface_type != RING) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Latency is measured only for ring. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	if (is_added_port(attrs->port.iface_type,
+			attrs->port.iface_no) == 0) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Port not added. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse port of flush_thresh command, which should be added already. */
+static int
+parse_flush_thresh_port(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	struct sppwk_port_idx *port = output;
+
+	if (parse_port_uid(port, arg_val) < SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	if (is_added_port(port->iface_type, port->iface_no) == 0) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Port not added. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Parse num of packets of flush_thresh command. */
+static int
+parse_flush_thresh_val(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	if (get_uint_in_range(output, arg_val, 1, MAX_PKT_BURST) < 0) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid flush threshold. val=%s\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
 /* Attributes operation functions of command for parsing. */
 struct sppwk_cmd_ops {
 	const char *name;
@@ -779,7 +1303,7 @@ struct sppwk_cmd_ops {
 /* TODO(yasufum) It must be separated into each of commands. */
 static struct sppwk_cmd_ops
 cmd_ops_list[][SPPWK_MAX_PARAMS] = {
-	{  /* classifier_table(mac) */
+	{  /* classifier_table(mac or flow) */
 		{
 			.name = "action",
 			.offset = offsetof(struct sppwk_cmd_attrs,
@@ -793,10 +1317,10 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.func = parse_cls_type
 		},
 		{
-			.name = "mac address",
+			.name = "mac address or flow rules",
 			.offset = offsetof(struct sppwk_cmd_attrs,
-					spec.cls_table.mac),
-			.func = parse_mac_addr
+					spec.cls_table),
+			.func = parse_cls_addr
 		},
 		{
 			.name = "port",
@@ -828,8 +1352,8 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 		{
 			.name = "mac address",
 			.offset = offsetof(struct sppwk_cmd_attrs,
-					spec.cls_table.mac),
-			.func = parse_mac_addr
+					spec.cls_table),
+			.func = parse_cls_mac_addr
 		},
 		{
 			.name = "port",
@@ -864,6 +1388,11 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.offset = offsetof(struct sppwk_cmd_attrs, spec.comp),
 			.func = parse_comp_type
 		},
+		{
+			.name = "table size",
+			.offset = offsetof(struct sppwk_cmd_attrs, spec.comp),
+			.func = parse_comp_cls_tbl_size
+		},
 		SPPWK_CMD_NO_PARAMS,
 	},
 	{  /* port */
@@ -904,6 +1433,152 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.offset = offsetof(struct sppwk_cmd_attrs, spec.port),
 			.func = parse_port_pcp
 		},
+		{
+			.name = "port tpid",
+			.offset = offsetof(struct sppwk_cmd_attrs, spec.port),
+			.func = parse_port_tpid
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* lb_table(hash) */
+		{
+			.name = "component name",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.name),
+			.func = parse_comp_name_portcmd
+		},
+		{
+			.name = "hash",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table),
+			.func = parse_lb_hash_keyword
+		},
+		{
+			.name = "hash function",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.hash_type),
+			.func = parse_lb_hash_type
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* lb_table(weight) */
+		{
+			.name = "component name",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.name),
+			.func = parse_comp_name_portcmd
+		},
+		{
+			.name = "weight",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table),
+			.func = parse_lb_weight_keyword
+		},
+		{
+			.name = "port",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.port),
+			.func = parse_lb_port
+		},
+		{
+			.name = "weight value",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.weight),
+			.func = parse_lb_weight
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* lb_table(reta) */
+		{
+			.name = "component name",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.name),
+			.func = parse_comp_name_portcmd
+		},
+		{
+			.name = "reta",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table),
+			.func = parse_lb_reta_keyword
+		},
+		{
+			.name = "first index",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.reta_first),
+			.func = parse_lb_reta_idx
+		},
+		{
+			.name = "last index",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.reta_last),
+			.func = parse_lb_reta_idx
+		},
+		{
+			.name = "port",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lb_table.port),
+			.func = parse_lb_reta_port
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* latency_probe */
+		{
+			.name = "on or off",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lat_probe.on),
+			.func = parse_switch
+		},
+		{
+			.name = "port or component name",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.lat_probe),
+			.func = parse_lat_probe_target
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* chain_trace */
+		{
+			.name = "on or off",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.chain_trace.on),
+			.func = parse_switch
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* mirror_table */
+		{
+			.name = "component name",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.mir_table.name),
+			.func = parse_comp_name_portcmd
+		},
+		{
+			.name = "option",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.mir_table.opt),
+			.func = parse_mir_opt
+		},
+		{
+			.name = "value of option",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.mir_table),
+			.func = parse_mir_opt_val
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* flush_thresh */
+		{
+			.name = "port",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.flush_thresh.port),
+			.func = parse_flush_thresh_port
+		},
+		{
+			.name = "num of packets",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.flush_thresh.thresh),
+			.func = parse_flush_thresh_val
+		},
 		SPPWK_CMD_NO_PARAMS,
 	},
 	{ SPPWK_CMD_NO_PARAMS }, /* termination */
@@ -1027,8 +1702,15 @@ static struct cmd_parse_attrs cmd_attr_list[] = {
 	{ "_get_client_id", 1, 1, NULL },
 	{ "status", 1, 1, NULL },
 	{ "exit", 1, 1, NULL },
-	{ "component", 3, 5, parse_cmd_comp },
-	{ "port", 5, 8, parse_cmd_port },
+	{ "component", 3, 6, parse_cmd_comp },
+	{ "port", 5, 9, parse_cmd_port },
+	{ "lb_table", 4, 4, parse_cmd_comp },
+	{ "lb_table", 5, 5, parse_cmd_comp },
+	{ "lb_table", 6, 6, parse_cmd_comp },
+	{ "latency_probe", 3, 3, parse_cmd_comp },
+	{ "chain_trace", 2, 2, parse_cmd_comp },
+	{ "mirror_table", 4, 4, parse_cmd_comp },
+	{ "flush_thresh", 3, 3, parse_cmd_comp },
 	{ "", 0, 0, NULL }  /* termination */
 };
 
@@ -16,7 +16,7 @@
 #define SPPWK_MAX_CMDS 32
 
 /* Maximum number of parameters per command. */
-#define SPPWK_MAX_PARAMS 8
+#define SPPWK_MAX_PARAMS 9
 
 /* Size of string buffer of message including null char. */
 #define SPPWK_NAME_BUFSZ  32
@@ -24,6 +24,10 @@
 /* Size of string buffer of detailed message including null char. */
 #define SPPWK_VAL_BUFSZ 111
 
+/** Min and max capacity of classifier table of each VLAN. */
+#define SPPWK_CLS_TBL_SIZE_MIN 8
+#define SPPWK_CLS_TBL_SIZE_MAX (1 << 20)
+
 /**
  * Error code for diagnosis and notifying the reason. It starts from 1 because
  * 0 is used for succeeded and not appropriate for error in general.
@@ -42,6 +46,9 @@ enum sppwk_parse_error_code {
  *   - compomnent      : start, stop
  *   - port            : add, del
  *   - classifier_table: add, del
+ *   - lb_table        : hash, weight, reta
+ *   - latency_probe   : on, off
+ *   - flush_thresh    : num of packets
  */
 enum sppwk_action {
 	SPPWK_ACT_NONE,  /**< none */
@@ -73,6 +80,13 @@ enum sppwk_cmd_type {
 	SPPWK_CMDTYPE_EXIT,  /**< exit */
 	SPPWK_CMDTYPE_WORKER,  /**< worker thread */
 	SPPWK_CMDTYPE_PORT,  /**< port */
+	SPPWK_CMDTYPE_LB_HASH,  /**< lb_table of hash function */
+	SPPWK_CMDTYPE_LB_WEIGHT,  /**< lb_table of weight of port */
+	SPPWK_CMDTYPE_LB_RETA,  /**< lb_table of indirection table */
+	SPPWK_CMDTYPE_LAT_PROBE,  /**< latency_probe */
+	SPPWK_CMDTYPE_CHAIN_TRACE,  /**< chain_trace */
+	SPPWK_CMDTYPE_MIR_TABLE,  /**< mirror_table */
+	SPPWK_CMDTYPE_FLUSH_THRESH,  /**< flush_thresh */
 };
 
 const char *sppwk_cmd_type_str(enum sppwk_cmd_type ctype);
@@ -80,12 +94,64 @@ const char *sppwk_cmd_type_str(enum sppwk_cmd_type ctype);
 /* `classifier_table` command specific parameters. */
 struct sppwk_cls_cmd_attrs {
 	enum sppwk_action wk_action;  /**< add or del */
-	enum sppwk_cls_type cls_type;  /**< currently only for MAC. */
+	enum sppwk_cls_type cls_type;  /**< mac, vlan or flow. */
 	int vid;  /**< VLAN ID  */
 	char mac[SPPWK_VAL_BUFSZ];  /**< MAC address  */
+	char flow_rules[SPPWK_FLOW_RULES_BUFSZ];  /**< Flow rules joined `+` */
 	struct sppwk_port_idx port;/**< Destination port type and number */
 };
 
+/* `lb_table` command specific parameters. */
+struct sppwk_lb_cmd_attrs {
+	char name[SPPWK_NAME_BUFSZ];  /**< component name */
+	enum sppwk_lb_hash_type hash_type;  /**< toeplitz or crc */
+	struct sppwk_port_idx port;  /**< TX port given weight or entries */
+	unsigned int weight;  /**< weight of TX port */
+	unsigned int reta_first;  /**< first entry of indirection table */
+	unsigned int reta_last;  /**< last entry of indirection table */
+};
+
+/**
+ * `latency_probe` command specific parameters. Target is a ring port, or
+ * all of ring ports of a component if `name` is given.
+ */
+struct sppwk_lat_probe_cmd_attrs {
+	int on;  /**< 1 for on, or 0 for off */
+	struct sppwk_port_idx port;  /**< ring port, or UNDEF for component */
+	char name[SPPWK_NAME_BUFSZ];  /**< component name */
+};
+
+/* Option of mirror given by mirror_table command. */
+enum sppwk_mir_opt {
+	SPPWK_MIR_OPT_COPY,  /**< copy mode */
+	SPPWK_MIR_OPT_FILTER,  /**< BPF filter */
+	SPPWK_MIR_OPT_SAMPLE,  /**< 1-in-N sampling */
+	SPPWK_MIR_OPT_RATE,  /**< rate of copies */
+	SPPWK_MIR_OPT_SNAPLEN,  /**< length of copies */
+	SPPWK_MIR_OPT_POLICY,  /**< policy for packets not sent */
+};
+
+/* `mirror_table` command specific parameters. */
+struct sppwk_mir_cmd_attrs {
+	char name[SPPWK_NAME_BUFSZ];  /**< component name */
+	enum sppwk_mir_opt opt;  /**< option to be set */
+	enum sppwk_mir_copy_mode copy_mode;  /**< shallow, deep or header */
+	enum sppwk_mir_policy policy;  /**< policy for packets not sent */
+	char filter[SPPWK_VAL_BUFSZ];  /**< BPF file, or empty for off */
+	unsigned int val;  /**< value of sample, rate or snaplen */
+};
+
+/* `chain_trace` command specific parameters. */
+struct sppwk_chain_trace_cmd_attrs {
+	int on;  /**< 1 for on, or 0 for off */
+};
+
+/* `flush_thresh` command specific parameters. */
+struct sppwk_flush_thresh_cmd_attrs {
+	struct sppwk_port_idx port;  /**< TX port of classifier */
+	unsigned int thresh;  /**< num of packets transmitted at once */
+};
+
 /* `flush` command specific parameters. */
 struct sppwk_cmd_flush {
 	/* Take no params. */
@@ -97,6 +163,7 @@ struct sppwk_cmd_comp {
 	char name[SPPWK_NAME_BUFSZ];  /**< component name */
 	unsigned int core;  /**< logical core number */
 	enum sppwk_worker_type wk_type;  /**< worker thread type */
+	unsigned int cls_tbl_size;  /**< capacity of classifier table */
 };
 
 /* `port` command parameters. */
@@ -117,6 +184,11 @@ struct sppwk_cmd_attrs {
 		struct sppwk_cmd_flush flush;
 		struct sppwk_cmd_comp comp;
 		struct sppwk_cmd_port port;
+		struct sppwk_lb_cmd_attrs lb_table;
+		struct sppwk_lat_probe_cmd_attrs lat_probe;
+		struct sppwk_chain_trace_cmd_attrs chain_trace;
+		struct sppwk_mir_cmd_attrs mir_table;
+		struct sppwk_flush_thresh_cmd_attrs flush_thresh;
 	} spec;  /* TODO(yasufum) rename no reasonable name */
 };
 
@@ -4,7 +4,10 @@
 
 #include "cmd_res_formatter.h"
 #include "port_capability.h"
+#include "port_stats.h"
+#include "latency_stats.h"
 #include "cmd_utils.h"
+#include "shared/chain_trace.h"
 #include "shared/secondary/json_helper.h"
 
 #ifdef SPP_VF_MODULE
@@ -30,6 +33,8 @@ const char *PORT_ABILITY_STAT_LIST[] = {
 	"none",
 	"add",
 	"del",
+	"add_stag",
+	"set_pcp",
 	"",  /* termination */
 };
 
@@ -160,6 +165,8 @@ append_vlan_block(const char *name, char **output,
 		switch (port_attrs[i].ops) {
 		case SPPWK_PORT_OPS_ADD_VLAN:
 		case SPPWK_PORT_OPS_DEL_VLAN:
+		case SPPWK_PORT_OPS_ADD_STAG:
+		case SPPWK_PORT_OPS_SET_PCP:
 			ret = append_vlan_value(&tmp_buff, port_attrs[i].ops,
 					port_attrs[i].capability.vlantag.vid,
 					port_attrs[i].capability.vlantag.pcp);
@@ -190,6 +197,54 @@ append_vlan_block(const char *name, char **output,
 	return ret;
 }
 
+/* append a list of all of vlan operations in order for JSON format */
+static int
+append_vlan_ops_array(const char *name, char **output,
+		const int port_id, const enum sppwk_port_dir dir)
+{
+	int ret = SPPWK_RET_NG;
+	int i = 0;
+	struct sppwk_port_attrs *port_attrs = NULL;
+	char *tmp_ops = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	for (i = 0; i < PORT_CAPABL_MAX; i++) {
+		if (port_attrs[i].ops == SPPWK_PORT_OPS_NONE)
+			continue;
+
+		tmp_ops = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_ops == NULL)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+		ret = append_vlan_value(&tmp_ops, port_attrs[i].ops,
+				port_attrs[i].capability.vlantag.vid,
+				port_attrs[i].capability.vlantag.pcp);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_int_value(&tmp_ops, "tpid",
+				port_attrs[i].capability.vlantag.tpid);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&tmp_buff, "",
+					tmp_ops);
+		spp_strbuf_free(tmp_ops);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /**
  * Get consistent port ID of rte ethdev from resource UID such as `phy:0`.
  * It returns a port ID, or error code if it's failed to.
@@ -228,6 +283,9 @@ append_port_block(char **output, const struct sppwk_port_idx *port,
 	}
 
 	sppwk_port_uid(port_str, port->iface_type, port->iface_no);
+	/* Queue is shown as `phy:0:1` only if it is not default queue 0. */
+	if (port->queue_id > 0)
+		sprintf(port_str + strlen(port_str), ":%u", port->queue_id);
 	ret = append_json_str_value(&tmp_buff, "port", port_str);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
@@ -239,6 +297,13 @@ append_port_block(char **output, const struct sppwk_port_idx *port,
 	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
 
+	ret = append_vlan_ops_array("vlan_ops", &tmp_buff,
+			get_ethdev_port_id(
+				port->iface_type, port->iface_no),
+			dir);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
 	ret = append_json_block_brackets(output, "", tmp_buff);
 	spp_strbuf_free(tmp_buff);
 	return ret;
@@ -553,6 +618,399 @@ add_interface(const char *name, char **output,
 	return ret;
 }
 
+/* Append counters of a port such as `{ "port": "phy:0", "rx": 10, ... }`. */
+static int
+append_port_stats_block(char **output, enum port_type iface_type,
+		int iface_no)
+{
+	int ret;
+	char port_str[CMD_TAG_APPEND_SIZE];
+	struct sppwk_port_cnts cnts;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = port_stats)\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_sum_port_cnts(get_ethdev_port_id(iface_type, iface_no), &cnts);
+	sppwk_port_uid(port_str, iface_type, iface_no);
+	ret = append_json_str_value(&tmp_buff, "port", port_str);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "rx", cnts.rx);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "rx_drop",
+				cnts.rx_drop);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "rx_vlan_drop",
+				cnts.rx_vlan_drop);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "tx", cnts.tx);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "tx_drop",
+				cnts.tx_drop);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "tx_vlan_drop",
+				cnts.tx_vlan_drop);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Add entry of counters of each of ports, summed up for all of lcores, to
+ * a response in JSON.
+ */
+int
+add_port_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int i, j;
+	const enum port_type types[] = { PHY, VHOST, RING };
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	for (i = 0; i < (int)RTE_DIM(types); i++) {
+		for (j = 0; j < RTE_MAX_ETHPORTS; j++) {
+			if (!is_port_flushed(types[i], j))
+				continue;
+
+			ret = append_port_stats_block(&tmp_buff, types[i], j);
+			if (unlikely(ret < SPPWK_RET_OK)) {
+				spp_strbuf_free(tmp_buff);
+				return SPPWK_RET_NG;
+			}
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add entry of counters of classifying of each of lcores to a response. */
+int
+add_lcore_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	unsigned int lcore_id;
+	const struct sppwk_lcore_cnts *cnts;
+	char *tmp_lcore = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		tmp_lcore = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_lcore == NULL)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+
+		cnts = &g_sppwk_lcore_cnts[lcore_id];
+		ret = append_json_uint_value(&tmp_lcore, "core", lcore_id);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_lcore, "cls_miss",
+					cnts->cls_miss);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_lcore,
+					"mcast_fanout", cnts->mcast_fanout);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&tmp_buff, "",
+					tmp_lcore);
+		spp_strbuf_free(tmp_lcore);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Append busy and idle cycles and received packets of an entry. */
+static int
+append_poll_cycles(char **output, const struct poll_cycles *pc)
+{
+	int ret;
+
+	ret = append_json_uint64_value(output, "busy", pc->busy);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "idle", pc->idle);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "pkts", pc->pkts);
+	return ret;
+}
+
+/**
+ * Add entry of cycles of polling of each of lcores to a response in JSON.
+ * Poll is busy if it received packets, or idle if not.
+ */
+int
+add_lcore_cycles(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	unsigned int lcore_id;
+	char *tmp_lcore = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		tmp_lcore = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_lcore == NULL)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+
+		ret = append_json_uint_value(&tmp_lcore, "core", lcore_id);
+		if (ret == SPPWK_RET_OK)
+			ret = append_poll_cycles(&tmp_lcore,
+					&g_sppwk_lcore_cnts[lcore_id].cycles);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&tmp_buff, "",
+					tmp_lcore);
+		spp_strbuf_free(tmp_lcore);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add entry of cycles of polling of each of components in JSON. */
+int
+add_comp_cycles(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int comp_id;
+	struct sppwk_comp_info *comp_info = NULL;
+	const struct sppwk_comp_info *comp;
+	char *tmp_comp = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info, NULL, NULL, NULL, NULL);
+	for (comp_id = 0; comp_id < RTE_MAX_LCORE; comp_id++) {
+		comp = comp_info + comp_id;
+		if (comp->wk_type == SPPWK_TYPE_NONE)
+			continue;
+
+		tmp_comp = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_comp == NULL)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+
+		ret = append_json_str_value(&tmp_comp, "name", comp->name);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint_value(&tmp_comp, "core",
+					comp->lcore_id);
+		if (ret == SPPWK_RET_OK)
+			ret = append_poll_cycles(&tmp_comp,
+					&g_sppwk_comp_cycles[comp_id]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&tmp_buff, "",
+					tmp_comp);
+		spp_strbuf_free(tmp_comp);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Add entry of percentiles of latency of each of rings in nano sec to a
+ * response in JSON. Rings of which probe was never turned on are not
+ * included.
+ */
+int
+add_ring_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int ring_id;
+	char port_uid[STR_LEN_SHORT];
+	struct lat_hist stats;
+	struct lat_summary summary;
+	char *tmp_ring = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	for (ring_id = 0; ring_id < RTE_MAX_ETHPORTS; ring_id++) {
+		if (sppwk_get_ring_latency_stats(ring_id, &stats) !=
+				SPPWK_RET_OK)
+			continue;
+		lat_hist_summarize(&stats, rte_get_tsc_hz(),
+				&summary);
+
+		tmp_ring = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_ring == NULL)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+
+		sppwk_port_uid(port_uid, RING, ring_id);
+		ret = append_json_str_value(&tmp_ring, "port", port_uid);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_str_value(&tmp_ring, "probe",
+					sppwk_ring_latency_probe_is_on(
+					ring_id) ? "on" : "off");
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_ring, "count",
+					summary.count);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_ring, "p50",
+					summary.p50);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_ring, "p99",
+					summary.p99);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_ring, "p999",
+					summary.p999);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint64_value(&tmp_ring, "max",
+					summary.max);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&tmp_buff, "",
+					tmp_ring);
+		spp_strbuf_free(tmp_ring);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Append percentiles of latency from the ingress of service chain to a port,
+ * such as `{ "port": "ring:0", "point": "hop", "count": 10, ... }`.
+ */
+static int
+append_chain_latency_block(char **output, enum port_type iface_type,
+		int iface_no)
+{
+	int ret;
+	char port_str[CMD_TAG_APPEND_SIZE];
+	enum chain_trace_point point;
+	struct lat_hist hist;
+	struct lat_summary summary;
+	char *tmp_buff;
+
+	if (chain_trace_get_hist(get_ethdev_port_id(iface_type, iface_no),
+			&point, &hist) < 0)
+		return SPPWK_RET_OK;  /* Not traced. */
+	lat_hist_summarize(&hist, rte_get_tsc_hz(), &summary);
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = chain_latency)\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_port_uid(port_str, iface_type, iface_no);
+	ret = append_json_str_value(&tmp_buff, "port", port_str);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "point",
+				point == CHAIN_TRACE_EDGE ? "egress" : "hop");
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "count",
+				summary.count);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "p50", summary.p50);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "p99", summary.p99);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "p999",
+				summary.p999);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "max", summary.max);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/**
+ * Add entry of percentiles of latency from the ingress of service chain in
+ * nano sec to a response in JSON. Phy ports are egress and ring ports are
+ * hops of the chain. Ports which no stamped packet passed through are not
+ * included.
+ */
+int
+add_chain_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int i, j;
+	const enum port_type types[] = { PHY, RING };
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	for (i = 0; i < (int)RTE_DIM(types); i++) {
+		for (j = 0; j < RTE_MAX_ETHPORTS; j++) {
+			if (!is_port_flushed(types[i], j))
+				continue;
+
+			ret = append_chain_latency_block(&tmp_buff,
+					types[i], j);
+			if (unlikely(ret < SPPWK_RET_OK)) {
+				spp_strbuf_free(tmp_buff);
+				return SPPWK_RET_NG;
+			}
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /* Add entry of master lcore to a response in JSON. */
 int
 add_master_lcore(const char *name, char **output,
@@ -74,4 +74,22 @@ int add_interface(const char *name, char **output,
 
 int add_master_lcore(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
+
+int add_port_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_lcore_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_lcore_cycles(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_comp_cycles(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_ring_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_chain_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
 #endif
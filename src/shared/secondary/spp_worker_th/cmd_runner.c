@@ -12,6 +12,7 @@
 #include "cmd_res_formatter.h"
 #include "conn_spp_ctl.h"
 #include "cmd_parser.h"
+#include "port_capability.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
 
@@ -56,6 +57,10 @@ flush_cmd(void)
 	/* TODO(yasufum) confirm why no checking for returned value. */
 	ret = update_comp_info(p_comp_info, p_change_comp);
 
+	/* Workers refer the update side of port abilities after it. */
+	if (ret == SPPWK_RET_OK)
+		sppwk_apply_vlan_strip();
+
 	backup_mng_info(backup_info);
 	return ret;
 }
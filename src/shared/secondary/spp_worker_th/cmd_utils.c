@@ -2,16 +2,21 @@
  * Copyright(c) 2018-2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <arpa/inet.h>
 
 #include <rte_eth_ring.h>
+#include <rte_ring.h>
 #include <rte_eth_vhost.h>
 #include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_branch_prediction.h>
 
 #include "cmd_utils.h"
+#include "telemetry.h"
+#include "latency_stats.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/return_codes.h"
 
@@ -522,11 +527,13 @@ int
 sppwk_check_used_port(
 		enum port_type iface_type,
 		int iface_no,
+		uint16_t queue_id,
 		enum sppwk_port_dir dir)
 {
 	int cnt, port_cnt, max = 0;
 	struct sppwk_comp_info *component = NULL;
 	struct sppwk_port_info **port_array = NULL;
+	uint16_t *queue_array = NULL;
 	struct sppwk_port_info *port = get_sppwk_port(iface_type, iface_no);
 	struct sppwk_comp_info *component_info =
 					g_mng_data.p_component_info;
@@ -542,12 +549,15 @@ sppwk_check_used_port(
 		if (dir == SPPWK_PORT_DIR_RX) {
 			max = component->nof_rx;
 			port_array = component->rx_ports;
+			queue_array = component->rx_queues;
 		} else if (dir == SPPWK_PORT_DIR_TX) {
 			max = component->nof_tx;
 			port_array = component->tx_ports;
+			queue_array = component->tx_queues;
 		}
 		for (port_cnt = 0; port_cnt < max; port_cnt++) {
-			if (unlikely(port_array[port_cnt] == port))
+			if (unlikely(port_array[port_cnt] == port) &&
+					queue_array[port_cnt] == queue_id)
 				return cnt;
 		}
 	}
@@ -555,25 +565,324 @@ sppwk_check_used_port(
 	return SPPWK_RET_NG;
 }
 
-/* Set component update flag for given port */
+/* Return 1 as true if given component uses port in given direction. */
+static int
+is_port_of_comp(const struct sppwk_comp_info *component,
+		const struct sppwk_port_info *port,
+		enum sppwk_port_dir dir)
+{
+	int cnt;
+
+	if (dir == SPPWK_PORT_DIR_RX) {
+		for (cnt = 0; cnt < component->nof_rx; cnt++) {
+			if (component->rx_ports[cnt] == port)
+				return 1;
+		}
+	} else if (dir == SPPWK_PORT_DIR_TX) {
+		for (cnt = 0; cnt < component->nof_tx; cnt++) {
+			if (component->tx_ports[cnt] == port)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Set component update flag for given port. All of components using the
+ * port are updated because each of them can be bound to its own queue.
+ */
 void
 set_component_change_port(struct sppwk_port_info *port,
 		enum sppwk_port_dir dir)
 {
-	int ret = 0;
-	if ((dir == SPPWK_PORT_DIR_RX) || (dir == SPPWK_PORT_DIR_BOTH)) {
-		ret = sppwk_check_used_port(port->iface_type, port->iface_no,
-				SPPWK_PORT_DIR_RX);
-		if (ret >= 0)
-			*(g_mng_data.p_change_component + ret) = 1;
+	int cnt;
+	struct sppwk_comp_info *component = NULL;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		component = (g_mng_data.p_component_info + cnt);
+		if (component->wk_type == SPPWK_TYPE_NONE)
+			continue;
+
+		if (((dir == SPPWK_PORT_DIR_RX) ||
+				(dir == SPPWK_PORT_DIR_BOTH)) &&
+				is_port_of_comp(component, port,
+					SPPWK_PORT_DIR_RX))
+			*(g_mng_data.p_change_component + cnt) = 1;
+
+		if (((dir == SPPWK_PORT_DIR_TX) ||
+				(dir == SPPWK_PORT_DIR_BOTH)) &&
+				is_port_of_comp(component, port,
+					SPPWK_PORT_DIR_TX))
+			*(g_mng_data.p_change_component + cnt) = 1;
 	}
+}
 
-	if ((dir == SPPWK_PORT_DIR_TX) || (dir == SPPWK_PORT_DIR_BOTH)) {
-		ret = sppwk_check_used_port(port->iface_type, port->iface_no,
-				SPPWK_PORT_DIR_TX);
-		if (ret >= 0)
-			*(g_mng_data.p_change_component + ret) = 1;
+/**
+ * Get num of queues of given port in given direction. Vhost port which is
+ * not created yet has queues configured with `--vhost-queues` option.
+ */
+int
+sppwk_get_nof_queues(const struct sppwk_port_info *port,
+		enum sppwk_port_dir dir)
+{
+	struct rte_eth_dev_info dev_info;
+
+	if (port->ethdev_port_id < 0) {
+		if (port->iface_type == VHOST)
+			return get_vhost_nof_queues();
+		return 1;
 	}
+
+	rte_eth_dev_info_get(port->ethdev_port_id, &dev_info);
+	if (dir == SPPWK_PORT_DIR_RX)
+		return dev_info.nb_rx_queues;
+	return dev_info.nb_tx_queues;
+}
+
+/* Pair of TX queue bound to a component and lcore of the component. */
+struct tx_queue_user {
+	uint16_t queue_id;
+	unsigned int lcore_id;
+};
+
+/* User transmitting to TX queue directly, kept over updates of components. */
+struct tx_queue_holder {
+	int valid;
+	struct tx_queue_user user;
+};
+
+static struct tx_queue_holder
+		g_tx_queue_holders[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+
+/* Compare TX queue users in order of queue and lcore for qsort(). */
+static int
+cmp_tx_queue_user(const void *a, const void *b)
+{
+	const struct tx_queue_user *user_a = a;
+	const struct tx_queue_user *user_b = b;
+
+	if (user_a->queue_id != user_b->queue_id)
+		return (int)user_a->queue_id - (int)user_b->queue_id;
+	return (int)user_a->lcore_id - (int)user_b->lcore_id;
+}
+
+/* Get index of given user in sorted list of users, or -1 if not found. */
+static int
+find_tx_queue_user(const struct tx_queue_user *users, int nof_users,
+		const struct tx_queue_user *user)
+{
+	const struct tx_queue_user *found;
+
+	found = bsearch(user, users, nof_users, sizeof(struct tx_queue_user),
+			cmp_tx_queue_user);
+	if (found == NULL)
+		return -1;
+	return found - users;
+}
+
+/**
+ * Get staging ring of given TX queue, or create it if not exist. It is kept
+ * after the queue is unshared for reusing it.
+ */
+static struct rte_ring *
+get_tx_stage(const struct sppwk_port_info *port, uint16_t queue_id)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_ring *ring;
+
+	snprintf(name, sizeof(name), "sppwk_txs_%d_%d_%u", get_client_id(),
+			port->ethdev_port_id, queue_id);
+	ring = rte_ring_lookup(name);
+	if (ring != NULL)
+		return ring;
+
+	/* Dequeue is also safe while the owner is changing in updating. */
+	ring = rte_ring_create(name, SPPWK_TX_STAGE_SIZE,
+			rte_eth_dev_socket_id(port->ethdev_port_id), 0);
+	if (ring == NULL)
+		RTE_LOG(ERR, WK_CMD_UTILS,
+				"Failed to create staging ring '%s'.\n", name);
+	return ring;
+}
+
+/**
+ * Get TX queue used by lcore of given component for its TX port of given
+ * index. If several lcores are bound to the same queue, lcores other than
+ * its owner are given free queues of the port which no component is bound
+ * to, and remained ones share the queue via staging ring drained by the
+ * owner. The owner of a queue and the lcores given free queues keep them as
+ * long as they transmit to the port, because components of lcores sharing a
+ * queue are updated one by one and a queue must not be transmitted to
+ * directly from two lcores meanwhile.
+ */
+int
+sppwk_get_tx_queue(const struct sppwk_comp_info *comp, int tx_idx,
+		struct sppwk_tx_queue *txq)
+{
+	int cnt, port_cnt, idx;
+	int nof_users = 0;
+	int nof_uniq = 1;
+	int nof_free = 0;
+	int nof_stay = 0;
+	int nof_queues, grp_start, grp_size;
+	int free_idx = 0;
+	const struct sppwk_port_info *port = comp->tx_ports[tx_idx];
+	uint16_t bound_queue = comp->tx_queues[tx_idx];
+	struct sppwk_comp_info *component = NULL;
+	struct tx_queue_holder *holders, *holder;
+	struct tx_queue_user key;
+	static struct tx_queue_user users[RTE_MAX_LCORE];
+	static int given[RTE_MAX_LCORE];
+	static uint8_t used[RTE_MAX_QUEUES_PER_PORT];
+	static uint16_t free_queues[RTE_MAX_QUEUES_PER_PORT];
+
+	txq->queue_id = bound_queue;
+	txq->owner = 1;
+	txq->stage = NULL;
+	if (port->ethdev_port_id < 0)
+		return SPPWK_RET_OK;
+	holders = g_tx_queue_holders[port->ethdev_port_id];
+
+	/* List lcores transmitting to the port and queues bound to them. */
+	memset(used, 0x00, sizeof(used));
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		component = (g_mng_data.p_component_info + cnt);
+		if (component->wk_type == SPPWK_TYPE_NONE)
+			continue;
+
+		for (port_cnt = 0; port_cnt < component->nof_tx; port_cnt++) {
+			if (component->tx_ports[port_cnt] != port)
+				continue;
+			users[nof_users].queue_id =
+				component->tx_queues[port_cnt];
+			users[nof_users].lcore_id = component->lcore_id;
+			used[component->tx_queues[port_cnt]] = 1;
+			nof_users++;
+		}
+	}
+	qsort(users, nof_users, sizeof(struct tx_queue_user),
+			cmp_tx_queue_user);
+
+	/* Components on the same lcore are counted as one user. */
+	for (cnt = 1; cnt < nof_users; cnt++) {
+		if (cmp_tx_queue_user(&users[cnt], &users[nof_uniq - 1]) != 0)
+			users[nof_uniq++] = users[cnt];
+	}
+	if (nof_users > 0)
+		nof_users = nof_uniq;
+
+	/* Keep owner of each bound queue, or take the lowest lcore if left. */
+	for (grp_start = 0; grp_start < nof_users; grp_start += grp_size) {
+		grp_size = 1;
+		while (grp_start + grp_size < nof_users &&
+				users[grp_start + grp_size].queue_id ==
+				users[grp_start].queue_id)
+			grp_size++;
+
+		for (cnt = 0; cnt < grp_size; cnt++)
+			given[grp_start + cnt] = -1;
+
+		holder = &holders[users[grp_start].queue_id];
+		idx = find_tx_queue_user(users, nof_users, &holder->user);
+		if (!holder->valid || idx < grp_start ||
+				idx >= grp_start + grp_size)
+			holder->user = users[grp_start];
+		holder->valid = 1;
+	}
+
+	/* Keep free queues given before if their users are still there. */
+	nof_queues = sppwk_get_nof_queues(port, SPPWK_PORT_DIR_TX);
+	for (cnt = 0; cnt < nof_queues; cnt++) {
+		if (used[cnt])
+			continue;
+
+		idx = -1;
+		if (holders[cnt].valid)
+			idx = find_tx_queue_user(users, nof_users,
+					&holders[cnt].user);
+		if (idx >= 0 && given[idx] < 0 &&
+				cmp_tx_queue_user(&users[idx],
+				&holders[users[idx].queue_id].user) != 0) {
+			given[idx] = cnt;
+			continue;
+		}
+		holders[cnt].valid = 0;
+		free_queues[nof_free++] = cnt;
+	}
+
+	/* Give remained free queues to lcores in order of queue and lcore. */
+	for (cnt = 0; cnt < nof_users && free_idx < nof_free; cnt++) {
+		if (given[cnt] >= 0 || cmp_tx_queue_user(&users[cnt],
+				&holders[users[cnt].queue_id].user) == 0)
+			continue;
+
+		given[cnt] = free_queues[free_idx++];
+		holders[given[cnt]].valid = 1;
+		holders[given[cnt]].user = users[cnt];
+	}
+
+	key.queue_id = bound_queue;
+	key.lcore_id = comp->lcore_id;
+	idx = find_tx_queue_user(users, nof_users, &key);
+	if (idx < 0)
+		return SPPWK_RET_OK;
+	if (given[idx] >= 0) {
+		txq->queue_id = given[idx];
+		return SPPWK_RET_OK;
+	}
+
+	/* Lcores not given free queue share the queue. */
+	for (cnt = 0; cnt < nof_users; cnt++) {
+		if (users[cnt].queue_id == bound_queue && given[cnt] < 0)
+			nof_stay++;
+	}
+	if (nof_stay > 1) {
+		txq->owner = (cmp_tx_queue_user(&key,
+				&holders[bound_queue].user) == 0);
+		txq->stage = get_tx_stage(port, bound_queue);
+		if (txq->stage == NULL)
+			return SPPWK_RET_NG;
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Check if given TX queue is given as a free queue to other lcore which is
+ * still transmitting to the port. Such queue cannot be bound to a component,
+ * because the new binder could take it over and transmit to it before the
+ * lcore is updated to release it.
+ */
+int
+sppwk_is_lent_tx_queue(const struct sppwk_port_info *port,
+		uint16_t queue_id, unsigned int lcore_id)
+{
+	int cnt, port_cnt;
+	const struct tx_queue_holder *holder;
+	const struct sppwk_comp_info *component;
+
+	if (port->ethdev_port_id < 0 || queue_id >= RTE_MAX_QUEUES_PER_PORT)
+		return 0;
+
+	holder = &g_tx_queue_holders[port->ethdev_port_id][queue_id];
+	if (!holder->valid || holder->user.queue_id == queue_id ||
+			holder->user.lcore_id == lcore_id)
+		return 0;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		component = (g_mng_data.p_component_info + cnt);
+		if (component->wk_type == SPPWK_TYPE_NONE ||
+				component->lcore_id != holder->user.lcore_id)
+			continue;
+
+		for (port_cnt = 0; port_cnt < component->nof_tx; port_cnt++) {
+			if (component->tx_ports[port_cnt] == port &&
+					component->tx_queues[port_cnt] ==
+					holder->user.queue_id)
+				return 1;
+		}
+	}
+	return 0;
 }
 
 /* Get ID of unused lcore. */
@@ -624,10 +933,11 @@ get_idx_port_info(struct sppwk_port_info *p_info, int nof_ports,
 	return ret;
 }
 
-/* Delete given port info from the port info array. */
+/* Delete given port info and its queue from the port info array. */
 int
 delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
-		struct sppwk_port_info *p_info_ary[])
+		struct sppwk_port_info *p_info_ary[],
+		uint16_t queue_ary[])
 {
 	int target_idx;  /* The index of deleted port */
 	int cnt;
@@ -642,9 +952,54 @@ delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
 	 * remained ports.
 	 */
 	nof_ports--;
-	for (cnt = target_idx; cnt < nof_ports; cnt++)
+	for (cnt = target_idx; cnt < nof_ports; cnt++) {
 		p_info_ary[cnt] = p_info_ary[cnt+1];
+		queue_ary[cnt] = queue_ary[cnt+1];
+	}
 	p_info_ary[cnt] = NULL;  /* Remove old last port. */
+	queue_ary[cnt] = 0;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Set VLAN operation of given attributes to the port. Params are updated if
+ * the same operation is already set in the direction, or it is chained after
+ * other ones to be applied in the order of added.
+ */
+int
+sppwk_set_port_attrs(struct sppwk_port_info *p_info,
+		const struct sppwk_port_attrs *port_attrs)
+{
+	int cnt;
+	int nof_attrs = 0;
+	struct sppwk_port_attrs *attrs = p_info->port_attrs;
+
+	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
+		if (attrs[cnt].ops == port_attrs->ops &&
+				attrs[cnt].dir == port_attrs->dir) {
+			memcpy(&attrs[cnt], port_attrs,
+					sizeof(struct sppwk_port_attrs));
+			return SPPWK_RET_OK;
+		}
+	}
+
+	/* Pack attributes left by deleted ones to keep the order. */
+	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
+		if (attrs[cnt].ops == SPPWK_PORT_OPS_NONE)
+			continue;
+		if (cnt != nof_attrs)
+			memcpy(&attrs[nof_attrs], &attrs[cnt],
+					sizeof(struct sppwk_port_attrs));
+		nof_attrs++;
+	}
+	memset(&attrs[nof_attrs], 0x00, sizeof(struct sppwk_port_attrs) *
+			(PORT_CAPABL_MAX - nof_attrs));
+
+	if (nof_attrs >= PORT_CAPABL_MAX) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "No space of port ability.\n");
+		return SPPWK_RET_NG;
+	}
+	memcpy(&attrs[nof_attrs], port_attrs, sizeof(struct sppwk_port_attrs));
 	return SPPWK_RET_OK;
 }
 
@@ -836,3 +1191,352 @@ void sppwk_get_mng_data(
 		*backup_info_p = g_mng_data.p_backup_info;
 
 }
+
+/* Names of protocols which can be used in flow rules. */
+static const struct {
+	const char *name;
+	uint8_t proto;
+} flow_proto_names[] = {
+	{ "icmp", IPPROTO_ICMP },
+	{ "tcp", IPPROTO_TCP },
+	{ "udp", IPPROTO_UDP },
+	{ "icmpv6", IPPROTO_ICMPV6 },
+	{ "sctp", IPPROTO_SCTP },
+	{ NULL, 0 },  /* termination */
+};
+
+/* Parse protocol of flow rule given as a name or a number. */
+static int
+parse_flow_proto(const char *str, uint8_t *proto)
+{
+	int i;
+	unsigned long val;
+	char *endptr = NULL;
+
+	if (strcmp(str, "any") == 0) {
+		*proto = 0;
+		return SPPWK_RET_OK;
+	}
+
+	for (i = 0; flow_proto_names[i].name != NULL; i++) {
+		if (strcmp(str, flow_proto_names[i].name) == 0) {
+			*proto = flow_proto_names[i].proto;
+			return SPPWK_RET_OK;
+		}
+	}
+
+	val = strtoul(str, &endptr, 10);
+	if (unlikely(endptr == str || *endptr != '\0' ||
+			val == 0 || val > UINT8_MAX))
+		return SPPWK_RET_NG;
+	*proto = (uint8_t)val;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse address of flow rule with optional prefix length. Return IP version
+ * of the address, 0 for `any`, or SPPWK_RET_NG if failed.
+ */
+static int
+parse_flow_addr(char *str, uint8_t *addr, uint8_t *len)
+{
+	int i, ip_ver, max_len;
+	unsigned long val;
+	char *endptr = NULL;
+	char *slash;
+
+	memset(addr, 0, 16);
+	if (strcmp(str, "any") == 0) {
+		*len = 0;
+		return 0;
+	}
+
+	slash = strchr(str, '/');
+	if (slash != NULL)
+		*slash = '\0';
+
+	if (inet_pton(AF_INET, str, addr) == 1) {
+		ip_ver = 4;
+		max_len = 32;
+	} else if (inet_pton(AF_INET6, str, addr) == 1) {
+		ip_ver = 6;
+		max_len = 128;
+	} else
+		return SPPWK_RET_NG;
+
+	val = max_len;
+	if (slash != NULL) {
+		val = strtoul(slash + 1, &endptr, 10);
+		if (unlikely(endptr == slash + 1 || *endptr != '\0' ||
+				val > (unsigned long)max_len))
+			return SPPWK_RET_NG;
+	}
+	*len = (uint8_t)val;
+
+	/* Clear bits out of the prefix to compare rules simply. */
+	for (i = 0; i < max_len / 8; i++) {
+		if (i * 8 >= *len)
+			addr[i] = 0;
+		else if (i * 8 + 8 > *len)
+			addr[i] &= (uint8_t)(0xff << (8 - (*len - i * 8)));
+	}
+	return ip_ver;
+}
+
+/* Parse port or range of ports of flow rule. */
+static int
+parse_flow_port(const char *str, uint16_t *min, uint16_t *max)
+{
+	unsigned long lo, hi;
+	char *endptr = NULL;
+
+	if (strcmp(str, "any") == 0) {
+		*min = 0;
+		*max = UINT16_MAX;
+		return SPPWK_RET_OK;
+	}
+
+	lo = strtoul(str, &endptr, 10);
+	if (unlikely(endptr == str || lo > UINT16_MAX))
+		return SPPWK_RET_NG;
+	hi = lo;
+	if (*endptr == '-') {
+		str = endptr + 1;
+		hi = strtoul(str, &endptr, 10);
+		if (unlikely(endptr == str || hi > UINT16_MAX || hi < lo))
+			return SPPWK_RET_NG;
+	}
+	if (unlikely(*endptr != '\0'))
+		return SPPWK_RET_NG;
+
+	*min = (uint16_t)lo;
+	*max = (uint16_t)hi;
+	return SPPWK_RET_OK;
+}
+
+/* Parse a flow rule separated with comma. */
+static int
+parse_flow_rule(char *str, struct sppwk_flow_rule *rule)
+{
+	int i, src_ver, dst_ver;
+	char *saveptr = NULL;
+	char *toks[5];
+
+	for (i = 0; i < 5; i++) {
+		toks[i] = strtok_r(i == 0 ? str : NULL, ",", &saveptr);
+		if (unlikely(toks[i] == NULL))
+			return SPPWK_RET_NG;
+	}
+	if (unlikely(strtok_r(NULL, ",", &saveptr) != NULL))
+		return SPPWK_RET_NG;
+
+	memset(rule, 0, sizeof(*rule));
+	if (unlikely(parse_flow_proto(toks[0], &rule->proto) != 0))
+		return SPPWK_RET_NG;
+
+	src_ver = parse_flow_addr(toks[1], rule->src_addr, &rule->src_len);
+	dst_ver = parse_flow_addr(toks[2], rule->dst_addr, &rule->dst_len);
+	if (unlikely(src_ver < 0 || dst_ver < 0))
+		return SPPWK_RET_NG;
+	if (unlikely(src_ver != 0 && dst_ver != 0 && src_ver != dst_ver))
+		return SPPWK_RET_NG;
+	rule->ip_ver = src_ver != 0 ? src_ver : dst_ver;
+
+	if (unlikely(parse_flow_port(toks[3], &rule->sport_min,
+			&rule->sport_max) != 0 ||
+			parse_flow_port(toks[4], &rule->dport_min,
+			&rule->dport_max) != 0))
+		return SPPWK_RET_NG;
+
+	/* Ports are referred only for protocols which have them. */
+	if ((rule->sport_min != 0 || rule->sport_max != UINT16_MAX ||
+			rule->dport_min != 0 ||
+			rule->dport_max != UINT16_MAX) &&
+			rule->proto != IPPROTO_TCP &&
+			rule->proto != IPPROTO_UDP &&
+			rule->proto != IPPROTO_SCTP)
+		return SPPWK_RET_NG;
+
+	return SPPWK_RET_OK;
+}
+
+/* Parse flow rules joined with `+`. */
+int
+sppwk_parse_flow_rules(const char *str, struct sppwk_flow_rule *rules,
+		int max)
+{
+	int nof_rules = 0;
+	char tmp_str[SPPWK_FLOW_RULES_BUFSZ];
+	char *saveptr = NULL;
+	char *tok;
+
+	if (unlikely(strlen(str) >= SPPWK_FLOW_RULES_BUFSZ))
+		return SPPWK_RET_NG;
+	strcpy(tmp_str, str);
+
+	for (tok = strtok_r(tmp_str, "+", &saveptr); tok != NULL;
+			tok = strtok_r(NULL, "+", &saveptr)) {
+		if (unlikely(nof_rules >= max ||
+				parse_flow_rule(tok, &rules[nof_rules]) != 0)) {
+			RTE_LOG(ERR, WK_CMD_UTILS, "Invalid flow rule "
+					"at %d in `%s`.\n", nof_rules, str);
+			return SPPWK_RET_NG;
+		}
+		nof_rules++;
+	}
+
+	if (unlikely(nof_rules == 0))
+		return SPPWK_RET_NG;
+	return nof_rules;
+}
+
+/* Make string of flow address with prefix length. */
+static void
+flow_addr_str(char *buf, size_t sz, int ip_ver, const uint8_t *addr,
+		uint8_t len)
+{
+	char addr_str[INET6_ADDRSTRLEN];
+
+	if (ip_ver == 0 || len == 0) {
+		snprintf(buf, sz, "any");
+		return;
+	}
+
+	inet_ntop(ip_ver == 4 ? AF_INET : AF_INET6, addr, addr_str,
+			sizeof(addr_str));
+	snprintf(buf, sz, "%s/%u", addr_str, len);
+}
+
+/* Make string of port or range of ports. */
+static void
+flow_port_str(char *buf, size_t sz, uint16_t min, uint16_t max)
+{
+	if (min == 0 && max == UINT16_MAX)
+		snprintf(buf, sz, "any");
+	else if (min == max)
+		snprintf(buf, sz, "%u", min);
+	else
+		snprintf(buf, sz, "%u-%u", min, max);
+}
+
+/* Make string of flow rule in the same format as parsed. */
+void
+sppwk_flow_rule_str(char *buf, const struct sppwk_flow_rule *rule)
+{
+	int i;
+	char proto[STR_LEN_SHORT] = "any";
+	char src[INET6_ADDRSTRLEN + 4], dst[INET6_ADDRSTRLEN + 4];
+	char sport[STR_LEN_SHORT], dport[STR_LEN_SHORT];
+
+	if (rule->proto != 0) {
+		snprintf(proto, sizeof(proto), "%u", rule->proto);
+		for (i = 0; flow_proto_names[i].name != NULL; i++) {
+			if (flow_proto_names[i].proto == rule->proto) {
+				snprintf(proto, sizeof(proto), "%s",
+						flow_proto_names[i].name);
+				break;
+			}
+		}
+	}
+	flow_addr_str(src, sizeof(src), rule->ip_ver, rule->src_addr,
+			rule->src_len);
+	flow_addr_str(dst, sizeof(dst), rule->ip_ver, rule->dst_addr,
+			rule->dst_len);
+	flow_port_str(sport, sizeof(sport), rule->sport_min, rule->sport_max);
+	flow_port_str(dport, sizeof(dport), rule->dport_min, rule->dport_max);
+
+	snprintf(buf, SPPWK_FLOW_RULE_STR_SZ, "%s,%s,%s,%s,%s",
+			proto, src, dst, sport, dport);
+}
+
+/* Get name of type of component shown in telemetry. */
+static const char *
+comp_type_str(enum sppwk_worker_type wk_type)
+{
+	switch (wk_type) {
+	case SPPWK_TYPE_CLS:
+		return SPPWK_TYPE_CLS_STR;
+	case SPPWK_TYPE_MRG:
+		return SPPWK_TYPE_MRG_STR;
+	case SPPWK_TYPE_FWD:
+		return SPPWK_TYPE_FWD_STR;
+	case SPPWK_TYPE_MIR:
+		return SPPWK_TYPE_MIR_STR;
+	case SPPWK_TYPE_LB:
+		return SPPWK_TYPE_LB_STR;
+	default:
+		return SPPWK_TYPE_NONE_STR;
+	}
+}
+
+/* Add ports and components of spp_vf or spp_mirror to telemetry. */
+void
+sppwk_fill_telemetry(struct sppwk_telemetry *tm)
+{
+	int i, j;
+	const enum port_type types[] = { PHY, VHOST, RING };
+	const struct sppwk_port_info *port;
+	const struct sppwk_comp_info *comp;
+
+	for (i = 0; i < (int)RTE_DIM(types); i++) {
+		for (j = 0; j < RTE_MAX_ETHPORTS; j++) {
+			port = get_sppwk_port(types[i], j);
+			if (port->ethdev_port_id < 0)
+				continue;
+			sppwk_telemetry_add_port(tm, types[i], j,
+					port->ethdev_port_id);
+		}
+	}
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		comp = g_mng_data.p_component_info + i;
+		if (comp->wk_type == SPPWK_TYPE_NONE)
+			continue;
+		sppwk_telemetry_add_comp(tm, comp->name,
+				comp_type_str(comp->wk_type), comp->lcore_id,
+				&g_sppwk_comp_cycles[i]);
+	}
+}
+
+/* Turn on or off latency probe of given port if it is a ring. */
+static int
+set_port_lat_probe(const struct sppwk_port_info *port, int on)
+{
+	if (port->iface_type != RING)
+		return SPPWK_RET_OK;
+	return sppwk_set_ring_latency_probe(port->iface_no,
+			port->ethdev_port_id, on);
+}
+
+/* Turn on or off latency probe of a ring or ring ports of a component. */
+int
+sppwk_update_lat_probe(int on, const struct sppwk_port_idx *port,
+		const char *name)
+{
+	int i, comp_id;
+	const struct sppwk_comp_info *comp;
+
+	if (port->iface_type != UNDEF)
+		return set_port_lat_probe(
+				get_sppwk_port(port->iface_type,
+					port->iface_no), on);
+
+	comp_id = sppwk_get_lcore_id(name);
+	if (unlikely(comp_id < 0)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Unknown component by "
+				"latency_probe command. (component = %s)\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	comp = g_mng_data.p_component_info + comp_id;
+	for (i = 0; i < comp->nof_rx; i++) {
+		if (set_port_lat_probe(comp->rx_ports[i], on) != SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+	}
+	for (i = 0; i < comp->nof_tx; i++) {
+		if (set_port_lat_probe(comp->tx_ports[i], on) != SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
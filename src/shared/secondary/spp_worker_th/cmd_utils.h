@@ -24,12 +24,16 @@
 #define SPPWK_TYPE_MRG_STR "merge"
 #define SPPWK_TYPE_FWD_STR "forward"
 #define SPPWK_TYPE_MIR_STR "mirror"
+#define SPPWK_TYPE_LB_STR "load_balancer"
 #define SPPWK_TYPE_PCAP_STR "pcap"
 #define SPPWK_TYPE_NONE_STR "unuse"
 
 /** Waiting time for checking update (not used for spp_pcap). */
 #define SPPWK_UPDATE_INTERVAL 10  /* micro sec */
 
+/* Num of entries of staging ring of TX queue shared by lcores. */
+#define SPPWK_TX_STAGE_SIZE 1024
+
 /**
  * Used for index of arrary of management data which has two sides. It is not
  * used for spp_pcap.
@@ -39,6 +43,12 @@
 /** Maximum VLAN PCP, used only for spp_vf. */
 #define SPP_VLAN_PCP_MAX 7
 
+/** Mask of PCP in TCI of VLAN tag, used for spp_vf and spp_mirror. */
+#define SPP_VLAN_PCP_MASK 0xe000
+
+/** TPID of outer tag of QinQ used before IEEE 802.1ad. */
+#define SPP_ETHER_TYPE_QINQ_OLD 0x9100
+
 /* Max number of core status check */
 #define SPP_CORE_STATUS_CHECK_MAX 5
 
@@ -63,14 +73,78 @@
 #define CORE_TYPE_MERGE_STR	     "merge"
 #define CORE_TYPE_FORWARD_STR	     "forward"
 #define CORE_TYPE_MIRROR_STR	     "mirror"
+#define CORE_TYPE_LOAD_BALANCER_STR  "load_balancer"
 
 /* Classifier Type */
 enum sppwk_cls_type {
 	SPPWK_CLS_TYPE_NONE,
 	SPPWK_CLS_TYPE_MAC,
-	SPPWK_CLS_TYPE_VLAN
+	SPPWK_CLS_TYPE_VLAN,
+	SPPWK_CLS_TYPE_FLOW
+};
+
+/** Max num of flow rules given at once in `classifier_table` command. */
+#define SPPWK_MAX_FLOW_RULES 16
+
+/** Size of string buffer of flow rules including null char. */
+#define SPPWK_FLOW_RULES_BUFSZ 512
+
+/** Size of string buffer of a flow rule including null char. */
+#define SPPWK_FLOW_RULE_STR_SZ 256
+
+/**
+ * Rule of flow classification with 5-tuple of IPv4 or IPv6. Addresses are
+ * in network byte order and bits out of the prefix are cleared.
+ */
+struct sppwk_flow_rule {
+	int ip_ver;  /**< 4 or 6, or 0 for both if no address is given. */
+	uint8_t proto;  /**< Protocol number, or 0 for any. */
+	uint8_t src_len;  /**< Prefix length of source address. */
+	uint8_t dst_len;  /**< Prefix length of destination address. */
+	uint8_t src_addr[16];  /**< Source address. */
+	uint8_t dst_addr[16];  /**< Destination address. */
+	uint16_t sport_min;  /**< Min source port. */
+	uint16_t sport_max;  /**< Max source port. */
+	uint16_t dport_min;  /**< Min destination port. */
+	uint16_t dport_max;  /**< Max destination port. */
+};
+
+/* Hash function of load balancer. */
+enum sppwk_lb_hash_type {
+	SPPWK_LB_HASH_NONE,
+	SPPWK_LB_HASH_TOEPLITZ,
+	SPPWK_LB_HASH_CRC
+};
+
+/** Max weight of TX port of load balancer. */
+#define SPPWK_LB_WEIGHT_MAX 100
+
+/** Num of entries of indirection table of load balancer, power of 2. */
+#define SPPWK_LB_RETA_SIZE 128
+
+/* Copy mode of mirror. */
+enum sppwk_mir_copy_mode {
+	SPPWK_MIR_COPY_SHALLOW,  /**< Indirect mbuf attached to original. */
+	SPPWK_MIR_COPY_DEEP,  /**< Copy of all of segments. */
+	SPPWK_MIR_COPY_HEADER,  /**< Copy of header and indirect payload. */
 };
 
+/* Policy of mirror for packets which are not accepted by TX port. */
+enum sppwk_mir_policy {
+	SPPWK_MIR_POLICY_DROP_MIRROR,  /**< Drop copies, and originals. */
+	SPPWK_MIR_POLICY_KEEP_ORIGINAL,  /**< Retry originals, drop copies. */
+	SPPWK_MIR_POLICY_BLOCK,  /**< Retry both of originals and copies. */
+};
+
+/** Max interval of 1-in-N sampling of mirror. */
+#define SPPWK_MIR_SAMPLE_MAX 1000000
+
+/** Max rate of copies of mirror in packets per second. */
+#define SPPWK_MIR_RATE_MAX 100000000
+
+/** Max length of copies of mirror truncated to. */
+#define SPPWK_MIR_SNAPLEN_MAX 65535
+
 /* Flag of processing type to copy management information */
 /* TODO(yasufum) add comments for each of members. */
 enum copy_mng_flg {
@@ -217,10 +291,11 @@ struct core_info *get_core_info(unsigned int lcore_id);
 int sppwk_is_lcore_updated(unsigned int lcore_id);
 
 /**
- * Check if component is using port.
+ * Check if component is using queue of port.
  *
  * @param iface_type Interface type to be validated.
  * @param iface_no Interface number to be validated.
+ * @param queue_id Queue ID to be validated.
  * @param rxtx Value of spp_port_rxtx to be validated.
  * @retval 0~127      If match component ID
  * @retval SPPWK_RET_NG If failed.
@@ -228,10 +303,11 @@ int sppwk_is_lcore_updated(unsigned int lcore_id);
 int sppwk_check_used_port(
 		enum port_type iface_type,
 		int iface_no,
+		uint16_t queue_id,
 		enum sppwk_port_dir dir);
 
 /**
- * Set component update flag for given port.
+ * Set component update flag for all of components using given port.
  *
  * @param port Pointer of sppwk_port_info.
  * @param rxtx Enum spp_port_rxtx.
@@ -240,6 +316,43 @@ void
 set_component_change_port(struct sppwk_port_info *port,
 		enum sppwk_port_dir dir);
 
+/**
+ * Get num of queues of given port.
+ *
+ * @param port Pointer of sppwk_port_info.
+ * @param dir RX or TX.
+ * @return Num of queues.
+ */
+int sppwk_get_nof_queues(const struct sppwk_port_info *port,
+		enum sppwk_port_dir dir);
+
+/**
+ * Get TX queue used by lcore of given component for its TX port. Several
+ * lcores bound to the same queue are given free queues of the port, or
+ * share the queue via staging ring if no free queue remains.
+ *
+ * @param[in] comp Pointer to sppwk_comp_info.
+ * @param[in] tx_idx Index of TX port of the component.
+ * @param[out] txq TX queue used by the lcore.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int sppwk_get_tx_queue(const struct sppwk_comp_info *comp, int tx_idx,
+		struct sppwk_tx_queue *txq);
+
+/**
+ * Check if TX queue of port is given as a free queue to other lcore, and
+ * cannot be bound to a component on lcore of given ID.
+ *
+ * @param[in] port Pointer to sppwk_port_info.
+ * @param[in] queue_id TX queue to be bound.
+ * @param[in] lcore_id Lcore of component to which the queue is bound.
+ * @retval 1 if the queue is given to other lcore.
+ * @retval 0 if not.
+ */
+int sppwk_is_lent_tx_queue(const struct sppwk_port_info *port,
+		uint16_t queue_id, unsigned int lcore_id);
+
 /**
  * Get ID of unused lcore.
  *
@@ -270,17 +383,31 @@ int get_idx_port_info(struct sppwk_port_info *p_info, int nof_ports,
 		struct sppwk_port_info *p_info_ary[]);
 
 /**
- *  search matched port_info from array and delete it.
+ *  search matched port_info from array and delete it with its queue.
  *
  * @param[in] p_info Target port to be deleted.
  * @param[in] nof_ports Number of ports of given p_info_ary.
  * @param[in] array[] Array of p_info.
+ * @param[in] queue_ary[] Array of queues of p_info_ary.
  *
  * @retval 0  succeeded.
  * @retval -1 failed.
  */
 int delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
-		struct sppwk_port_info *p_info_ary[]);
+		struct sppwk_port_info *p_info_ary[],
+		uint16_t queue_ary[]);
+
+/**
+ * Set VLAN operation to the port. It updates params of the same operation
+ * in the same direction, or is chained after other operations.
+ *
+ * @param[in,out] p_info Target port.
+ * @param[in] port_attrs Attributes of VLAN operation.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If no space for the operation.
+ */
+int sppwk_set_port_attrs(struct sppwk_port_info *p_info,
+		const struct sppwk_port_attrs *port_attrs);
 
 /**
  * Activate temporarily stored port info while flushing.
@@ -313,6 +440,28 @@ sppwk_port_uid(char *port_uid, enum port_type iface_type, int iface_no);
  */
 int64_t sppwk_convert_mac_str_to_int64(const char *macaddr);
 
+/**
+ * Parse flow rules joined with `+`. Each of rules consists of protocol,
+ * source, destination, source port and destination port separated with
+ * comma, such as `tcp,10.0.0.0/8,192.168.1.10,any,80`. Ports can be a
+ * range such as `1024-65535`, and `any` is for any of values.
+ *
+ * @param[in] str String of flow rules.
+ * @param[out] rules Parsed rules.
+ * @param[in] max Max num of rules.
+ * @return Num of parsed rules, or SPPWK_RET_NG if failed.
+ */
+int sppwk_parse_flow_rules(const char *str, struct sppwk_flow_rule *rules,
+		int max);
+
+/**
+ * Make string of flow rule in the same format as parsed.
+ *
+ * @param[out] buf Buffer of SPPWK_FLOW_RULE_STR_SZ bytes.
+ * @param[in] rule Flow rule.
+ */
+void sppwk_flow_rule_str(char *buf, const struct sppwk_flow_rule *rule);
+
 /**
  * Set mange data address.
  *
@@ -349,4 +498,26 @@ void sppwk_get_mng_data(struct iface_info **iface_p,
 		int **change_component_p,
 		struct cancel_backup_info **backup_info_p);
 
+/**
+ * Turn on or off latency probe of a ring port, or all of ring ports of a
+ * component if `port` is UNDEF.
+ *
+ * @param[in] on 1 for turning on, or 0 for off.
+ * @param[in] port Ring port, or UNDEF if `name` is given.
+ * @param[in] name Name of component.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_update_lat_probe(int on, const struct sppwk_port_idx *port,
+		const char *name);
+
+struct sppwk_telemetry;
+/**
+ * Add ports and components of spp_vf or spp_mirror to telemetry. It is
+ * given to sppwk_telemetry_update() as `fill`.
+ *
+ * @param[in,out] tm Telemetry to be updated.
+ */
+void sppwk_fill_telemetry(struct sppwk_telemetry *tm);
+
 #endif /* __SPPWK_CMD_UTILS_H__ */
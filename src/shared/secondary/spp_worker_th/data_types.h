@@ -37,12 +37,15 @@ enum sppwk_port_dir {
 
 /**
  * Port ability operation which indicates vlan tag operation on the port
- * (e.g. add vlan tag or delete vlan tag)
+ * (e.g. add vlan tag or delete vlan tag). Several operations of a port are
+ * applied in the order of added.
  */
 enum sppwk_port_ops {
 	SPPWK_PORT_OPS_NONE,
 	SPPWK_PORT_OPS_ADD_VLAN,  /* Add vlan tag. */
-	SPPWK_PORT_OPS_DEL_VLAN,  /* Delete vlan tag. */
+	SPPWK_PORT_OPS_DEL_VLAN,  /* Delete outermost vlan tag. */
+	SPPWK_PORT_OPS_ADD_STAG,  /* Push outer vlan tag for QinQ. */
+	SPPWK_PORT_OPS_SET_PCP,  /* Remark PCP of outermost vlan tag. */
 };
 
 /** VLAN tag information */
@@ -50,6 +53,7 @@ struct sppwk_vlan_tag {
 	int vid; /**< VLAN ID */
 	int pcp; /**< Priority Code Point */
 	int tci; /**< Tag Control Information */
+	int tpid; /**< Tag Protocol Identifier */
 };
 
 /* Ability for vlantag for a port. */
@@ -73,6 +77,7 @@ enum sppwk_worker_type {
 	SPPWK_TYPE_MRG,  /**< Merger */
 	SPPWK_TYPE_FWD,  /**< Forwarder */
 	SPPWK_TYPE_MIR,  /**< Mirror */
+	SPPWK_TYPE_LB,  /**< Load balancer */
 };
 
 /* Attributes for classifying. */
@@ -89,6 +94,19 @@ struct sppwk_cls_attrs {
 struct sppwk_port_idx {
 	enum port_type iface_type;  /**< phy, vhost or ring. */
 	int iface_no;
+	uint16_t queue_id;  /**< RX or TX queue bound to component. */
+};
+
+/**
+ * TX queue of a port used by a lcore. If the queue bound to the component is
+ * shared with other lcores and the port has no free queue for the lcore,
+ * packets are enqueued to `stage` ring and the `owner` lcore of the queue
+ * transmits them, because TX of most of PMDs is not thread-safe.
+ */
+struct sppwk_tx_queue {
+	uint16_t queue_id;  /**< TX queue used by the lcore. */
+	int owner;  /**< 1 if the lcore transmits packets in `stage`. */
+	struct rte_ring *stage;  /**< MPSC staging ring, or NULL if unshared. */
 };
 
 /* Define detailed port params in addition to `sppwk_port_idx`. */
@@ -98,6 +116,7 @@ struct sppwk_port_info {
 	int ethdev_port_id;  /**< Consistent ID of ethdev */
 	struct sppwk_cls_attrs cls_attrs;
 	struct sppwk_port_attrs port_attrs[PORT_CAPABL_MAX];
+	unsigned int flush_thresh;  /**< TX flush threshold, 0 for default */
 };
 
 /* Attributes of SPP worker thread named as `component`. */
@@ -106,10 +125,13 @@ struct sppwk_comp_info {
 	enum sppwk_worker_type wk_type;  /**< Type of worker thread */
 	unsigned int lcore_id;
 	int comp_id;  /**< Component ID */
+	unsigned int cls_tbl_size;  /**< Capacity of classifier table */
 	int nof_rx;  /**< The number of rx ports */
 	int nof_tx;  /**< The number of tx ports */
 	struct sppwk_port_info *rx_ports[RTE_MAX_ETHPORTS]; /**< rx ports */
 	struct sppwk_port_info *tx_ports[RTE_MAX_ETHPORTS]; /**< tx ports */
+	uint16_t rx_queues[RTE_MAX_ETHPORTS];  /**< Queue of each rx port */
+	uint16_t tx_queues[RTE_MAX_ETHPORTS];  /**< Queue of each tx port */
 };
 
 /* Manage number of interfaces  and port information as global variable. */
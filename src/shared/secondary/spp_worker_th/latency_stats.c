@@ -6,7 +6,7 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stddef.h>
-#include <math.h>
+#include <string.h>
 
 #include <rte_mbuf.h>
 #include <rte_log.h>
@@ -15,88 +15,125 @@
 #include <rte_memcpy.h>
 
 #include "latency_stats.h"
+#include "shared/chain_trace.h"
 #include "cmd_utils.h"
 #include "port_capability.h"
 #include "../return_codes.h"
 
-#define NS_PER_SEC 1E9
+#define NS_PER_SEC 1000000000ULL
 
 #define RTE_LOGTYPE_SPP_RING_LATENCY_STATS RTE_LOGTYPE_USER1
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-
-/** ring latency statistics information */
+/** ring latency statistics information of a ring on a lcore */
 struct ring_latency_stats_info {
 	uint64_t timer_tsc;  /**< sampling interval */
 	uint64_t prev_tsc;   /**< previous time */
-	struct ring_latency_stats_t stats;  /**< list of stats */
-};
+	struct lat_hist stats;  /**< list of stats */
+} __rte_cache_aligned;
+
+/* Probes of all of ports. */
+struct sppwk_lat_probe g_sppwk_lat_probes[RTE_MAX_ETHPORTS];
 
 /** sampling interval */
 static uint64_t g_samp_intvl;
 
-/** ring latency statistics information instance */
-static struct ring_latency_stats_info *g_stats_info;
-
-/** number of ring latency statistics */
-static uint16_t g_stats_count;
+/**
+ * ring latency statistics information of each of rings, which is an array
+ * of instances of lcores indexed with rte_lcore_index() and merged in
+ * sppwk_get_ring_latency_stats(). It is allocated when the probe of the
+ * ring is turned on at first.
+ */
+static struct ring_latency_stats_info *g_stats_info[RTE_MAX_ETHPORTS];
 
-/* clock cycles per nano second */
-static inline uint64_t
-cycles_per_ns(void)
+/* Get stats info of the ring on the caller lcore, or NULL if not counted. */
+static inline struct ring_latency_stats_info *
+get_stats_info(int ring_id)
 {
-	return rte_get_timer_hz() / NS_PER_SEC;
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE || ring_id < 0 ||
+			ring_id >= RTE_MAX_ETHPORTS ||
+			g_stats_info[ring_id] == NULL))
+		return NULL;
+	return &g_stats_info[ring_id][rte_lcore_index(lcore_id)];
 }
 
-/**
- * TODO(Hideyuki Yamashita) This function has a fatal bug in rte_zmalloc()
- * for `g_stats_info` and should be fixed. rte_zmalloc() returns NULL for
- * unknow reason.
- */
-int
-sppwk_init_ring_latency_stats(uint64_t samp_intvl, uint16_t stats_count)
+void
+sppwk_init_ring_latency_stats(uint64_t samp_intvl)
 {
-	/* allocate memory for ring latency statistics information */
-	g_stats_info = rte_zmalloc(
-			"global ring_latency_stats_info",
-			sizeof(struct ring_latency_stats_info) * stats_count,
-			0);
-	if (unlikely(g_stats_info == NULL)) {
-		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Cannot allocate memory "
-				"for ring latency stats info\n");
-		return SPPWK_RET_NG;
-	}
-
 	/* store global information for ring latency statistics */
-	g_samp_intvl = samp_intvl * cycles_per_ns();
-	g_stats_count = stats_count;
+	g_samp_intvl = samp_intvl * rte_get_tsc_hz() / NS_PER_SEC;
+	memset(g_sppwk_lat_probes, 0x00, sizeof(g_sppwk_lat_probes));
 
 	RTE_LOG(DEBUG, SPP_RING_LATENCY_STATS,
-			"g_samp_intvl=%lu, g_stats_count=%hu, "
-			"cpns=%lu, NS_PER_SEC=%f\n",
-			g_samp_intvl, g_stats_count,
-			cycles_per_ns(), NS_PER_SEC);
-
-	return SPPWK_RET_OK;
+			"g_samp_intvl=%lu, hz=%lu, NS_PER_SEC=%llu\n",
+			g_samp_intvl, rte_get_tsc_hz(), NS_PER_SEC);
 }
 
 void
 sppwk_clean_ring_latency_stats(void)
 {
+	int ring_id;
+
 	/* free memory for ring latency statistics information */
-	if (likely(g_stats_info != NULL)) {
-		rte_free(g_stats_info);
-		g_stats_count = 0;
+	memset(g_sppwk_lat_probes, 0x00, sizeof(g_sppwk_lat_probes));
+	for (ring_id = 0; ring_id < RTE_MAX_ETHPORTS; ring_id++) {
+		rte_free(g_stats_info[ring_id]);
+		g_stats_info[ring_id] = NULL;
 	}
 }
 
+/* Turn on or off the probe of latency of a ring port. */
+int
+sppwk_set_ring_latency_probe(int ring_id, int ethdev_port_id, int on)
+{
+	struct sppwk_lat_probe *probe;
+
+	if (unlikely(ring_id < 0 || ring_id >= RTE_MAX_ETHPORTS ||
+			ethdev_port_id < 0 ||
+			ethdev_port_id >= RTE_MAX_ETHPORTS)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS,
+				"Invalid ring %d (port %d) for probe.\n",
+				ring_id, ethdev_port_id);
+		return SPPWK_RET_NG;
+	}
+
+	/* Allocate stats before workers refer it from the probe. */
+	if (on && g_stats_info[ring_id] == NULL) {
+		g_stats_info[ring_id] = rte_zmalloc(
+				"global ring_latency_stats_info",
+				sizeof(struct ring_latency_stats_info) *
+				rte_lcore_count(), RTE_CACHE_LINE_SIZE);
+		if (unlikely(g_stats_info[ring_id] == NULL)) {
+			RTE_LOG(ERR, SPP_RING_LATENCY_STATS,
+					"Cannot allocate memory "
+					"for ring latency stats info\n");
+			return SPPWK_RET_NG;
+		}
+		rte_smp_wmb();
+	}
+
+	probe = &g_sppwk_lat_probes[ethdev_port_id];
+	probe->ring_id = ring_id;
+	rte_smp_wmb();
+	probe->on = on;
+
+	RTE_LOG(INFO, SPP_RING_LATENCY_STATS,
+			"Turn %s latency probe of ring:%d.\n",
+			on ? "on" : "off", ring_id);
+	return SPPWK_RET_OK;
+}
+
 void
 sppwk_add_ring_latency_time(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts)
 {
 	unsigned int i;
 	uint64_t diff_tsc, now;
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
+	struct ring_latency_stats_info *stats_info = get_stats_info(ring_id);
+
+	if (unlikely(stats_info == NULL))
+		return;
 
 	for (i = 0; i < nb_pkts; i++) {
 
@@ -107,15 +144,25 @@ sppwk_add_ring_latency_time(int ring_id,
 		diff_tsc = now - stats_info->prev_tsc;
 		stats_info->timer_tsc += diff_tsc;
 
-		/* set tsc to mbuf timestamp if it is over sampling interval. */
+		/* Stamp of chain trace is kept until it reaches egress. */
+		if (unlikely(chain_trace_stamped(pkts[i]))) {
+			stats_info->prev_tsc = now;
+			continue;
+		}
+
+		/**
+		 * set tsc to mbuf if it is over sampling interval, or clear
+		 * it not to be counted with the value of the previous use.
+		 */
 		if (unlikely(stats_info->timer_tsc >= g_samp_intvl)) {
 			RTE_LOG(DEBUG, SPP_RING_LATENCY_STATS,
 					"Set timestamp. ring_id=%d, "
 					"pkts_index=%u, timestamp=%lu\n",
 					ring_id, i, now);
-			pkts[i]->timestamp = now;
+			pkts[i]->udata64 = now;
 			stats_info->timer_tsc = 0;
-		}
+		} else
+			pkts[i]->udata64 = 0;
 
 		/* update previous tsc */
 		stats_info->prev_tsc = now;
@@ -127,114 +174,54 @@ sppwk_calc_ring_latency(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts)
 {
 	unsigned int i;
-	uint64_t now;
-	int64_t latency;
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
+	uint64_t now, latency;
+	struct ring_latency_stats_info *stats_info = get_stats_info(ring_id);
+
+	if (unlikely(stats_info == NULL))
+		return;
 
 	now = rte_rdtsc();
 	for (i = 0; i < nb_pkts; i++) {
-		if (likely(pkts[i]->timestamp == 0))
+		if (likely(pkts[i]->udata64 == 0) ||
+				chain_trace_stamped(pkts[i]))
 			continue;
 
-		/* calc latency if mbuf `timestamp` is non-zero. */
-		latency = (uint64_t)floor((now - pkts[i]->timestamp) /
-				cycles_per_ns());
-		if (likely(latency < TOTAL_LATENCY_ENT-1))
-			stats_info->stats.distr[latency]++;
-		else
-			stats_info->stats.distr[TOTAL_LATENCY_ENT-1]++;
+		/* calc latency if mbuf `udata64` is non-zero. */
+		latency = now - pkts[i]->udata64;
+		lat_hist_add(&stats_info->stats, latency);
+
+		/* Not to be counted again at the next ring. */
+		pkts[i]->udata64 = 0;
 	}
 }
 
 int
-sppwk_get_ring_latency_stats_count(void)
-{
-	return g_stats_count;
-}
-
-void
 sppwk_get_ring_latency_stats(int ring_id,
-		struct ring_latency_stats_t *stats)
-{
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
-
-	rte_memcpy(stats, &stats_info->stats,
-			sizeof(struct ring_latency_stats_t));
-}
-
-/* Print statistics of time for packet processing in ring interface */
-void
-print_ring_latency_stats(struct iface_info *if_info)
-{
-	/* Clear screen and move cursor to top left */
-	const char topLeft[] = { 27, '[', '1', ';', '1', 'H', '\0' };
-	const char clr[] = { 27, '[', '2', 'J', '\0' };
-	printf("%s%s", clr, topLeft);
-
-	int ring_cnt, stats_cnt;
-	struct ring_latency_stats_t stats[RTE_MAX_ETHPORTS];
-	memset(&stats, 0x00, sizeof(stats));
-
-	printf("RING Latency\n");
-	printf(" RING");
-	for (ring_cnt = 0; ring_cnt < RTE_MAX_ETHPORTS; ring_cnt++) {
-		if (if_info->ring[ring_cnt].iface_type == UNDEF)
-			continue;
-
-		sppwk_get_ring_latency_stats(ring_cnt, &stats[ring_cnt]);
-		printf(", %-18d", ring_cnt);
-	}
-	printf("\n");
-
-	for (stats_cnt = 0; stats_cnt < TOTAL_LATENCY_ENT;
-			stats_cnt++) {
-		printf("%3dns", stats_cnt);
-		for (ring_cnt = 0; ring_cnt < RTE_MAX_ETHPORTS; ring_cnt++) {
-			if (if_info->ring[ring_cnt].iface_type == UNDEF)
-				continue;
-
-			printf(", 0x%-16lx", stats[ring_cnt].distr[stats_cnt]);
-		}
-		printf("\n");
-	}
-}
-
-/* Wrapper function for rte_eth_rx_burst() with calc ring latency. */
-uint16_t
-sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no,
-		uint16_t queue_id  __attribute__ ((unused)),
-		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
+		struct lat_hist *stats)
 {
-	uint16_t nb_rx;
+	unsigned int lcore_idx;
 
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
-
-	/* TODO(yasufum) confirm why it returns SPPWK_RET_OK. */
-	if (unlikely(nb_rx == 0))
-		return SPPWK_RET_OK;
+	memset(stats, 0x00, sizeof(struct lat_hist));
+	if (unlikely(ring_id < 0 || ring_id >= RTE_MAX_ETHPORTS ||
+			g_stats_info[ring_id] == NULL))
+		return SPPWK_RET_NG;
 
-	if (iface_type == RING)
-		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_pkts);
-	return nb_rx;
+	/* Merge stats of lcores. Might be slightly behind of the lcores. */
+	for (lcore_idx = 0; lcore_idx < rte_lcore_count(); lcore_idx++)
+		lat_hist_merge(stats, &g_stats_info[ring_id][lcore_idx].stats);
+	return SPPWK_RET_OK;
 }
 
-/* Wrapper function for rte_eth_tx_burst() with calc ring latency. */
-uint16_t
-sppwk_eth_ring_stats_tx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no,
-		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+/* Check if the probe of latency of a ring is turned on. */
+int
+sppwk_ring_latency_probe_is_on(int ring_id)
 {
-	uint16_t nb_tx;
+	int port_id;
 
-	nb_tx = rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
-
-	if (iface_type == RING)
-		sppwk_add_ring_latency_time(iface_no, tx_pkts, nb_pkts);
-	return nb_tx;
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		if (g_sppwk_lat_probes[port_id].on &&
+				g_sppwk_lat_probes[port_id].ring_id == ring_id)
+			return 1;
+	}
+	return 0;
 }
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
@@ -10,42 +10,51 @@
  * SPP RING latency statistics
  *
  * Util functions for measuring latency of ring-PMD.
+ *
+ * Latency is measured only for ring ports of which probe is turned on with
+ * `latency_probe` command, so that it can be enabled without rebuilding.
+ * Probes are called from sppwk_eth_rx_burst() and sppwk_eth_tx_burst(),
+ * and cost a branch for each of bursts if they are off. A packet enqueued
+ * to a ring is given TSC as timestamp in every sampling interval, and its
+ * latency is counted when it is dequeued. Timestamp is carried in
+ * `udata64` of mbuf because `timestamp` can be set by PMDs. Packets stamped
+ * by chain trace in the same field are not counted nor stamped.
  */
 
 #include <rte_mbuf.h>
+#include "shared/latency_hist.h"
 #include "cmd_utils.h"
 
-/**
- * Statistics of latency of ring is counted with histgram like data structure.
- * To count frequency of each of time in nano sec, this data is implemented as
- * an array in which frequency counts of 1-100[ns] are contained. If the
- * latency is larger than 100[ns], it is added to the last entry. It means
- * this array has 101 entries, 100 entries for 1-100[ns] and 1 entry for over
- * 100[ns].
- */
-#define TOTAL_LATENCY_ENT 101
-
-/** statistics of latency of ring */
-struct ring_latency_stats_t {
-	uint64_t distr[TOTAL_LATENCY_ENT]; /* distribution of time */
+/* Probe of latency of a port, indexed with etherdev ID. */
+struct sppwk_lat_probe {
+	int on;  /* 1 if latency is measured, or 0 if not. */
+	int ring_id;  /* iface_no of the ring port. */
 };
 
+/* Probes of all of ports, written only by the master thread. */
+extern struct sppwk_lat_probe g_sppwk_lat_probes[RTE_MAX_ETHPORTS];
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 /**
  * initialize ring latency statistics.
  *
  * @param samp_intvl
  *  The interval timer(ns) to refer the counter.
- * @param stats_count
- *  The number of ring to be measured.
+ */
+void sppwk_init_ring_latency_stats(uint64_t samp_intvl);
+
+void sppwk_clean_ring_latency_stats(void);
+
+/**
+ * Turn on or off the probe of latency of a ring port. Statistics of the ring
+ * are kept even if it is turned off.
  *
+ * @param ring_id Ring id.
+ * @param ethdev_port_id Etherdev ID of the ring.
+ * @param on 1 for turning on, or 0 for off.
  * @retval SPPWK_RET_OK: succeeded.
  * @retval SPPWK_RET_NG: failed.
  */
-int sppwk_init_ring_latency_stats(uint64_t samp_intvl, uint16_t stats_count);
-
-void sppwk_clean_ring_latency_stats(void);
+int sppwk_set_ring_latency_probe(int ring_id, int ethdev_port_id, int on);
 
 /**
  * add time-stamp to mbuf's member.
@@ -72,96 +81,44 @@ void sppwk_calc_ring_latency(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts);
 
 /**
- * get number of ring latency statistics.
- *
- * @return sppwk_init_ring_latency_stats's parameter "stats_count"
- */
-int sppwk_get_ring_latency_stats_count(void);
-
-/**
- *get specific ring latency statistics.
+ * get specific ring latency statistics merged from all of lcores.
  *
  * @param ring_id
  *  The ring id.
  * @param stats
  *  The statistics values.
+ * @retval SPPWK_RET_OK: succeeded.
+ * @retval SPPWK_RET_NG: the probe of the ring was never turned on.
  */
-void sppwk_get_ring_latency_stats(int ring_id,
-		struct ring_latency_stats_t *stats);
-
-/* Print statistics of time for packet processing in ring interface */
-void print_ring_latency_stats(struct iface_info *if_info);
-
-/**
- * Wrapper function for rte_eth_rx_burst() with ring latency feature.
- *
- * @param[in] port_id Etherdev ID.
- * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
- * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
- * @param nb_pkts Maximum number of RX packets.
- * @return Number of RX packets as number of pointers to mbuf.
- */
-uint16_t sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
-
-/**
- * Wrapper function for rte_eth_tx_burst() with ring latency feature.
- *
- * @param port_id Etherdev ID.
- * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
- * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
- * @param nb_pkts Maximum number of TX packets.
- * @return Number of TX packets as number of pointers to mbuf.
- */
-uint16_t sppwk_eth_ring_stats_tx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
-
-/**
- * Wrapper function for rte_eth_rx_burst() with VLAN and ring latency feature.
- *
- * @param[in] port_id Etherdev ID.
- * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
- * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
- * @param nb_pkts Maximum number of RX packets.
- * @return Number of RX packets as number of pointers to mbuf.
- */
-uint16_t sppwk_eth_vlan_ring_stats_rx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
+int sppwk_get_ring_latency_stats(int ring_id,
+		struct lat_hist *stats);
 
 /**
- * Wrapper function for rte_eth_tx_burst() with VLAN and ring latency feature.
+ * Check if the probe of latency of a ring is turned on.
  *
- * @param port_id Etherdev ID.
- * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
- * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
- * @param nb_pkts Maximum number of TX packets.
- * @return Number of TX packets as number of pointers to mbuf.
+ * @param ring_id Ring id.
+ * @return 1 if it is on, or 0 if not.
  */
-uint16_t sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
-		enum port_type iface_type,
-		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
-
-#else
-
-#define sppwk_init_ring_latency_stats(arg1, arg2) 0
-#define sppwk_clean_ring_latency_stats()
-#define sppwk_add_ring_latency_time(arg1, arg2, arg3)
-#define sppwk_calc_ring_latency(arg1, arg2, arg3)
-#define sppwk_get_ring_latency_stats_count() 0
-#define sppwk_get_ring_latency_stats(arg1, arg2)
-#define print_ringlatencystats_stats(arg)
-#define sppwk_eth_ring_stats_rx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_ring_stats_tx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_vlan_ring_stats_rx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_vlan_ring_stats_tx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+int sppwk_ring_latency_probe_is_on(int ring_id);
+
+/* Measure latency of packets dequeued from the port if its probe is on. */
+static inline void
+sppwk_lat_probe_rx(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	const struct sppwk_lat_probe *probe = &g_sppwk_lat_probes[port_id];
+
+	if (unlikely(probe->on))
+		sppwk_calc_ring_latency(probe->ring_id, pkts, nb_pkts);
+}
+
+/* Set timestamp to packets enqueued to the port if its probe is on. */
+static inline void
+sppwk_lat_probe_tx(uint16_t port_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	const struct sppwk_lat_probe *probe = &g_sppwk_lat_probes[port_id];
+
+	if (unlikely(probe->on))
+		sppwk_add_ring_latency_time(probe->ring_id, pkts, nb_pkts);
+}
 
 #endif /* _RINGLATENCYSTATS_H_ */
@@ -12,7 +12,7 @@
 #define SPPWK_PROC_TYPE "mirror"
 
 /* Num of entries of ops_list in mir_cmd_runner.c. */
-#define NOF_STAT_OPS 7
+#define NOF_STAT_OPS 15
 
 int exec_one_cmd(const struct sppwk_cmd_attrs *cmd);
 
@@ -7,13 +7,17 @@
 #include <rte_udp.h>
 #include <rte_tcp.h>
 #include <rte_net_crc.h>
+#include <rte_ring.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+#include <rte_vect.h>
+#endif
 
 #include "port_capability.h"
+#include "shared/chain_trace.h"
 #include "shared/secondary/return_codes.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "latency_stats.h"
-#endif
+#include "port_stats.h"
 
 /**
  * TODO(yasufum) This `port capability` is intended to be used mainly for VLAN
@@ -26,6 +30,28 @@
  * This problem should be fixed in a future update.
  */
 
+struct vlan_step;
+
+/* Operation of VLAN applied to a burst, returns num of succeeded packets. */
+typedef int (*vlan_f)(struct rte_mbuf **pkts, int nb_pkts,
+		const struct vlan_step *step);
+
+/* A step of VLAN operations compiled from a port attribute. */
+struct vlan_step {
+	vlan_f func;  /* Operation function of the step. */
+	uint16_t tpid;  /* TPID of pushed tag in network byte order. */
+	uint16_t tci;  /* TCI, or PCP bits to remark, in network byte order. */
+	int rewrite;  /* Rewrite TCI of outermost tag of the same TPID. */
+	int hw;  /* Tag is inserted or stripped by port. */
+	int need_fcs;  /* FCS is recalculated after packet is modified. */
+};
+
+/* Sequence of VLAN operations of a port, applied in order. */
+struct vlan_prog {
+	int nof_steps;
+	struct vlan_step steps[PORT_CAPABL_MAX];
+};
+
 /* Port capability management information used as a member of port_mng_info. */
 struct port_capabl_mng_info {
 	/* TODO(yasufum) rename ref_index and upd_index because flag. */
@@ -33,9 +59,17 @@ struct port_capabl_mng_info {
 	volatile int ref_index; /* Flag to indicate using reference side. */
 	volatile int upd_index; /* Flag to indicate using update side. */
 
+	int hw_insert;  /* VLAN tag is inserted by port in TX. */
+	int hw_strip;  /* VLAN tag is stripped by port in RX. */
+	int strip_pending;  /* Stripping is enabled after switching sides. */
+	int need_fcs;  /* FCS is recalculated after packet is modified. */
+
 	/* A set of attrs including sppwk_port_capability. */
 	/* TODO(yasufum) confirm why using PORT_CAPABL_MAX. */
 	struct sppwk_port_attrs port_attrs[TWO_SIDES][PORT_CAPABL_MAX];
+
+	/* Operations compiled from port_attrs of each side. */
+	struct vlan_prog progs[TWO_SIDES];
 };
 
 /* Port ability port information */
@@ -52,6 +86,15 @@ struct port_mng_info g_port_mng_info[RTE_MAX_ETHPORTS];
 /* TPID of VLAN. */
 static uint16_t g_vlan_tpid;
 
+/* Check if given TPID in network byte order is of VLAN or QinQ tag. */
+static inline int
+is_vlan_tpid(uint16_t tpid)
+{
+	return tpid == RTE_BE16(RTE_ETHER_TYPE_VLAN) ||
+			tpid == RTE_BE16(RTE_ETHER_TYPE_QINQ) ||
+			tpid == RTE_BE16(SPP_ETHER_TYPE_QINQ_OLD);
+}
+
 /* Initialize g_port_mng_info, and set ref side to 0 and update side to 1. */
 void
 sppwk_port_capability_init(void)
@@ -67,143 +110,283 @@ sppwk_port_capability_init(void)
 	}
 }
 
-/* Get port attributes of given ID and direction from g_port_mng_info. */
-void
-sppwk_get_port_attrs(struct sppwk_port_attrs **p_attrs,
-		int port_id, enum sppwk_port_dir dir)
+/* Get capability mng data of given ID and direction. */
+static inline struct port_capabl_mng_info *
+get_port_capabl_mng(int port_id, enum sppwk_port_dir dir)
 {
-	struct port_capabl_mng_info *mng = NULL;
-
 	switch (dir) {
 	case SPPWK_PORT_DIR_RX:
-		mng = &g_port_mng_info[port_id].rx;
-		break;
+		return &g_port_mng_info[port_id].rx;
 	case SPPWK_PORT_DIR_TX:
-		mng = &g_port_mng_info[port_id].tx;
-		break;
+		return &g_port_mng_info[port_id].tx;
 	default:
 		/* Not used. */
-		break;
+		return NULL;
 	}
+}
+
+/* Get port attributes of given ID and direction from g_port_mng_info. */
+void
+sppwk_get_port_attrs(struct sppwk_port_attrs **p_attrs,
+		int port_id, enum sppwk_port_dir dir)
+{
+	struct port_capabl_mng_info *mng = get_port_capabl_mng(port_id, dir);
 
 	*p_attrs = mng->port_attrs[mng->ref_index];
 }
 
-/* Calculation and Setting of FCS. */
+/* Check if packets are modified with VLAN feature of given port. */
+int
+sppwk_port_modifies_pkts(uint16_t port_id, enum sppwk_port_dir dir)
+{
+	struct sppwk_port_attrs *port_attrs = NULL;
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	return port_attrs[0].ops != SPPWK_PORT_OPS_NONE;
+}
+
+/**
+ * Calculation and Setting of FCS. It is written after the data of the last
+ * segment, and not written to a buffer shared with other packets, such as
+ * payload of L2 multicast copies.
+ */
 static inline void
 set_fcs_packet(struct rte_mbuf *pkt)
 {
 	uint32_t *fcs = NULL;
-	fcs = rte_pktmbuf_mtod_offset(pkt, uint32_t *, pkt->data_len);
-	*fcs = rte_net_crc_calc(rte_pktmbuf_mtod(pkt, void *),
-			pkt->data_len, RTE_NET_CRC32_ETH);
+	const void *data;
+	struct rte_mbuf *last = rte_pktmbuf_lastseg(pkt);
+	uint8_t buf[RTE_ETHER_MAX_JUMBO_FRAME_LEN];
+
+	if (unlikely(!RTE_MBUF_DIRECT(last) ||
+			rte_pktmbuf_tailroom(last) < sizeof(*fcs)))
+		return;
+
+	/* Segmented packet is read into `buf` to be calculated at once. */
+	if (likely(pkt->nb_segs == 1))
+		data = rte_pktmbuf_mtod(pkt, void *);
+	else if (pkt->pkt_len <= sizeof(buf))
+		data = rte_pktmbuf_read(pkt, 0, pkt->pkt_len, buf);
+	else
+		return;
+
+	fcs = rte_pktmbuf_mtod_offset(last, uint32_t *, last->data_len);
+	*fcs = rte_net_crc_calc(data, pkt->pkt_len, RTE_NET_CRC32_ETH);
 }
 
-/* Add VLAN tag to a packet. It is called from add_vlan_tag_all(). */
-static inline int
-add_vlan_tag_one(
-		struct rte_mbuf *pkt,
-		const union sppwk_port_capability *capability)
+/**
+ * Min length of packet of which header is moved with SIMD, including 16
+ * bytes read after VLAN tag.
+ */
+#define VLAN_HDR_MIN_LEN 20
+
+/* TPID and TCI of VLAN tag to be written at once. */
+union vlan_tag_word {
+	uint32_t word;
+	uint16_t half[2];  /* TPID and TCI in network byte order. */
+};
+
+/**
+ * Move MAC addresses of a packet to the head of area prepended for VLAN tag
+ * and put the tag after them. Original ether type is left as it is because
+ * it is already placed just after the tag.
+ */
+static inline void
+insert_vlan_hdr(struct rte_mbuf *pkt, uint32_t tag)
 {
-	struct rte_ether_hdr *old_ether = NULL;
-	struct rte_ether_hdr *new_ether = NULL;
-	struct rte_vlan_hdr  *vlan      = NULL;
-	const struct sppwk_vlan_tag *vlantag = &capability->vlantag;
-
-	old_ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
-		/* For packets with VLAN tags, only VLAN ID is updated */
-		new_ether = old_ether;
-		vlan = (struct rte_vlan_hdr *)&new_ether[1];
-	} else {
-		/* For packets without VLAN tag, add VLAN tag. */
-		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_prepend(pkt,
-				sizeof(struct rte_vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"get additional header area.\n");
-			return SPPWK_RET_NG;
-		}
+	uint32_t *new = rte_pktmbuf_mtod(pkt, uint32_t *);
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+	__m128i hdr;
+
+	if (likely(pkt->data_len >= VLAN_HDR_MIN_LEN)) {
+		hdr = _mm_loadu_si128((const __m128i *)(new + 1));
+		hdr = _mm_insert_epi32(hdr, (int)tag, 3);
+		_mm_storeu_si128((__m128i *)new, hdr);
+		return;
+	}
+#endif
+	new[0] = new[1];
+	new[1] = new[2];
+	new[2] = new[3];
+	new[3] = tag;
+}
+
+/**
+ * Move MAC addresses of a packet from which VLAN tag is adjusted to be just
+ * before the ether type.
+ */
+static inline void
+remove_vlan_hdr(struct rte_mbuf *pkt)
+{
+	uint32_t *new = rte_pktmbuf_mtod(pkt, uint32_t *);
+	uint32_t *old = new - 1;
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+	__m128i mac, cur;
+
+	if (likely(pkt->data_len >= VLAN_HDR_MIN_LEN)) {
+		mac = _mm_loadu_si128((const __m128i *)old);
+		cur = _mm_loadu_si128((const __m128i *)new);
+		_mm_storeu_si128((__m128i *)new,
+				_mm_blend_epi16(mac, cur, 0xC0));
+		return;
+	}
+#endif
+	new[2] = old[2];
+	new[1] = old[1];
+	new[0] = old[0];
+}
+
+/* Insert VLAN tag to prepended packets and recalculate FCS if needed. */
+static inline void
+insert_vlan_hdrs(struct rte_mbuf **pkts, int nb_pkts, uint32_t tag,
+		int need_fcs)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++)
+		insert_vlan_hdr(pkts[cnt], tag);
 
-		rte_memcpy(new_ether, old_ether, sizeof(struct rte_ether_hdr));
-		vlan = (struct rte_vlan_hdr *)&new_ether[1];
-		vlan->eth_proto = new_ether->ether_type;
-		new_ether->ether_type = g_vlan_tpid;
+	if (need_fcs) {
+		for (cnt = 0; cnt < nb_pkts; cnt++)
+			set_fcs_packet(pkts[cnt]);
 	}
+}
+
+/* Remove VLAN tag from adjusted packets and recalculate FCS if needed. */
+static inline void
+remove_vlan_hdrs(struct rte_mbuf **pkts, int nb_pkts, int need_fcs)
+{
+	int cnt;
 
-	vlan->vlan_tci = vlantag->tci;
-	set_fcs_packet(pkt);
-	return SPPWK_RET_OK;
+	for (cnt = 0; cnt < nb_pkts; cnt++)
+		remove_vlan_hdr(pkts[cnt]);
+
+	if (need_fcs) {
+		for (cnt = 0; cnt < nb_pkts; cnt++)
+			set_fcs_packet(pkts[cnt]);
+	}
 }
 
-/* Add VLAN tag to all packets. */
-static inline int
-add_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
+/**
+ * Add VLAN tag to all packets. Packets are classified with ether type at
+ * first, and then headers of ones to be pushed are moved in a batch. Tag of
+ * a packet is given to port via mbuf if the port inserts it.
+ */
+static int
+add_vlan_tag_all(struct rte_mbuf **pkts, int nb_pkts,
+		const struct vlan_step *step)
 {
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
+	int cnt;
+	int nof_ins = 0;
+	union vlan_tag_word tag;
+	struct rte_ether_hdr *ether = NULL;
+	struct rte_vlan_hdr *vlan = NULL;
+	struct rte_mbuf *ins_pkts[MAX_PKT_BURST];
+
+	tag.half[0] = step->tpid;
+	tag.half[1] = step->tci;
 	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = add_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to add VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
+		ether = rte_pktmbuf_mtod(pkts[cnt], struct rte_ether_hdr *);
+		if (step->rewrite && ether->ether_type == step->tpid) {
+			/* For packets with the tag, only TCI is updated. */
+			vlan = (struct rte_vlan_hdr *)&ether[1];
+			vlan->vlan_tci = step->tci;
+			if (step->need_fcs)
+				set_fcs_packet(pkts[cnt]);
+			continue;
+		}
+
+		if (step->hw) {
+			/* Port inserts VLAN tag without touching packet. */
+			pkts[cnt]->vlan_tci = rte_be_to_cpu_16(step->tci);
+			pkts[cnt]->ol_flags |= PKT_TX_VLAN_PKT;
+			continue;
+		}
+
+		/* Push VLAN tag. */
+		if (unlikely(rte_pktmbuf_prepend(pkts[cnt],
+				sizeof(struct rte_vlan_hdr)) == NULL)) {
+			RTE_LOG(ERR, PORT, "Failed to add VLAN tag, no more "
+					"header area. (pkts %d/%d)\n",
+					cnt, nb_pkts);
 			break;
 		}
+		ins_pkts[nof_ins++] = pkts[cnt];
+		if (unlikely(nof_ins == MAX_PKT_BURST)) {
+			insert_vlan_hdrs(ins_pkts, nof_ins, tag.word,
+					step->need_fcs);
+			nof_ins = 0;
+		}
 	}
+
+	insert_vlan_hdrs(ins_pkts, nof_ins, tag.word, step->need_fcs);
 	return cnt;
 }
 
-/* Delete VLAN tag from a packet. It is called from del_vlan_tag_all(). */
-static inline int
-del_vlan_tag_one(
-		struct rte_mbuf *pkt,
-		const union sppwk_port_capability *cbl __attribute__ ((unused)))
+/**
+ * Delete outermost VLAN tag from all packets. Packets are classified with
+ * ether type at first, and then headers of tagged ones are moved in a batch.
+ * Tag already stripped by port is only cleared from mbuf.
+ */
+static int
+del_vlan_tag_all(struct rte_mbuf **pkts, int nb_pkts,
+		const struct vlan_step *step)
 {
-	struct rte_ether_hdr *old_ether = NULL;
-	struct rte_ether_hdr *new_ether = NULL;
-	uint32_t *old, *new;
-
-	old_ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
-		/* For packets without VLAN tag, delete VLAN tag. */
-		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_adj(pkt,
-				sizeof(struct rte_vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"delete unnecessary header area.\n");
-			return SPPWK_RET_NG;
+	int cnt;
+	int nof_rem = 0;
+	struct rte_ether_hdr *ether = NULL;
+	struct rte_mbuf *rem_pkts[MAX_PKT_BURST];
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (step->hw && (pkts[cnt]->ol_flags & PKT_RX_VLAN_STRIPPED)) {
+			pkts[cnt]->ol_flags &=
+					~(PKT_RX_VLAN | PKT_RX_VLAN_STRIPPED);
+			pkts[cnt]->vlan_tci = 0;
+			continue;
 		}
 
-		old = (uint32_t *)old_ether;
-		new = (uint32_t *)new_ether;
-		new[2] = old[2];
-		new[1] = old[1];
-		new[0] = old[0];
-		old[0] = 0;
-		set_fcs_packet(pkt);
+		ether = rte_pktmbuf_mtod(pkts[cnt], struct rte_ether_hdr *);
+		if (!is_vlan_tpid(ether->ether_type))
+			continue;
+
+		/* For packets with VLAN tag, delete VLAN tag. */
+		if (unlikely(rte_pktmbuf_adj(pkts[cnt],
+				sizeof(struct rte_vlan_hdr)) == NULL)) {
+			RTE_LOG(ERR, PORT, "Failed to del VLAN tag, cannot "
+					"delete header area. (pkts %d/%d)\n",
+					cnt, nb_pkts);
+			break;
+		}
+		rem_pkts[nof_rem++] = pkts[cnt];
+		if (unlikely(nof_rem == MAX_PKT_BURST)) {
+			remove_vlan_hdrs(rem_pkts, nof_rem, step->need_fcs);
+			nof_rem = 0;
+		}
 	}
-	return SPPWK_RET_OK;
+
+	remove_vlan_hdrs(rem_pkts, nof_rem, step->need_fcs);
+	return cnt;
 }
 
-/* Delete VLAN tag from all packets. */
-static inline int
-del_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
+/* Remark PCP of outermost VLAN tag of all packets. */
+static int
+set_vlan_pcp_all(struct rte_mbuf **pkts, int nb_pkts,
+		const struct vlan_step *step)
 {
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
+	int cnt;
+	struct rte_ether_hdr *ether = NULL;
+	struct rte_vlan_hdr *vlan = NULL;
+
 	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = del_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to del VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
+		ether = rte_pktmbuf_mtod(pkts[cnt], struct rte_ether_hdr *);
+		if (!is_vlan_tpid(ether->ether_type))
+			continue;
+
+		vlan = (struct rte_vlan_hdr *)&ether[1];
+		vlan->vlan_tci = (vlan->vlan_tci & ~RTE_BE16(SPP_VLAN_PCP_MASK))
+				| step->tci;
+		if (step->need_fcs)
+			set_fcs_packet(pkts[cnt]);
 	}
 	return cnt;
 }
@@ -254,6 +437,146 @@ sppwk_swap_two_sides(
 	}
 }
 
+/* Enable or disable stripping VLAN tag in RX by port of given ID. */
+static void
+set_vlan_strip(uint16_t port_id, struct port_capabl_mng_info *mng, int on)
+{
+	int vlan_ofld;
+	struct rte_eth_dev_info dev_info;
+
+	rte_eth_dev_info_get(port_id, &dev_info);
+	if (!(dev_info.rx_offload_capa & DEV_RX_OFFLOAD_VLAN_STRIP))
+		return;
+
+	vlan_ofld = rte_eth_dev_get_vlan_offload(port_id);
+	if (vlan_ofld < 0)
+		return;
+	if (on)
+		vlan_ofld |= ETH_VLAN_STRIP_OFFLOAD;
+	else
+		vlan_ofld &= ~ETH_VLAN_STRIP_OFFLOAD;
+
+	if (rte_eth_dev_set_vlan_offload(port_id, vlan_ofld) != 0) {
+		RTE_LOG(WARNING, PORT, "Failed to set VLAN strip of port %u, "
+				"use software instead.\n", port_id);
+		return;
+	}
+	mng->hw_strip = on;
+}
+
+/**
+ * Update VLAN offloads and FCS handling of port for given direction. PMD of
+ * phy appends FCS in TX and strips it in RX, so FCS is not recalculated for
+ * it. Stripping VLAN tag in RX is enabled only while the first operation of
+ * the port is `del`, and software is used if it cannot be enabled.
+ *
+ * Worker refers operations of ref side while stripping is changed. `del` as
+ * the first operation deletes tag in software if it is not stripped, but
+ * other operations do not restore the stripped tag. So stripping is
+ * disabled here before switching sides, and enabled after workers switch to
+ * the update side in sppwk_apply_vlan_strip().
+ */
+static void
+update_vlan_offload(const struct sppwk_port_info *port,
+		enum sppwk_port_dir dir, struct port_capabl_mng_info *mng,
+		const struct sppwk_port_attrs *port_attrs)
+{
+	int has_del;
+	uint16_t port_id = port->ethdev_port_id;
+
+	mng->need_fcs = (port->iface_type != PHY);
+	if (port->iface_type != PHY)
+		return;
+
+	if (dir == SPPWK_PORT_DIR_TX) {
+		mng->hw_insert = ((rte_eth_devices[port_id].data->
+				dev_conf.txmode.offloads &
+				DEV_TX_OFFLOAD_VLAN_INSERT) != 0);
+		return;
+	}
+
+	has_del = (port_attrs[0].ops == SPPWK_PORT_OPS_DEL_VLAN);
+	mng->strip_pending = (has_del && !mng->hw_strip);
+	if (!has_del && mng->hw_strip)
+		set_vlan_strip(port_id, mng, 0);
+}
+
+/* Enable stripping VLAN tag of ports after workers switch sides. */
+void
+sppwk_apply_vlan_strip(void)
+{
+	int port_id;
+	struct port_capabl_mng_info *mng;
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		mng = &g_port_mng_info[port_id].rx;
+		if (!mng->strip_pending)
+			continue;
+
+		mng->strip_pending = 0;
+		set_vlan_strip(port_id, mng, 1);
+	}
+}
+
+/**
+ * Compile port attributes into a sequence of VLAN operations. Port inserts
+ * tag as outermost after all of operations, so it is used only for adding
+ * tag at last. Tag stripped by port is outermost before all of operations,
+ * so it is taken only in deleting tag at first.
+ */
+static void
+compile_vlan_prog(struct vlan_prog *prog,
+		const struct sppwk_port_attrs *port_attrs,
+		const struct port_capabl_mng_info *mng,
+		enum sppwk_port_dir dir)
+{
+	int cnt;
+	struct vlan_step *step = NULL;
+	const struct sppwk_vlan_tag *tag = NULL;
+
+	memset(prog, 0x00, sizeof(struct vlan_prog));
+	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
+		if (port_attrs[cnt].ops == SPPWK_PORT_OPS_NONE)
+			break;
+
+		tag = &port_attrs[cnt].capability.vlantag;
+		step = &prog->steps[prog->nof_steps++];
+		step->need_fcs = mng->need_fcs;
+		switch (port_attrs[cnt].ops) {
+		case SPPWK_PORT_OPS_ADD_VLAN:
+			step->func = add_vlan_tag_all;
+			step->tpid = g_vlan_tpid;
+			step->tci = tag->tci;
+			step->rewrite = 1;
+			break;
+		case SPPWK_PORT_OPS_ADD_STAG:
+			step->func = add_vlan_tag_all;
+			step->tpid = rte_cpu_to_be_16(tag->tpid);
+			step->tci = tag->tci;
+			break;
+		case SPPWK_PORT_OPS_DEL_VLAN:
+			step->func = del_vlan_tag_all;
+			step->hw = (dir == SPPWK_PORT_DIR_RX && cnt == 0);
+			break;
+		case SPPWK_PORT_OPS_SET_PCP:
+			step->func = set_vlan_pcp_all;
+			step->tci = rte_cpu_to_be_16(SPP_VLANTAG_CALC_TCI(
+					0, tag->pcp));
+			break;
+		default:
+			/* Not used. */
+			prog->nof_steps--;
+			break;
+		}
+	}
+
+	if (dir == SPPWK_PORT_DIR_TX && mng->hw_insert &&
+			prog->nof_steps > 0 &&
+			port_attrs[prog->nof_steps - 1].ops ==
+			SPPWK_PORT_OPS_ADD_VLAN)
+		prog->steps[prog->nof_steps - 1].hw = 1;
+}
+
 /* Update port attributes of given direction. */
 static void
 update_port_attrs(struct sppwk_port_info *port,
@@ -294,6 +617,7 @@ update_port_attrs(struct sppwk_port_info *port,
 
 		switch (port_attrs_out[out_cnt].ops) {
 		case SPPWK_PORT_OPS_ADD_VLAN:
+		case SPPWK_PORT_OPS_ADD_STAG:
 			tag = &port_attrs_out[out_cnt].capability.vlantag;
 			tag->tci = rte_cpu_to_be_16(SPP_VLANTAG_CALC_TCI(
 					tag->vid, tag->pcp));
@@ -306,6 +630,9 @@ update_port_attrs(struct sppwk_port_info *port,
 
 		out_cnt++;
 	}
+	update_vlan_offload(port, dir, mng, port_attrs_out);
+	compile_vlan_prog(&mng->progs[mng->upd_index], port_attrs_out, mng,
+			dir);
 
 	sppwk_swap_two_sides(SPPWK_SWAP_UPD, port_id, dir);
 }
@@ -329,60 +656,62 @@ sppwk_update_port_dir(const struct sppwk_comp_info *comp)
 }
 
 /**
- * Define list of VLAN opeartion functions. It is only used in
- * vlan_operation().
+ * Apply VLAN operations of the port in order. Packets failed are moved to
+ * the tail. They are released here for RX, but left to the caller for TX
+ * because it releases packets which are not transmitted.
  */
-typedef int (*vlan_f)(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability);
-
-vlan_f vlan_ops[] = {
-	NULL,              /* None */
-	add_vlan_tag_all,  /* Add VLAN tag */
-	del_vlan_tag_all,  /* Del VLAN tag */
-	NULL               /* Termination */
-};
-
-/* Add or delete VLAN tag. */
 static inline int
 vlan_operation(uint16_t port_id, struct rte_mbuf **pkts, const uint16_t nb_pkts,
 		enum sppwk_port_dir dir)
 {
 	int cnt, buf;
 	int ok_pkts = nb_pkts;
-	struct sppwk_port_attrs *port_attrs = NULL;
+	struct port_capabl_mng_info *mng = get_port_capabl_mng(port_id, dir);
+	const struct vlan_prog *prog = &mng->progs[mng->ref_index];
 
-	sppwk_get_port_attrs(&port_attrs, port_id, dir);
-	if (unlikely(port_attrs[0].ops == SPPWK_PORT_OPS_NONE))
+	if (likely(prog->nof_steps == 0))
 		return nb_pkts;
 
-	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
-		/* Do nothing if the port is assigned no VLAN feature. */
-		if (port_attrs[cnt].ops == SPPWK_PORT_OPS_NONE)
-			break;
-
-		/* Add or delete VLAN tag with operation function. */
-		ok_pkts = vlan_ops[port_attrs[cnt].ops](
-				pkts, ok_pkts, &port_attrs->capability);
-	}
+	for (cnt = 0; cnt < prog->nof_steps; cnt++)
+		ok_pkts = prog->steps[cnt].func(pkts, ok_pkts,
+				&prog->steps[cnt]);
 
 	/* Discard remained packets to release mbuf. */
 	if (unlikely(ok_pkts < nb_pkts)) {
-		for (buf = ok_pkts; buf < nb_pkts; buf++)
-			rte_pktmbuf_free(pkts[buf]);
+		sppwk_cnt_vlan_drop(port_id, dir, nb_pkts - ok_pkts);
+		if (dir == SPPWK_PORT_DIR_RX) {
+			for (buf = ok_pkts; buf < nb_pkts; buf++)
+				rte_pktmbuf_free(pkts[buf]);
+		}
 	}
 
 	return ok_pkts;
 }
 
+/* Wrapper function for rte_eth_rx_burst() counting packets. */
+uint16_t
+sppwk_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
+		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
+{
+	uint16_t nb_rx;
+	nb_rx = rte_eth_rx_burst(port_id, queue_id, rx_pkts, nb_pkts);
+	if (unlikely(nb_rx == 0))
+		return SPPWK_RET_OK;
+
+	sppwk_cnt_rx(port_id, nb_rx, 0);
+	sppwk_lat_probe_rx(port_id, rx_pkts, nb_rx);
+	chain_trace_rx(port_id, rx_pkts, nb_rx);
+	return nb_rx;
+}
+
 /* Wrapper function for rte_eth_rx_burst() with VLAN feature. */
 uint16_t
 sppwk_eth_vlan_rx_burst(uint16_t port_id,
-		uint16_t queue_id __attribute__ ((unused)),
+		uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_rx;
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+	nb_rx = sppwk_eth_rx_burst(port_id, queue_id, rx_pkts, nb_pkts);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
@@ -390,49 +719,69 @@ sppwk_eth_vlan_rx_burst(uint16_t port_id,
 	return vlan_operation(port_id, rx_pkts, nb_rx, SPPWK_PORT_DIR_RX);
 }
 
-/* Wrapper function for rte_eth_tx_burst() with VLAN feature. */
-uint16_t
-sppwk_eth_vlan_tx_burst(uint16_t port_id,
-		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+/* Transmit packets staged by other lcores sharing the TX queue. */
+void
+sppwk_eth_tx_drain(uint16_t port_id, const struct sppwk_tx_queue *txq)
 {
+	unsigned int nb_deq, buf;
 	uint16_t nb_tx;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
 
-	/* Add or delete VLAN tag. */
-	nb_tx = vlan_operation(port_id, tx_pkts, nb_pkts, SPPWK_PORT_DIR_TX);
+	if (likely(txq->stage == NULL) || !txq->owner)
+		return;
 
-	if (unlikely(nb_tx == 0))
-		return SPPWK_RET_OK;
+	nb_deq = rte_ring_dequeue_burst(txq->stage, (void **)pkts,
+			MAX_PKT_BURST, NULL);
+	if (nb_deq == 0)
+		return;
 
-	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_tx);
-}
+	nb_tx = rte_eth_tx_burst(port_id, txq->queue_id, pkts, nb_deq);
+	sppwk_cnt_tx(port_id, nb_tx, nb_deq - nb_tx);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
+	/* Discard remained packets to release mbuf. */
+	for (buf = nb_tx; buf < nb_deq; buf++)
+		rte_pktmbuf_free(pkts[buf]);
+}
 
-/* Wrapper function for rte_eth_rx_burst() with VLAN feature. */
+/**
+ * Wrapper function for rte_eth_tx_burst() to TX queue shared by lcores.
+ * Staged packets are counted as transmitted by the owner in draining.
+ */
 uint16_t
-sppwk_eth_vlan_ring_stats_rx_burst(uint16_t port_id,
-		enum port_type iface_type, int iface_no,
-		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
+sppwk_eth_tx_burst(uint16_t port_id, const struct sppwk_tx_queue *txq,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 {
-	uint16_t nb_rx;
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
-	if (unlikely(nb_rx == 0))
-		return SPPWK_RET_OK;
+	uint16_t nb_tx;
 
-	if (iface_type == RING)
-		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_pkts);
+	/* Set timestamp before the packets are dequeued by other lcore. */
+	sppwk_lat_probe_tx(port_id, tx_pkts, nb_pkts);
+	chain_trace_tx(port_id, tx_pkts, nb_pkts);
 
-	/* Add or delete VLAN tag. */
-	return vlan_operation(port_id, rx_pkts, nb_rx, SPPWK_PORT_DIR_RX);
+	if (likely(txq->stage == NULL)) {
+		nb_tx = rte_eth_tx_burst(port_id, txq->queue_id,
+				tx_pkts, nb_pkts);
+		sppwk_cnt_tx(port_id, nb_tx, nb_pkts - nb_tx);
+		return nb_tx;
+	}
+
+	/* Only the owner of the queue calls PMD. */
+	if (!txq->owner) {
+		nb_tx = rte_ring_mp_enqueue_burst(txq->stage,
+				(void **)tx_pkts, nb_pkts, NULL);
+		sppwk_cnt_tx(port_id, 0, nb_pkts - nb_tx);
+		return nb_tx;
+	}
+
+	sppwk_eth_tx_drain(port_id, txq);
+	nb_tx = rte_eth_tx_burst(port_id, txq->queue_id, tx_pkts, nb_pkts);
+	sppwk_cnt_tx(port_id, nb_tx, nb_pkts - nb_tx);
+	return nb_tx;
 }
 
 /* Wrapper function for rte_eth_tx_burst() with VLAN feature. */
 uint16_t
-sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
-		enum port_type iface_type, int iface_no,
-		uint16_t queue_id __attribute__ ((unused)),
+sppwk_eth_vlan_tx_burst(uint16_t port_id,
+		const struct sppwk_tx_queue *txq,
 		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 {
 	uint16_t nb_tx;
@@ -443,11 +792,5 @@ sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
 	if (unlikely(nb_tx == 0))
 		return SPPWK_RET_OK;
 
-	if (iface_type == RING) {
-		sppwk_add_ring_latency_time(iface_no, tx_pkts, nb_pkts);
-	}
-
-	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_tx);
+	return sppwk_eth_tx_burst(port_id, txq, tx_pkts, nb_tx);
 }
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
@@ -58,11 +58,38 @@ void sppwk_swap_two_sides(
  */
 void sppwk_update_port_dir(const struct sppwk_comp_info *comp);
 
+/**
+ * Enable stripping VLAN tag in RX of ports updated to delete tag at first.
+ * It should be called after workers switch to the update side.
+ */
+void sppwk_apply_vlan_strip(void);
+
+/**
+ * Check if packets are modified with VLAN feature of given port.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] dir Direction of the port of sppwk_port_dir.
+ * @return 1 if packets are modified, or 0 if not.
+ */
+int sppwk_port_modifies_pkts(uint16_t port_id, enum sppwk_port_dir dir);
+
+/**
+ * Wrapper function for rte_eth_rx_burst() counting received packets.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] queue_id RX queue ID bound to the component.
+ * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of RX packets.
+ * @return Number of RX packets as number of pointers to mbuf.
+ */
+uint16_t sppwk_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
+		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
+
 /**
  * Wrapper function for rte_eth_rx_burst() with VLAN feature.
  *
  * @param[in] port_id Etherdev ID.
- * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
+ * @param[in] queue_id RX queue ID bound to the component.
  * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
  * @param nb_pkts Maximum number of RX packets.
  * @return Number of RX packets as number of pointers to mbuf.
@@ -70,16 +97,41 @@ void sppwk_update_port_dir(const struct sppwk_comp_info *comp);
 uint16_t sppwk_eth_vlan_rx_burst(uint16_t port_id, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
+/**
+ * Wrapper function for rte_eth_tx_burst() to TX queue which can be shared
+ * by several lcores. Packets are enqueued to staging ring if the lcore is
+ * not the owner of the queue.
+ *
+ * @param port_id Etherdev ID.
+ * @param[in] txq TX queue used by the lcore.
+ * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of TX packets.
+ * @return Number of TX or staged packets as number of pointers to mbuf.
+ */
+uint16_t sppwk_eth_tx_burst(uint16_t port_id,
+		const struct sppwk_tx_queue *txq,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+
+/**
+ * Transmit packets staged by other lcores if the lcore is the owner of
+ * shared TX queue. It should be called in each loop of worker thread.
+ *
+ * @param port_id Etherdev ID.
+ * @param[in] txq TX queue used by the lcore.
+ */
+void sppwk_eth_tx_drain(uint16_t port_id, const struct sppwk_tx_queue *txq);
+
 /**
  * Wrapper function for rte_eth_tx_burst() with VLAN feature.
  *
  * @param port_id Etherdev ID.
- * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
+ * @param[in] txq TX queue used by the lcore.
  * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
  * @param nb_pkts Maximum number of TX packets.
  * @return Number of TX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_vlan_tx_burst(uint16_t port_id, uint16_t queue_id,
+uint16_t sppwk_eth_vlan_tx_burst(uint16_t port_id,
+		const struct sppwk_tx_queue *txq,
 		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
 
 #endif /*  __PORT_CAPABILITY_H__ */
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+#include "port_stats.h"
+
+/* Blocks of counters of lcores, and threads other than EAL lcores. */
+struct sppwk_lcore_cnts g_sppwk_lcore_cnts[RTE_MAX_LCORE + 1];
+
+/* Cycles of components. */
+struct poll_cycles g_sppwk_comp_cycles[RTE_MAX_LCORE];
+
+/**
+ * Sum up counters of given port. Counters are read while lcores update
+ * them, so the result might be slightly behind.
+ */
+void
+sppwk_sum_port_cnts(uint16_t port_id, struct sppwk_port_cnts *sum)
+{
+	int lcore_id;
+	const struct sppwk_port_cnts *cnts;
+
+	memset(sum, 0x00, sizeof(struct sppwk_port_cnts));
+	for (lcore_id = 0; lcore_id <= RTE_MAX_LCORE; lcore_id++) {
+		cnts = &g_sppwk_lcore_cnts[lcore_id].ports[port_id];
+		sum->rx += cnts->rx;
+		sum->rx_drop += cnts->rx_drop;
+		sum->rx_vlan_drop += cnts->rx_vlan_drop;
+		sum->tx += cnts->tx;
+		sum->tx_drop += cnts->tx_drop;
+		sum->tx_vlan_drop += cnts->tx_vlan_drop;
+	}
+}
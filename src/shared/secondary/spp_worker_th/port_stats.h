@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __PORT_STATS_H__
+#define __PORT_STATS_H__
+
+/**
+ * @file
+ * SPP worker packet counters
+ *
+ * Counters of received, transmitted and dropped packets of each of ports,
+ * of classifying packets, and of cycles of polling of lcores and components.
+ * Each of lcores has its own block of counters aligned to cache line, so it
+ * is updated without atomic operations and summed up only when it is
+ * referred for `status` command.
+ */
+
+#include <rte_lcore.h>
+#include <rte_ethdev.h>
+#include "data_types.h"
+
+/** Counters of a port counted by an lcore. */
+struct sppwk_port_cnts {
+	uint64_t rx;  /**< Packets received. */
+	uint64_t rx_drop;  /**< Packets dropped after received. */
+	uint64_t rx_vlan_drop;  /**< Packets dropped by VLAN operation in RX. */
+	uint64_t tx;  /**< Packets transmitted. */
+	uint64_t tx_drop;  /**< Packets failed to transmit. */
+	uint64_t tx_vlan_drop;  /**< Packets dropped by VLAN operation in TX. */
+};
+
+/** Block of counters updated only by its lcore. */
+struct sppwk_lcore_cnts {
+	uint64_t cls_miss;  /**< Packets of no destination in classifier. */
+	uint64_t mcast_fanout;  /**< Multicast packets pushed to ports. */
+	uint64_t nof_rx;  /**< Packets received from any of ports. */
+	struct poll_cycles cycles;  /**< Cycles of running components. */
+	struct sppwk_port_cnts ports[RTE_MAX_ETHPORTS];
+} __rte_cache_aligned;
+
+/* Last one is shared by threads other than EAL lcores. */
+extern struct sppwk_lcore_cnts g_sppwk_lcore_cnts[RTE_MAX_LCORE + 1];
+
+/**
+ * Cycles of each of components indexed with component ID. It is written by
+ * the lcore the component is assigned to.
+ */
+extern struct poll_cycles g_sppwk_comp_cycles[RTE_MAX_LCORE];
+
+/* Get block of counters of the caller. */
+static inline struct sppwk_lcore_cnts *
+sppwk_lcore_cnts(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		lcore_id = RTE_MAX_LCORE;
+	return &g_sppwk_lcore_cnts[lcore_id];
+}
+
+/* Count packets received from the port. */
+static inline void
+sppwk_cnt_rx(uint16_t port_id, uint16_t nb_rx, uint16_t nb_drop)
+{
+	struct sppwk_lcore_cnts *lcore_cnts = sppwk_lcore_cnts();
+	struct sppwk_port_cnts *cnts = &lcore_cnts->ports[port_id];
+
+	cnts->rx += nb_rx;
+	cnts->rx_drop += nb_drop;
+	lcore_cnts->nof_rx += nb_rx;
+}
+
+/* Count packets transmitted to the port, and failed ones. */
+static inline void
+sppwk_cnt_tx(uint16_t port_id, uint16_t nb_tx, uint16_t nb_drop)
+{
+	struct sppwk_port_cnts *cnts = &sppwk_lcore_cnts()->ports[port_id];
+
+	cnts->tx += nb_tx;
+	cnts->tx_drop += nb_drop;
+}
+
+/* Count packets dropped by VLAN operation of the port. */
+static inline void
+sppwk_cnt_vlan_drop(uint16_t port_id, enum sppwk_port_dir dir,
+		uint16_t nb_drop)
+{
+	struct sppwk_port_cnts *cnts = &sppwk_lcore_cnts()->ports[port_id];
+
+	if (dir == SPPWK_PORT_DIR_RX)
+		cnts->rx_vlan_drop += nb_drop;
+	else
+		cnts->tx_vlan_drop += nb_drop;
+}
+
+/* Count packets of no destination in classifier. */
+static inline void
+sppwk_cnt_cls_miss(uint16_t nb_pkts)
+{
+	sppwk_lcore_cnts()->cls_miss += nb_pkts;
+}
+
+/* Count multicast packets pushed to ports including shared ones. */
+static inline void
+sppwk_cnt_mcast_fanout(uint16_t nb_pkts)
+{
+	sppwk_lcore_cnts()->mcast_fanout += nb_pkts;
+}
+
+/**
+ * Count cycles of running a component on the caller lcore. Packets received
+ * by the component are given as the difference of `nof_rx` of the lcore
+ * before and after running it.
+ *
+ * @param[in] comp_id Component ID.
+ * @param[in] cycles Cycles of TSC of running the component.
+ * @param[in] nb_rx Num of packets received by the component.
+ */
+static inline void
+sppwk_cnt_cycles(int comp_id, uint64_t cycles, uint64_t nb_rx)
+{
+	poll_cycles_add(&sppwk_lcore_cnts()->cycles, cycles, nb_rx);
+	poll_cycles_add(&g_sppwk_comp_cycles[comp_id], cycles, nb_rx);
+}
+
+/**
+ * Sum up counters of given port of all of lcores.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[out] sum Counters of the port.
+ */
+void sppwk_sum_port_cnts(uint16_t port_id, struct sppwk_port_cnts *sum);
+
+#endif /* __PORT_STATS_H__ */
@@ -0,0 +1,178 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_memzone.h>
+#include <rte_log.h>
+#include <rte_branch_prediction.h>
+
+#include "telemetry.h"
+#include "cmd_utils.h"
+#include "latency_stats.h"
+#include "shared/secondary/return_codes.h"
+
+#define RTE_LOGTYPE_WK_TELEMETRY RTE_LOGTYPE_USER1
+
+/* Telemetry in the memzone, or NULL if it is not initialized. */
+static struct sppwk_telemetry *g_telemetry;
+
+/* Interval of update and TSC of last update. */
+static uint64_t g_telemetry_intvl;
+static uint64_t g_telemetry_last_tsc;
+
+/* Reserve memzone of telemetry, or lookup it if it is remained. */
+int
+sppwk_telemetry_init(int client_id, const char *proc_type)
+{
+	const struct rte_memzone *mz;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+
+	snprintf(mz_name, sizeof(mz_name), SPPWK_TELEMETRY_MZ_NAME,
+			client_id);
+	mz = rte_memzone_lookup(mz_name);
+	if (mz == NULL)
+		mz = rte_memzone_reserve(mz_name,
+				sizeof(struct sppwk_telemetry),
+				rte_socket_id(), 0);
+	if (unlikely(mz == NULL)) {
+		RTE_LOG(ERR, WK_TELEMETRY,
+				"Cannot reserve memzone `%s`.\n", mz_name);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(mz->len < sizeof(struct sppwk_telemetry))) {
+		RTE_LOG(ERR, WK_TELEMETRY,
+				"Memzone `%s` is too small (%zu).\n",
+				mz_name, mz->len);
+		return SPPWK_RET_NG;
+	}
+
+	g_telemetry = mz->addr;
+	memset(g_telemetry, 0x00, sizeof(struct sppwk_telemetry));
+	g_telemetry->magic = SPPWK_TELEMETRY_MAGIC;
+	g_telemetry->version = SPPWK_TELEMETRY_VERSION;
+	g_telemetry->size = sizeof(struct sppwk_telemetry);
+	g_telemetry->client_id = client_id;
+	strncpy(g_telemetry->proc_type, proc_type, STR_LEN_SHORT - 1);
+	g_telemetry->tsc_hz = rte_get_tsc_hz();
+
+	g_telemetry_intvl = rte_get_tsc_hz() / US_PER_S *
+			SPPWK_TELEMETRY_INTERVAL;
+	g_telemetry_last_tsc = 0;
+	RTE_LOG(INFO, WK_TELEMETRY, "Publish telemetry to `%s`.\n", mz_name);
+	return SPPWK_RET_OK;
+}
+
+/* Add an entry of a port to telemetry. */
+void
+sppwk_telemetry_add_port(struct sppwk_telemetry *tm,
+		enum port_type iface_type, int iface_no, int ethdev_port_id)
+{
+	struct sppwk_telemetry_port *port;
+
+	if (unlikely(tm->nof_ports >= RTE_MAX_ETHPORTS))
+		return;
+
+	port = &tm->ports[tm->nof_ports++];
+	sppwk_port_uid(port->uid, iface_type, iface_no);
+	port->ethdev_port_id = ethdev_port_id;
+	if (ethdev_port_id >= 0)
+		sppwk_sum_port_cnts(ethdev_port_id, &port->cnts);
+	else
+		memset(&port->cnts, 0x00, sizeof(port->cnts));
+}
+
+/* Add an entry of a component to telemetry. */
+void
+sppwk_telemetry_add_comp(struct sppwk_telemetry *tm,
+		const char *name, const char *type, unsigned int lcore_id,
+		const struct poll_cycles *cycles)
+{
+	struct sppwk_telemetry_comp *comp;
+
+	if (unlikely(tm->nof_comps >= RTE_MAX_LCORE))
+		return;
+
+	comp = &tm->comps[tm->nof_comps++];
+	memset(comp, 0x00, sizeof(*comp));
+	strncpy(comp->name, name, STR_LEN_NAME - 1);
+	strncpy(comp->type, type, STR_LEN_SHORT - 1);
+	comp->lcore_id = lcore_id;
+	if (cycles != NULL) {
+		comp->busy_cycles = cycles->busy;
+		comp->idle_cycles = cycles->idle;
+		comp->pkts = cycles->pkts;
+	}
+}
+
+/* Add counters of worker lcores to telemetry. */
+static void
+add_lcores(struct sppwk_telemetry *tm)
+{
+	unsigned int lcore_id;
+	struct sppwk_telemetry_lcore *lcore;
+	const struct sppwk_lcore_cnts *cnts;
+
+	tm->nof_lcores = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		cnts = &g_sppwk_lcore_cnts[lcore_id];
+		lcore = &tm->lcores[tm->nof_lcores++];
+		lcore->lcore_id = lcore_id;
+		lcore->cls_miss = cnts->cls_miss;
+		lcore->mcast_fanout = cnts->mcast_fanout;
+		lcore->busy_cycles = cnts->cycles.busy;
+		lcore->idle_cycles = cnts->cycles.idle;
+		lcore->pkts = cnts->cycles.pkts;
+	}
+}
+
+/* Add histograms of latency of rings of which probe was turned on. */
+static void
+add_ring_latency(struct sppwk_telemetry *tm)
+{
+	int ring_id;
+	struct sppwk_telemetry_ring_lat *ring;
+
+	tm->nof_rings = 0;
+	for (ring_id = 0; ring_id < RTE_MAX_ETHPORTS; ring_id++) {
+		ring = &tm->rings[tm->nof_rings];
+		if (sppwk_get_ring_latency_stats(ring_id, &ring->stats) !=
+				SPPWK_RET_OK)
+			continue;
+		ring->ring_id = ring_id;
+		tm->nof_rings++;
+	}
+}
+
+/* Update telemetry if the interval is passed from the last update. */
+void
+sppwk_telemetry_update(sppwk_telemetry_fill fill)
+{
+	struct sppwk_telemetry *tm = g_telemetry;
+	uint64_t now;
+
+	if (unlikely(tm == NULL))
+		return;
+
+	now = rte_get_tsc_cycles();
+	if (now - g_telemetry_last_tsc < g_telemetry_intvl)
+		return;
+	g_telemetry_last_tsc = now;
+
+	tm->seq++;
+	rte_smp_wmb();
+
+	tm->nof_ports = 0;
+	tm->nof_comps = 0;
+	if (fill != NULL)
+		fill(tm);
+	add_lcores(tm);
+	add_ring_latency(tm);
+	tm->update_tsc = now;
+	tm->nof_updates++;
+
+	rte_smp_wmb();
+	tm->seq++;
+}
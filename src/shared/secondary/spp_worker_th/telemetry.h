@@ -0,0 +1,160 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SPPWK_TELEMETRY_H__
+#define __SPPWK_TELEMETRY_H__
+
+/**
+ * @file
+ * SPP worker telemetry
+ *
+ * Each of secondary processes publishes its counters to a memzone named
+ * `spp_telemetry_<client_id>` so that other processes can read them without
+ * sending `status` command via spp-ctl. The memzone is updated periodically
+ * by the master thread while it waits for commands, so worker lcores do
+ * nothing for it other than counting packets. Contents of the memzone is
+ * protected with a sequence lock. The writer makes `seq` odd while updating,
+ * and readers retry if it is odd or changed during reading.
+ */
+
+#include <rte_atomic.h>
+#include <rte_pause.h>
+#include "port_stats.h"
+#include "latency_stats.h"
+
+#define SPPWK_TELEMETRY_MZ_NAME "spp_telemetry_%d"
+#define SPPWK_TELEMETRY_MAGIC 0x53505054  /* "SPPT" */
+
+/* Incremented if layout of `struct sppwk_telemetry` is changed. */
+#define SPPWK_TELEMETRY_VERSION 3
+
+/* Interval of updating the memzone in micro sec. */
+#ifndef SPPWK_TELEMETRY_INTERVAL
+#define SPPWK_TELEMETRY_INTERVAL 1000
+#endif
+
+/* Counters of a port. */
+struct sppwk_telemetry_port {
+	char uid[STR_LEN_SHORT];  /**< Port UID such as `phy:0`. */
+	int ethdev_port_id;  /**< Etherdev ID. */
+	struct sppwk_port_cnts cnts;  /**< Summed up counters of lcores. */
+};
+
+/* Attributes of a component. */
+struct sppwk_telemetry_comp {
+	char name[STR_LEN_NAME];  /**< Component name. */
+	char type[STR_LEN_SHORT];  /**< Type such as `forward`. */
+	unsigned int lcore_id;  /**< Lcore the component is run on. */
+	uint64_t busy_cycles;  /**< Cycles of polls receiving packets. */
+	uint64_t idle_cycles;  /**< Cycles of empty polls. */
+	uint64_t pkts;  /**< Packets received in busy polls. */
+};
+
+/* Counters of a worker lcore. */
+struct sppwk_telemetry_lcore {
+	unsigned int lcore_id;
+	uint64_t cls_miss;  /**< Packets of no destination in classifier. */
+	uint64_t mcast_fanout;  /**< Multicast packets pushed to ports. */
+	uint64_t busy_cycles;  /**< Cycles of polls receiving packets. */
+	uint64_t idle_cycles;  /**< Cycles of empty polls. */
+	uint64_t pkts;  /**< Packets received in busy polls. */
+};
+
+/* Histogram of latency of a ring in cycles of `tsc_hz`. */
+struct sppwk_telemetry_ring_lat {
+	int ring_id;
+	struct lat_hist stats;  /**< Merged from all lcores. */
+};
+
+/* Layout of the memzone. */
+struct sppwk_telemetry {
+	uint32_t magic;  /**< SPPWK_TELEMETRY_MAGIC. */
+	uint32_t version;  /**< SPPWK_TELEMETRY_VERSION. */
+	uint32_t size;  /**< Size of this struct, depends on DPDK config. */
+	volatile uint32_t seq;  /**< Sequence lock, odd while updating. */
+	int client_id;
+	char proc_type[STR_LEN_SHORT];  /**< `vf`, `mirror` or `pcap`. */
+	uint64_t tsc_hz;  /**< Frequency of TSC for `update_tsc`. */
+	uint64_t update_tsc;  /**< TSC of last update. */
+	uint64_t nof_updates;
+	int nof_ports;
+	int nof_comps;
+	int nof_lcores;
+	int nof_rings;
+	struct sppwk_telemetry_port ports[RTE_MAX_ETHPORTS];
+	struct sppwk_telemetry_comp comps[RTE_MAX_LCORE];
+	struct sppwk_telemetry_lcore lcores[RTE_MAX_LCORE];
+	struct sppwk_telemetry_ring_lat rings[RTE_MAX_ETHPORTS];
+} __rte_cache_aligned;
+
+/**
+ * Func for adding ports and components of each of processes to telemetry.
+ * It is called while the sequence lock is taken.
+ */
+typedef void (*sppwk_telemetry_fill)(struct sppwk_telemetry *tm);
+
+/* Start reading, and return sequence to be checked at the end. */
+static inline uint32_t
+sppwk_telemetry_read_begin(const struct sppwk_telemetry *tm)
+{
+	uint32_t seq;
+
+	while ((seq = tm->seq) & 1)
+		rte_pause();
+	rte_smp_rmb();
+	return seq;
+}
+
+/* Return 1 if the memzone is updated while reading, or 0 if not. */
+static inline int
+sppwk_telemetry_read_retry(const struct sppwk_telemetry *tm, uint32_t seq)
+{
+	rte_smp_rmb();
+	return tm->seq != seq;
+}
+
+/**
+ * Reserve the memzone of telemetry, or lookup it if it is remained by the
+ * process of the same client ID terminated before.
+ *
+ * @param[in] client_id Client ID of the process.
+ * @param[in] proc_type Type of the process such as `vf`.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_telemetry_init(int client_id, const char *proc_type);
+
+/**
+ * Add an entry of a port to telemetry.
+ *
+ * @param[in,out] tm Telemetry to be updated.
+ * @param[in] iface_type Type of the port.
+ * @param[in] iface_no Interface number of the port.
+ * @param[in] ethdev_port_id Etherdev ID of the port.
+ */
+void sppwk_telemetry_add_port(struct sppwk_telemetry *tm,
+		enum port_type iface_type, int iface_no, int ethdev_port_id);
+
+/**
+ * Add an entry of a component to telemetry.
+ *
+ * @param[in,out] tm Telemetry to be updated.
+ * @param[in] name Name of the component.
+ * @param[in] type Type of the component.
+ * @param[in] lcore_id Lcore the component is run on.
+ * @param[in] cycles Cycles of the component, or NULL if not counted.
+ */
+void sppwk_telemetry_add_comp(struct sppwk_telemetry *tm,
+		const char *name, const char *type, unsigned int lcore_id,
+		const struct poll_cycles *cycles);
+
+/**
+ * Update telemetry if the interval is passed from the last update. It is
+ * expected to be called from the loop of master thread.
+ *
+ * @param[in] fill Func for adding ports and components.
+ */
+void sppwk_telemetry_update(sppwk_telemetry_fill fill);
+
+#endif /* __SPPWK_TELEMETRY_H__ */
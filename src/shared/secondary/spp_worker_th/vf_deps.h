@@ -7,6 +7,7 @@
 
 #include <rte_malloc.h>
 #include <rte_hash.h>
+#include <rte_acl.h>
 #include "cmd_utils.h"
 #include "cmd_parser.h"
 #include "cmd_res_formatter.h"
@@ -18,14 +19,29 @@
 #define NOF_VLAN 4096
 
 /* Num of entries of ops_list in vf_cmd_runner.c. */
-#define NOF_STAT_OPS 8
+#define NOF_STAT_OPS 16
+
+/* Num of words of bitmap for VLAN IDs. */
+#define NOF_VLAN_WORDS (NOF_VLAN / 64)
 
 /* Classifier for MAC addresses. */
 struct mac_classifier {
 	struct rte_hash *cls_tbl;  /* Hash table for MAC classification. */
+	int default_cls_idx;  /* Default index for classification. */
 	int nof_cls_ports;  /* Num of ports classified validly. */
+	uint16_t vid;  /* VLAN ID of this classifier. */
+	uint32_t capacity;  /* Max num of entries of cls_tbl. */
 	int cls_ports[RTE_MAX_ETHPORTS];  /* Ports for classification. */
-	int default_cls_idx;  /* Default index for classification. */
+} __rte_cache_aligned;
+
+/**
+ * A word of bitmap of VLAN IDs which have a classifier. `rank` is the num of
+ * bits set in preceding words and used for getting the index of classifier
+ * in dense array `mac_clfs` of `cls_comp_info` with popcount of this word.
+ */
+struct cls_vlan_bitmap {
+	uint64_t bits;  /* Bits of VLAN IDs from 64 * index of this word. */
+	uint16_t rank;  /* Num of bits set in preceding words. */
 };
 
 /* Attirbutes of port for classification. */
@@ -35,15 +51,28 @@ struct cls_port_info {
 	int iface_no;   /* Index of ports handled by classifier. */
 	int iface_no_global;  /* ID for interface generated by spp_vf */
 	uint16_t ethdev_port_id;  /* Ethdev port ID. */
+	uint16_t queue_id;  /* RX or TX queue bound to classifier. */
+	struct sppwk_tx_queue txq;  /* TX queue used by the lcore. */
 	uint16_t nof_pkts;  /* Number of packets in pkts[]. */
+	uint16_t flush_thresh;  /* Num of packets in pkts[] to be transmitted. */
 	struct rte_mbuf *pkts[MAX_PKT_BURST];  /* packets to be classified. */
 };
 
-/* classifier component information */
+/**
+ * classifier component information. Classifiers are stored only for
+ * configured VLANs in dense array `mac_clfs` in order of VLAN ID, and
+ * looked up via bitmap `vlan_map`. Because a classifier is registered for a
+ * TX port at most, the num of classifiers is up to RTE_MAX_ETHPORTS.
+ */
 struct cls_comp_info {
 	char name[STR_LEN_NAME];  /* component name */
 	int mac_addr_entry;  /* mac address entry flag */
-	struct mac_classifier *mac_clfs[NOF_VLAN];  /* classifiers per VLAN. */
+	int socket_id;  /* Socket of lcore referring tables. */
+	int nof_mac_clfs;  /* Num of classifiers in mac_clfs. */
+	struct cls_vlan_bitmap vlan_map[NOF_VLAN_WORDS];  /* VLANs registered. */
+	struct mac_classifier mac_clfs[RTE_MAX_ETHPORTS];  /* Dense array. */
+	/* ACL of flow rules for IPv4 and IPv6, replaced while running. */
+	struct rte_acl_ctx *flow_acls[2];
 	int nof_tx_ports;  /* Number of TX ports info entries. */
 	/* Classifier has one RX port and several TX ports. */
 	struct cls_port_info rx_port_i;  /* RX port info classified. */
@@ -53,15 +82,13 @@ struct cls_comp_info {
 int add_core(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
 
-/* Release instance of mac classifier. */
+/* Release hash table of mac classifier. */
 static inline void
 free_mac_classifier(struct mac_classifier *mac_clf)
 {
-	if (mac_clf == NULL)
-		return;
 	if (mac_clf->cls_tbl != NULL)
 		rte_hash_free(mac_clf->cls_tbl);
-	rte_free(mac_clf);
+	mac_clf->cls_tbl = NULL;
 }
 
 int exec_one_cmd(const struct sppwk_cmd_attrs *cmd);
@@ -84,6 +111,15 @@ int update_classifier(struct sppwk_comp_info *wk_comp_info);
  */
 int update_forwarder(struct sppwk_comp_info *wk_comp_info);
 
+/**
+ * Update load balancer info.
+ *
+ * @param wk_comp_info Pointer to data of load balancer.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_load_balancer(struct sppwk_comp_info *wk_comp_info);
+
 void init_classifier_info(int component_id);
 
 /**
@@ -10,6 +10,7 @@
 
 int client_id;
 int vhost_cli;
+int vhost_nof_queues = 1;
 
 int set_client_id(int cid)
 {
@@ -46,6 +47,22 @@ int get_vhost_cli_mode(void)
 	return vhost_cli;
 }
 
+int set_vhost_nof_queues(int nof_queues)
+{
+	if (nof_queues < 1 || nof_queues > VHOST_NOF_QUEUES_MAX) {
+		RTE_LOG(ERR, SHARED, "Invalid num of vhost queues %d.\n",
+				nof_queues);
+		return -1;
+	}
+	vhost_nof_queues = nof_queues;
+	return 0;
+}
+
+int get_vhost_nof_queues(void)
+{
+	return vhost_nof_queues;
+}
+
 /* Parse client ID from given value of string. */
 int
 parse_client_id(int *cli_id, const char *cli_id_str)
@@ -39,6 +39,24 @@ int set_vhost_cli_mode(int vhost_cli);
  */
 int get_vhost_cli_mode(void);
 
+/* Max num of queue pairs of vhost PMD. */
+#define VHOST_NOF_QUEUES_MAX 128
+
+/**
+ * Set num of RX and TX queues of vhost port from given command argument.
+ *
+ * @params[in] nof_queues Num of queues, 1 to VHOST_NOF_QUEUES_MAX.
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int set_vhost_nof_queues(int nof_queues);
+
+/**
+ * Get num of RX and TX queues of vhost port, 1 if not set.
+ *
+ * @return Num of queues.
+ */
+int get_vhost_nof_queues(void);
+
 /**
  * Parse client ID from given value of string.
  *
@@ -172,6 +172,11 @@ class Controller(object):
     def get_cpu_usage(self):
         """Get cpu usage from each of status of SPP processes.
 
+        Busy and idle cycles of polling of each of worker lcores are
+        included as 'lcore_cycles' if the process counts them. Poll is
+        busy if it receives packets. Cycles are accumulated from the
+        launch, so take difference of two results to get recent usage.
+
         If process returns invalid message or cannot connect, remove
         it from `self.procs` as in _update_procs().
         """
@@ -184,30 +189,37 @@ class Controller(object):
                 # to except block.
                 stat = proc.get_status()
                 if proc.id == spp_proc.ID_PRIMARY:
-                    cpus.append(
-                            {'proc-type': proc.type,
-                                'master-lcore': stat['lcores'][0],
-                                'lcores': stat['lcores']})
+                    cpu = {'proc-type': proc.type,
+                           'master-lcore': stat['lcores'][0],
+                           'lcores': stat['lcores']}
                 elif proc.type == 'nfv':
-                    cpus.append(
-                            {'proc-type': proc.type,
-                                'client-id': proc.id,
-                                'master-lcore': stat['master-lcore'],
-                                'lcores': stat['lcores']})
+                    cpu = {'proc-type': proc.type,
+                           'client-id': proc.id,
+                           'master-lcore': stat['master-lcore'],
+                           'lcores': stat['lcores']}
                 elif proc.type in ['vf', 'mirror', 'pcap']:
                     master_lcore = stat['info']['master-lcore']
                     lcores = [stat['info']['master-lcore']]
                     # TODO(yasufum) revise tag name 'core'.
                     for val in stat['info']['core']:
                         lcores.append(val['core'])
-                    cpus.append(
-                            {'proc-type': proc.type,
-                                'client-id': proc.id,
-                                'master-lcore': master_lcore,
-                                'lcores': lcores})
+                    cpu = {'proc-type': proc.type,
+                           'client-id': proc.id,
+                           'master-lcore': master_lcore,
+                           'lcores': lcores}
+                    stat = stat['info']
                 else:
+                    cpu = None
+
+                if cpu is None:
                     LOG.debug('No supported proc type: {}'.format(
-                        roc.type))
+                        proc.type))
+                else:
+                    if 'lcore_cycles' in stat:
+                        cpu['lcore_cycles'] = stat['lcore_cycles']
+                    if 'comp_cycles' in stat:
+                        cpu['comp_cycles'] = stat['comp_cycles']
+                    cpus.append(cpu)
 
             except Exception as e:
                 LOG.error("get_cpu_usage: {}".format(e))
@@ -86,7 +86,8 @@ APP_OPTS = {
             '-s',  # address and port
             '-c',  # captured port
             '--out-dir',  # captured file dir
-            '--fsize'  # max size of captured file
+            '--fsize',  # max size of captured file
+            '--dist'  # distributing packets to writers
             ]}
 
 
@@ -166,9 +167,13 @@ class VfCommon(SppProc):
         return "status"
 
     @exec_command
-    def start_component(self, comp_name, core_id, comp_type):
-        return ("component start {comp_name} {core_id} {comp_type}"
-                .format(**locals()))
+    def start_component(self, comp_name, core_id, comp_type,
+                        table_size=None):
+        cmd = ("component start {comp_name} {core_id} {comp_type}"
+               .format(**locals()))
+        if table_size is not None:
+            cmd += " {}".format(table_size)
+        return cmd
 
     @exec_command
     def stop_component(self, comp_name):
@@ -178,6 +183,14 @@ class VfCommon(SppProc):
     def port_del(self, port, direction, comp_name):
         return "port del {port} {direction} {comp_name}".format(**locals())
 
+    @exec_command
+    def set_lat_probe(self, action, target):
+        return "latency_probe {action} {target}".format(**locals())
+
+    @exec_command
+    def set_chain_trace(self, action):
+        return "chain_trace {action}".format(**locals())
+
     @exec_command
     def do_exit(self):
         return "exit"
@@ -193,12 +206,17 @@ class VfProc(VfCommon):
         return SppProc._decode_client_id_common(data, TYPE_VF)
 
     @exec_command
-    def port_add(self, port, direction, comp_name, op, vlan_id, pcp):
+    def port_add(self, port, direction, comp_name, op, vlan_id, pcp,
+                 tpid=None):
         command = "port add {port} {direction} {comp_name}".format(**locals())
         if op != "none":
             command += " %s" % op
-            if op == "add_vlantag":
+            if op in ["add_vlantag", "add_stag"]:
                 command += " %d %d" % (vlan_id, pcp)
+            if op == "add_stag" and tpid is not None:
+                command += " %s" % tpid
+            elif op == "set_pcp":
+                command += " %d" % pcp
         return command
 
     @exec_command
@@ -223,6 +241,35 @@ class VfProc(VfCommon):
         return ("classifier_table del vlan {vlan_id} {mac_address} {port}"
                 .format(**locals()))
 
+    @exec_command
+    def set_classifier_table_with_flow(self, flow_rules, port):
+        return ("classifier_table add flow {flow_rules} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def clear_classifier_table_with_flow(self, flow_rules, port):
+        return ("classifier_table del flow {flow_rules} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def set_lb_hash(self, comp_name, hash_type):
+        return ("lb_table {comp_name} hash {hash_type}"
+                .format(**locals()))
+
+    @exec_command
+    def set_lb_weight(self, comp_name, port, weight):
+        return ("lb_table {comp_name} weight {port} {weight}"
+                .format(**locals()))
+
+    @exec_command
+    def set_lb_reta(self, comp_name, first, last, port):
+        return ("lb_table {comp_name} reta {first} {last} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def set_flush_thresh(self, port, thresh):
+        return "flush_thresh {port} {thresh}".format(**locals())
+
 
 class MirrorProc(VfCommon):
 
@@ -237,6 +284,11 @@ class MirrorProc(VfCommon):
     def port_add(self, port, direction, comp_name):
         return "port add {port} {direction} {comp_name}".format(**locals())
 
+    @exec_command
+    def set_mirror_table(self, comp_name, opt, value):
+        return ("mirror_table {comp_name} {opt} {value}"
+                .format(**locals()))
+
 
 class NfvProc(SppProc):
 
@@ -275,6 +327,10 @@ class NfvProc(SppProc):
     def stop(self):
         return "stop"
 
+    @exec_command
+    def set_chain_trace(self, action):
+        return "chain_trace {action}".format(**locals())
+
     @exec_command
     def do_exit(self):
         return "exit"
@@ -17,6 +17,18 @@ PORT_TYPES = ["phy", "vhost", "ring", "pcap", "nullpmd", "tap"]
 VF_PORT_TYPES = ["phy", "vhost", "ring"]
 # TODO(yasufum) consider PCAP_PORT_TYPES is required.
 
+# Max weight of TX port of load balancer of spp_vf.
+LB_WEIGHT_MAX = 100
+LB_RETA_SIZE = 128
+FLUSH_THRESH_MAX = 32  # MAX_PKT_BURST of spp_vf
+
+# Copy modes and max values of options of spp_mirror.
+MIR_COPY_MODES = ["shallow", "deep", "header"]
+MIR_POLICIES = ["drop_mirror", "keep_original", "block"]
+MIR_SAMPLE_MAX = 1000000
+MIR_RATE_MAX = 100000000
+MIR_SNAPLEN_MAX = 65535
+
 LOG = logging.getLogger(__name__)
 
 
@@ -50,15 +62,26 @@ class BaseHandler(bottle.Bottle):
         res.content_type = "text/plain"
         return res.body
 
-    def _validate_port(self, port):
+    def _validate_port(self, port, allow_queue=False):
         try:
-            if_type, if_num = port.split(":")
+            # Queue can be given as 'phy:0:1' if allowed.
+            items = port.split(":")
+            if len(items) == 3 and allow_queue:
+                if int(items.pop()) < 0:
+                    raise
+            if_type, if_num = items
             if if_type not in PORT_TYPES:
                 raise
             int(if_num)
         except Exception:
             raise KeyInvalid('port', port)
 
+    def _validate_chain_trace(self, body):
+        if 'action' not in body:
+            raise KeyRequired('action')
+        if body['action'] not in ["on", "off"]:
+            raise KeyInvalid('action', body['action'])
+
     def log_url(self):
         LOG.info("%s %s called", bottle.request.method, bottle.request.path)
 
@@ -186,6 +209,28 @@ class V1VFCommon(object):
         vf["components"] = info["core"]
         if "classifier_table" in info:
             vf["classifier_table"] = info["classifier_table"]
+        if "classifier_table_usage" in info:
+            vf["classifier_table_usage"] = info["classifier_table_usage"]
+        if "lb_table" in info:
+            vf["lb_table"] = info["lb_table"]
+        if "mirror_table" in info:
+            vf["mirror_table"] = info["mirror_table"]
+        if "mirror_ports" in info:
+            vf["mirror_ports"] = info["mirror_ports"]
+        if "mirror_pool" in info:
+            vf["mirror_pool"] = info["mirror_pool"]
+        if "port_stats" in info:
+            vf["port_stats"] = info["port_stats"]
+        if "lcore_stats" in info:
+            vf["lcore_stats"] = info["lcore_stats"]
+        if "lcore_cycles" in info:
+            vf["lcore_cycles"] = info["lcore_cycles"]
+        if "comp_cycles" in info:
+            vf["comp_cycles"] = info["comp_cycles"]
+        if "ring_latency" in info:
+            vf["ring_latency"] = info["ring_latency"]
+        if "chain_latency" in info:
+            vf["chain_latency"] = info["chain_latency"]
 
         return vf
 
@@ -208,7 +253,30 @@ class V1VFCommon(object):
             raise KeyInvalid('action', body['action'])
         if body['dir'] not in ["rx", "tx"]:
             raise KeyInvalid('dir', body['dir'])
-        self._validate_port(body['port'])
+        self._validate_port(body['port'], allow_queue=True)
+
+    def validate_lat_probe(self, body):
+        if 'action' not in body:
+            raise KeyRequired('action')
+        if body['action'] not in ["on", "off"]:
+            raise KeyInvalid('action', body['action'])
+        if 'port' in body:
+            self._validate_port(body['port'])
+            if not body['port'].startswith("ring:"):
+                raise KeyInvalid('port', body['port'])
+        elif 'name' in body:
+            if not isinstance(body['name'], str):
+                raise KeyInvalid('name', body['name'])
+        else:
+            raise KeyRequired('port')
+
+    def vf_lat_probe(self, proc, body):
+        self.validate_lat_probe(body)
+        proc.set_lat_probe(body['action'], body.get('port', body.get('name')))
+
+    def vf_chain_trace(self, proc, body):
+        self._validate_chain_trace(body)
+        proc.set_chain_trace(body['action'])
 
     def vf_exit(self, proc):
         self.ctrl.do_exit(proc.type, proc.id)
@@ -238,13 +306,29 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                    callback=self.vf_comp_port)
         self.route('/<sec_id:int>/classifier_table', 'PUT',
                    callback=self.vf_classifier)
+        self.route('/<sec_id:int>/components/<name>/lb_table', 'PUT',
+                   callback=self.vf_lb_table)
+        self.route('/<sec_id:int>/latency_probe', 'PUT',
+                   callback=self.vf_lat_probe)
+        self.route('/<sec_id:int>/chain_trace', 'PUT',
+                   callback=self.vf_chain_trace)
+        self.route('/<sec_id:int>/flush_thresh', 'PUT',
+                   callback=self.vf_flush_thresh)
 
     def vf_get(self, proc):
         return self.convert_info(proc.get_status())
 
     def vf_comp_start(self, proc, body):
-        self.validate_comp_start(body, ["forward", "merge", "classifier"])
-        proc.start_component(body['name'], body['core'], body['type'])
+        self.validate_comp_start(body, ["forward", "merge", "classifier",
+                                        "load_balancer"])
+        table_size = body.get('table_size')
+        if table_size is not None:
+            if body['type'] != "classifier":
+                raise KeyInvalid('table_size', table_size)
+            if not isinstance(table_size, int) or table_size <= 0:
+                raise KeyInvalid('table_size', table_size)
+        proc.start_component(body['name'], body['core'], body['type'],
+                             table_size)
 
     def vf_comp_stop(self, proc, name):
         proc.stop_component(name)
@@ -255,11 +339,17 @@ class V1VFHandler(BaseHandler, V1VFCommon):
             vlan = body.get('vlan')
             if vlan:
                 try:
-                    if vlan['operation'] not in ["none", "add", "del"]:
+                    if vlan['operation'] not in ["none", "add", "del",
+                                                 "add_stag", "set_pcp"]:
                         raise
-                    if vlan['operation'] == "add":
+                    if vlan['operation'] in ["add", "add_stag"]:
                         int(vlan['id'])
                         int(vlan['pcp'])
+                    if vlan['operation'] == "set_pcp":
+                        int(vlan['pcp'])
+                    if vlan['operation'] == "add_stag" and \
+                            vlan.get('tpid') is not None:
+                        int(str(vlan['tpid']), 0)
                 except Exception:
                     raise KeyInvalid('vlan', vlan)
 
@@ -270,6 +360,7 @@ class V1VFHandler(BaseHandler, V1VFCommon):
             op = "none"
             vlan_id = 0
             pcp = 0
+            tpid = None
             vlan = body.get('vlan')
             if vlan:
                 if vlan['operation'] == "add":
@@ -278,8 +369,16 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                     pcp = vlan['pcp']
                 elif vlan['operation'] == "del":
                     op = "del_vlantag"
+                elif vlan['operation'] == "add_stag":
+                    op = "add_stag"
+                    vlan_id = vlan['id']
+                    pcp = vlan['pcp']
+                    tpid = vlan.get('tpid')
+                elif vlan['operation'] == "set_pcp":
+                    op = "set_pcp"
+                    pcp = vlan['pcp']
             proc.port_add(body['port'], body['dir'],
-                          name, op, vlan_id, pcp)
+                          name, op, vlan_id, pcp, tpid)
         else:
             proc.port_del(body['port'], body['dir'], name)
 
@@ -290,15 +389,27 @@ class V1VFHandler(BaseHandler, V1VFCommon):
             raise KeyInvalid('mac_address', mac_address)
 
     def _validate_vf_classifier(self, body):
-        for key in ['action', 'type', 'port', 'mac_address']:
+        for key in ['action', 'type', 'port']:
             if key not in body:
                 raise KeyRequired(key)
         if body['action'] not in ["add", "del"]:
             raise KeyInvalid('action', body['action'])
-        if body['type'] not in ["mac", "vlan"]:
+        if body['type'] not in ["mac", "vlan", "flow"]:
             raise KeyInvalid('type', body['type'])
         self._validate_port(body['port'])
 
+        # Flow rules are validated in spp_vf.
+        if body['type'] == "flow":
+            if 'flow_rules' not in body:
+                raise KeyRequired('flow_rules')
+            if (not isinstance(body['flow_rules'], str) or
+                    len(body['flow_rules'].split()) != 1):
+                raise KeyInvalid('flow_rules', body['flow_rules'])
+            return
+
+        if 'mac_address' not in body:
+            raise KeyRequired('mac_address')
+
         if not body['mac_address'] == 'default':
             self._validate_mac(body['mac_address'])
 
@@ -312,6 +423,15 @@ class V1VFHandler(BaseHandler, V1VFCommon):
         self._validate_vf_classifier(body)
 
         port = body['port']
+
+        if body['type'] == "flow":
+            if body['action'] == "add":
+                proc.set_classifier_table_with_flow(body['flow_rules'], port)
+            else:
+                proc.clear_classifier_table_with_flow(body['flow_rules'],
+                                                      port)
+            return
+
         mac_address = body['mac_address']
 
         if body['action'] == "add":
@@ -328,6 +448,55 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                     mac_address, port, body['vlan'])
 
 
+    def _validate_vf_lb_table(self, body):
+        if 'hash' not in body and 'port' not in body:
+            raise KeyRequired('hash')
+        if 'hash' in body and body['hash'] not in ["toeplitz", "crc"]:
+            raise KeyInvalid('hash', body['hash'])
+        if 'port' in body and 'reta' in body:
+            reta = body['reta']
+            if (not isinstance(reta, list) or len(reta) != 2 or
+                    not all(isinstance(i, int) for i in reta) or
+                    reta[0] < 0 or reta[0] > reta[1] or
+                    reta[1] >= LB_RETA_SIZE):
+                raise KeyInvalid('reta', reta)
+            if body['port'] != 'none':
+                self._validate_port(body['port'])
+        elif 'port' in body:
+            self._validate_port(body['port'])
+            if 'weight' not in body:
+                raise KeyRequired('weight')
+            weight = body['weight']
+            if (not isinstance(weight, int) or
+                    weight < 0 or weight > LB_WEIGHT_MAX):
+                raise KeyInvalid('weight', weight)
+
+    def vf_lb_table(self, proc, name, body):
+        self._validate_vf_lb_table(body)
+
+        if 'hash' in body:
+            proc.set_lb_hash(name, body['hash'])
+        if 'port' in body and 'reta' in body:
+            proc.set_lb_reta(name, body['reta'][0], body['reta'][1],
+                             body['port'])
+        elif 'port' in body:
+            proc.set_lb_weight(name, body['port'], body['weight'])
+
+    def _validate_vf_flush_thresh(self, body):
+        for key in ['port', 'thresh']:
+            if key not in body:
+                raise KeyRequired(key)
+        self._validate_port(body['port'])
+        thresh = body['thresh']
+        if (not isinstance(thresh, int) or
+                thresh < 1 or thresh > FLUSH_THRESH_MAX):
+            raise KeyInvalid('thresh', thresh)
+
+    def vf_flush_thresh(self, proc, body):
+        self._validate_vf_flush_thresh(body)
+        proc.set_flush_thresh(body['port'], body['thresh'])
+
+
 class V1MirrorHandler(BaseHandler, V1VFCommon):
 
     def __init__(self, controller):
@@ -349,6 +518,12 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
                    callback=self.mirror_comp_stop)
         self.route('/<sec_id:int>/components/<name>/ports', 'PUT',
                    callback=self.mirror_comp_port)
+        self.route('/<sec_id:int>/components/<name>/mirror_table', 'PUT',
+                   callback=self.mirror_table)
+        self.route('/<sec_id:int>/latency_probe', 'PUT',
+                   callback=self.vf_lat_probe)
+        self.route('/<sec_id:int>/chain_trace', 'PUT',
+                   callback=self.vf_chain_trace)
 
     def mirror_get(self, proc):
         return self.convert_info(proc.get_status())
@@ -367,6 +542,33 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
         else:
             proc.port_del(body['port'], body['dir'], name)
 
+    def _validate_mirror_table(self, body):
+        opts = ['copy', 'filter', 'sample', 'rate', 'snaplen', 'policy']
+        if not any(opt in body for opt in opts):
+            raise KeyRequired('copy')
+        if 'copy' in body and body['copy'] not in MIR_COPY_MODES:
+            raise KeyInvalid('copy', body['copy'])
+        if 'policy' in body and body['policy'] not in MIR_POLICIES:
+            raise KeyInvalid('policy', body['policy'])
+        if 'filter' in body:
+            if (not isinstance(body['filter'], str) or
+                    body['filter'] == '' or ' ' in body['filter']):
+                raise KeyInvalid('filter', body['filter'])
+        for opt, vmin, vmax in [('sample', 1, MIR_SAMPLE_MAX),
+                                ('rate', 0, MIR_RATE_MAX),
+                                ('snaplen', 0, MIR_SNAPLEN_MAX)]:
+            if opt in body:
+                val = body[opt]
+                if not isinstance(val, int) or val < vmin or val > vmax:
+                    raise KeyInvalid(opt, val)
+
+    def mirror_table(self, proc, name, body):
+        self._validate_mirror_table(body)
+        for opt in ['filter', 'sample', 'rate', 'snaplen', 'policy',
+                    'copy']:
+            if opt in body:
+                proc.set_mirror_table(name, opt, body[opt])
+
 
 class V1NFVHandler(BaseHandler):
 
@@ -391,6 +593,8 @@ class V1NFVHandler(BaseHandler):
                    callback=self.nfv_patch_add)
         self.route('/<sec_id:int>/patches', 'DELETE',
                    callback=self.nfv_patch_del)
+        self.route('/<sec_id:int>/chain_trace', 'PUT',
+                   callback=self.nfv_chain_trace)
 
     def nfv_get(self, proc):
         return proc.get_status()
@@ -437,6 +641,10 @@ class V1NFVHandler(BaseHandler):
     def nfv_patch_del(self, proc):
         proc.patch_reset()
 
+    def nfv_chain_trace(self, proc, body):
+        self._validate_chain_trace(body)
+        proc.set_chain_trace(body['action'])
+
     def nfv_exit(self, proc):
         self.ctrl.do_exit(proc.type, proc.id)
         proc.do_exit()
@@ -0,0 +1,325 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+/**
+ * @file
+ * SPP telemetry reader
+ *
+ * Standalone secondary process which reads memzones of telemetry published
+ * by spp_vf, spp_mirror or spp_pcap, and counters of ports of the primary,
+ * without sending any request to processes. It prints a line for each of
+ * entries at every update of telemetry, so the output is expected to be
+ * processed by other tools.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_eal.h>
+#include <rte_cycles.h>
+#include <rte_memzone.h>
+#include <rte_log.h>
+
+#include "shared/common.h"
+#include "shared/secondary/spp_worker_th/telemetry.h"
+
+#define RTE_LOGTYPE_SPP_TELEMETRY RTE_LOGTYPE_USER1
+
+#define DEFAULT_INTERVAL 1000  /* micro sec, 1kHz */
+
+/* getopt_long return value for long option */
+enum SPP_LONGOPT_RETVAL {
+	SPP_LONGOPT_RETVAL__ = 127,
+
+	SPP_LONGOPT_RETVAL_CLIENT_ID,  /* --client-id */
+	SPP_LONGOPT_RETVAL_INTERVAL,  /* --interval */
+	SPP_LONGOPT_RETVAL_COUNT,  /* --count */
+	SPP_LONGOPT_RETVAL_PRIMARY  /* --primary */
+};
+
+/* Memzone of a process and the last update read from it. */
+struct tm_source {
+	int client_id;
+	const struct sppwk_telemetry *tm;  /* NULL if not found yet. */
+	uint64_t last_update;
+};
+
+static struct tm_source g_sources[MAX_CLIENT];
+static int g_nof_sources;
+static unsigned int g_interval = DEFAULT_INTERVAL;
+static uint64_t g_count;  /* Num of samples, or 0 for infinite. */
+static int g_primary;  /* Read counters of the primary if 1. */
+
+/* Copy of telemetry taken while seq is not changed. */
+static struct sppwk_telemetry g_snapshot;
+
+static volatile int g_quit;
+
+static void
+stop_process(int signal __rte_unused)
+{
+	g_quit = 1;
+}
+
+/* Print help message */
+static void
+usage(const char *progname)
+{
+	RTE_LOG(INFO, SPP_TELEMETRY, "Usage: %s [EAL args] --"
+			" --client-id CLIENT_ID [--client-id ...]"
+			" [--interval USEC] [--count NUM] [--primary]\n"
+			" --client-id CLIENT_ID : ID of process to be read\n"
+			" --interval USEC       :"
+			" Interval of reading (default %d)\n"
+			" --count NUM           :"
+			" Num of reading, or 0 for infinite (default 0)\n"
+			" --primary             :"
+			" Read counters of ports of the primary\n"
+			, progname, DEFAULT_INTERVAL);
+}
+
+/* Parse options of the reader. */
+static int
+parse_app_args(int argc, char *argv[])
+{
+	int option_index, opt;
+	char *endptr;
+	long val;
+	const char *progname = argv[0];
+
+	static struct option lgopts[] = {
+			{ "client-id", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_CLIENT_ID },
+			{ "interval", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_INTERVAL },
+			{ "count", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_COUNT },
+			{ "primary", no_argument, NULL,
+					SPP_LONGOPT_RETVAL_PRIMARY },
+			{ 0 },
+	};
+
+	optind = 0;
+	opterr = 0;
+	while ((opt = getopt_long(argc, argv, "", lgopts,
+			&option_index)) != EOF) {
+		switch (opt) {
+		case SPP_LONGOPT_RETVAL_PRIMARY:
+			g_primary = 1;
+			continue;
+		case SPP_LONGOPT_RETVAL_CLIENT_ID:
+		case SPP_LONGOPT_RETVAL_INTERVAL:
+		case SPP_LONGOPT_RETVAL_COUNT:
+			break;
+		default:
+			usage(progname);
+			return -1;
+		}
+
+		val = strtol(optarg, &endptr, 0);
+		if (*endptr != '\0' || val < 0) {
+			usage(progname);
+			return -1;
+		}
+
+		if (opt == SPP_LONGOPT_RETVAL_CLIENT_ID) {
+			if (g_nof_sources >= MAX_CLIENT) {
+				usage(progname);
+				return -1;
+			}
+			g_sources[g_nof_sources++].client_id = (int)val;
+		} else if (opt == SPP_LONGOPT_RETVAL_INTERVAL) {
+			if (val == 0) {
+				usage(progname);
+				return -1;
+			}
+			g_interval = (unsigned int)val;
+		} else {
+			g_count = (uint64_t)val;
+		}
+	}
+
+	if (g_nof_sources == 0 && g_primary == 0) {
+		usage(progname);
+		return -1;
+	}
+	return 0;
+}
+
+/* Lookup memzone of telemetry and check it is in the expected layout. */
+static const struct sppwk_telemetry *
+lookup_telemetry(int client_id)
+{
+	const struct rte_memzone *mz;
+	const struct sppwk_telemetry *tm;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+
+	snprintf(mz_name, sizeof(mz_name), SPPWK_TELEMETRY_MZ_NAME,
+			client_id);
+	mz = rte_memzone_lookup(mz_name);
+	if (mz == NULL)
+		return NULL;
+
+	tm = mz->addr;
+	if (tm->magic != SPPWK_TELEMETRY_MAGIC ||
+			tm->version != SPPWK_TELEMETRY_VERSION ||
+			tm->size != sizeof(struct sppwk_telemetry)) {
+		RTE_LOG(ERR, SPP_TELEMETRY,
+				"Unsupported telemetry `%s` "
+				"(ver=%u, size=%u).\n",
+				mz_name, tm->version, tm->size);
+		return NULL;
+	}
+	return tm;
+}
+
+/* Take a consistent copy of telemetry to `g_snapshot`. */
+static void
+read_telemetry(const struct sppwk_telemetry *tm)
+{
+	uint32_t seq;
+
+	do {
+		seq = sppwk_telemetry_read_begin(tm);
+		memcpy(&g_snapshot, tm, sizeof(struct sppwk_telemetry));
+	} while (sppwk_telemetry_read_retry(tm, seq));
+}
+
+/* Print entries of telemetry in `g_snapshot`. */
+static void
+print_telemetry(void)
+{
+	int i;
+	const struct sppwk_telemetry *tm = &g_snapshot;
+	const struct sppwk_telemetry_port *port;
+	const struct sppwk_telemetry_comp *comp;
+	const struct sppwk_telemetry_lcore *lcore;
+	const struct sppwk_telemetry_ring_lat *ring;
+	struct lat_summary summary;
+
+	for (i = 0; i < tm->nof_ports; i++) {
+		port = &tm->ports[i];
+		printf("%"PRIu64" %s:%d port %s rx=%"PRIu64
+				" rx_drop=%"PRIu64" rx_vlan_drop=%"PRIu64
+				" tx=%"PRIu64" tx_drop=%"PRIu64
+				" tx_vlan_drop=%"PRIu64"\n",
+				tm->update_tsc, tm->proc_type, tm->client_id,
+				port->uid, port->cnts.rx, port->cnts.rx_drop,
+				port->cnts.rx_vlan_drop, port->cnts.tx,
+				port->cnts.tx_drop, port->cnts.tx_vlan_drop);
+	}
+	for (i = 0; i < tm->nof_comps; i++) {
+		comp = &tm->comps[i];
+		printf("%"PRIu64" %s:%d comp %s type=%s core=%u"
+				" busy=%"PRIu64" idle=%"PRIu64
+				" pkts=%"PRIu64"\n",
+				tm->update_tsc, tm->proc_type, tm->client_id,
+				comp->name, comp->type, comp->lcore_id,
+				comp->busy_cycles, comp->idle_cycles,
+				comp->pkts);
+	}
+	for (i = 0; i < tm->nof_lcores; i++) {
+		lcore = &tm->lcores[i];
+		printf("%"PRIu64" %s:%d lcore %u cls_miss=%"PRIu64
+				" mcast_fanout=%"PRIu64" busy=%"PRIu64
+				" idle=%"PRIu64" pkts=%"PRIu64"\n",
+				tm->update_tsc, tm->proc_type, tm->client_id,
+				lcore->lcore_id, lcore->cls_miss,
+				lcore->mcast_fanout, lcore->busy_cycles,
+				lcore->idle_cycles, lcore->pkts);
+	}
+	for (i = 0; i < tm->nof_rings; i++) {
+		ring = &tm->rings[i];
+		lat_hist_summarize(&ring->stats, tm->tsc_hz,
+				&summary);
+		printf("%"PRIu64" %s:%d ring_latency ring:%d"
+				" count=%"PRIu64" p50=%"PRIu64
+				" p99=%"PRIu64" p999=%"PRIu64
+				" max=%"PRIu64"\n",
+				tm->update_tsc, tm->proc_type, tm->client_id,
+				ring->ring_id, summary.count, summary.p50,
+				summary.p99, summary.p999, summary.max);
+	}
+}
+
+/* Print counters of ports of the primary. */
+static void
+print_primary(const struct port_info *ports, uint64_t tsc)
+{
+	int i;
+
+	for (i = 0; i < ports->num_ports; i++) {
+		printf("%"PRIu64" primary port phy:%u rx=%"PRIu64
+				" rx_drop=%"PRIu64" tx=%"PRIu64
+				" tx_drop=%"PRIu64"\n",
+				tsc, ports->id[i],
+				ports->port_stats[i].rx,
+				ports->port_stats[i].rx_drop,
+				ports->port_stats[i].tx,
+				ports->port_stats[i].tx_drop);
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	int ret, i;
+	uint64_t nof_reads = 0;
+	const struct rte_memzone *mz;
+	const struct port_info *ports = NULL;
+	struct tm_source *src;
+
+	signal(SIGTERM, stop_process);
+	signal(SIGINT, stop_process);
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Invalid EAL arguments.\n");
+	argc -= ret;
+	argv += ret;
+
+	if (rte_eal_process_type() != RTE_PROC_SECONDARY)
+		rte_exit(EXIT_FAILURE, "Run as a secondary process.\n");
+
+	if (parse_app_args(argc, argv) != 0)
+		rte_exit(EXIT_FAILURE, "Invalid app arguments.\n");
+
+	if (g_primary) {
+		mz = rte_memzone_lookup(MZ_PORT_INFO);
+		if (mz == NULL)
+			rte_exit(EXIT_FAILURE,
+				"Cannot get port info structure\n");
+		ports = mz->addr;
+	}
+
+	while (!g_quit && (g_count == 0 || nof_reads < g_count)) {
+		for (i = 0; i < g_nof_sources; i++) {
+			src = &g_sources[i];
+			/* Process might be launched after the reader. */
+			if (src->tm == NULL) {
+				src->tm = lookup_telemetry(src->client_id);
+				if (src->tm == NULL)
+					continue;
+			}
+
+			/* Skip printing the same contents again. */
+			if (src->tm->nof_updates == src->last_update)
+				continue;
+			read_telemetry(src->tm);
+			src->last_update = g_snapshot.nof_updates;
+			print_telemetry();
+		}
+		if (ports != NULL)
+			print_primary(ports, rte_get_tsc_cycles());
+		fflush(stdout);
+
+		nof_reads++;
+		usleep(g_interval);
+	}
+
+	rte_eal_cleanup();
+	return 0;
+}
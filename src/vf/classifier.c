@@ -14,6 +14,9 @@
 #include <rte_log.h>
 #include <rte_cycles.h>
 #include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_random.h>
 #include <rte_byteorder.h>
 #include <rte_per_lcore.h>
@@ -22,16 +25,14 @@
 #include <netinet/in.h>
 
 #include "classifier.h"
+#include "flow_classifier.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-#include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
+#include "shared/secondary/spp_worker_th/port_stats.h"
 
 #define RTE_LOGTYPE_VF_CLS RTE_LOGTYPE_USER1
 
@@ -43,11 +44,46 @@
 #define DEFAULT_HASH_FUNC rte_jhash
 #endif
 
-/* Number of classifier table entry */
+/**
+ * Default num of classifier table entries, used if capacity is not given
+ * in `component start` command.
+ */
 #define NOF_CLS_TABLE_ENTRIES 128
 
+/**
+ * Max load factor of classifier table in percent. Table is rebuilt with
+ * doubled capacity if num of entries exceeds it.
+ */
+#define CLS_TBL_MAX_LOAD 75
+
+/* Num of packets prefetched ahead of referring the header in a burst. */
+#define CLS_PREFETCH_OFFSET 4
+
 /* Interval transmit burst packet if buffer is not filled. */
-#define DRAIN_TX_PACKET_INTERVAL 100  /* nano sec */
+#ifndef DRAIN_TX_PACKET_INTERVAL
+#define DRAIN_TX_PACKET_INTERVAL 100  /* micro sec */
+#endif
+
+/**
+ * Default num of packets buffered for a destination to be transmitted at
+ * once. It can be changed for each of ports with `flush_thresh` command.
+ */
+#ifndef CLS_TX_FLUSH_THRESH
+#define CLS_TX_FLUSH_THRESH MAX_PKT_BURST
+#endif
+#if CLS_TX_FLUSH_THRESH < 1 || CLS_TX_FLUSH_THRESH > MAX_PKT_BURST
+#error "CLS_TX_FLUSH_THRESH must be in range from 1 to MAX_PKT_BURST."
+#endif
+
+/**
+ * Max length of L2 multicast packet copied entirely for a destination which
+ * modifies packets. For longer one, only L2 header is copied and payload is
+ * shared with the original via indirect mbuf.
+ */
+#define CLS_MCAST_COPY_LEN 256
+
+/* Max num of deleted keys and ACLs of classifiers waiting for reclaim. */
+#define NOF_CLS_DEFERRED_KEYS 1024
 
 /* VID of VLAN untagged */
 #define VLAN_UNTAGGED_VID 0x0fff
@@ -61,18 +97,78 @@ struct cls_mng_info {
 	volatile int ref_index;  /* Flag for ref side */
 	volatile int upd_index;  /* Flag for update side */
 	volatile int is_used;
+	uint64_t prev_tsc;  /* TSC of last draining TX buffers. */
 };
 
 /* classifier information per lcore */
 struct cls_mng_info cls_mng_info_list[RTE_MAX_LCORE];
 
+/* Interval of draining TX buffers in TSC. */
+static uint64_t cls_drain_tsc;
+
+/**
+ * Key position deleted from live classifier table, or ACL of flow rules
+ * replaced with new one. It is released after all of readers pass through
+ * quiescent state since it is deleted.
+ */
+struct cls_deferred_key {
+	struct rte_hash *cls_tbl;  /* NULL if the table is already freed. */
+	int32_t pos;  /* Position of deleted key. */
+	struct rte_acl_ctx *acl_ctx;  /* Replaced ACL, or NULL. */
+	uint64_t token;  /* Token of rte_rcu_qsbr_start() at deleting. */
+};
+
+/* QSBR variable for readers of classifier tables, or NULL if disabled. */
+static struct rte_rcu_qsbr *cls_qsbr;
+
+/* Queue of deleted keys waiting for reclaim, used only by command thread. */
+static struct cls_deferred_key cls_deferred_keys[NOF_CLS_DEFERRED_KEYS];
+static unsigned int cls_deferred_head;  /* Index of oldest entry. */
+static unsigned int cls_deferred_tail;  /* Index of next entry. */
+
+/* Forget deleted keys waiting for reclaim in given table to be freed. */
+static void
+forget_deferred_keys(const struct rte_hash *cls_tbl)
+{
+	unsigned int i;
+
+	for (i = cls_deferred_head; i != cls_deferred_tail;
+			i = (i + 1) % NOF_CLS_DEFERRED_KEYS) {
+		if (cls_deferred_keys[i].cls_tbl == cls_tbl)
+			cls_deferred_keys[i].cls_tbl = NULL;
+	}
+}
+
+/* Release deleted keys of which readers have passed through grace period. */
+static void
+reclaim_deferred_keys(void)
+{
+	struct cls_deferred_key *dk;
+
+	while (cls_deferred_head != cls_deferred_tail) {
+		dk = &cls_deferred_keys[cls_deferred_head];
+		if (rte_rcu_qsbr_check(cls_qsbr, dk->token, false) != 1)
+			break;
+
+		if (dk->cls_tbl != NULL)
+			rte_hash_free_key_with_position(dk->cls_tbl, dk->pos);
+		if (dk->acl_ctx != NULL)
+			rte_acl_free(dk->acl_ctx);
+		cls_deferred_head = (cls_deferred_head + 1) %
+				NOF_CLS_DEFERRED_KEYS;
+	}
+}
+
 /* uninitialize classifier information. */
 static void
 clean_component_info(struct cls_comp_info *comp_info)
 {
 	int i;
-	for (i = 0; i < NOF_VLAN; ++i)
-		free_mac_classifier(comp_info->mac_clfs[i]);
+	for (i = 0; i < comp_info->nof_mac_clfs; ++i) {
+		forget_deferred_keys(comp_info->mac_clfs[i].cls_tbl);
+		free_mac_classifier(&comp_info->mac_clfs[i]);
+	}
+	free_cls_flow_acls(comp_info->flow_acls);
 	memset(comp_info, 0, sizeof(struct cls_comp_info));
 }
 
@@ -244,6 +340,24 @@ log_entry(long clsd_idx, uint16_t vid, const char *mac_addr_str,
 #define LOG_ENT(clsd_idx, vid, mac_addr_str, cmp_info, clsd_data)
 #endif
 
+/**
+ * Get mac classifier of given VLAN ID, or NULL if it is not registered.
+ * Index of the classifier in dense array is calculated from the num of bits
+ * set in bitmap before the bit of the VLAN ID.
+ */
+static inline struct mac_classifier *
+get_mac_classifier(struct cls_comp_info *cmp_info, uint16_t vid)
+{
+	const struct cls_vlan_bitmap *map = &cmp_info->vlan_map[vid >> 6];
+	uint64_t bit = 1ULL << (vid & 0x3f);
+
+	if (!(map->bits & bit))
+		return NULL;
+
+	return &cmp_info->mac_clfs[map->rank +
+			__builtin_popcountll(map->bits & (bit - 1))];
+}
+
 /* check if management information is used. */
 static inline int
 is_used_mng_info(const struct cls_mng_info *mng_info)
@@ -251,22 +365,21 @@ is_used_mng_info(const struct cls_mng_info *mng_info)
 	return (mng_info != NULL && mng_info->is_used);
 }
 
-/* create mac classification instance. */
-static struct mac_classifier *
-create_mac_classification(void)
+/**
+ * Setup given mac classification of VLAN ID and create its hash table of
+ * `capacity` entries on memory of `socket_id`.
+ */
+static int
+create_mac_classification(struct mac_classifier *mac_cls, uint16_t vid,
+		uint32_t capacity, int socket_id)
 {
-	struct mac_classifier *mac_cls;
 	char hash_tab_name[HASH_TABLE_NAME_BUF_SZ];
 	struct rte_hash **mac_cls_tab;
 
-	mac_cls = (struct mac_classifier *)rte_zmalloc(
-			NULL, sizeof(struct mac_classifier), 0);
-
-	if (unlikely(mac_cls == NULL))
-		return NULL;
-
+	mac_cls->vid = vid;
 	mac_cls->nof_cls_ports = 0;
 	mac_cls->default_cls_idx = -1;
+	mac_cls->capacity = capacity;
 
 	mac_cls_tab = &mac_cls->cls_tbl;
 
@@ -274,17 +387,20 @@ create_mac_classification(void)
 	sprintf(hash_tab_name, "cmtab_%07x%02hx", getpid(),
 			rte_atomic16_add_return(&g_hash_table_count, 1));
 
-	RTE_LOG(INFO, VF_CLS, "Create table. name=%s, bufsz=%lu\n",
-			hash_tab_name, HASH_TABLE_NAME_BUF_SZ);
+	RTE_LOG(INFO, VF_CLS, "Create table. name=%s, bufsz=%lu, "
+			"entries=%u, socket=%d\n", hash_tab_name,
+			HASH_TABLE_NAME_BUF_SZ, capacity, socket_id);
 
 	/* set hash creating parameters */
 	struct rte_hash_parameters hash_params = {
 			.name      = hash_tab_name,
-			.entries   = NOF_CLS_TABLE_ENTRIES,
+			.entries   = capacity,
 			.key_len   = sizeof(struct rte_ether_addr),
 			.hash_func = DEFAULT_HASH_FUNC,
 			.hash_func_init_val = 0,
-			.socket_id = rte_socket_id(),
+			.socket_id = socket_id,
+			/* Entries can be added or deleted while forwarding. */
+			.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
 	};
 
 	/* Create classifier table. */
@@ -293,11 +409,28 @@ create_mac_classification(void)
 		RTE_LOG(ERR, VF_CLS,
 				"Cannot create mac classification table. "
 				"name=%s\n", hash_tab_name);
-		rte_free(mac_cls);
-		return NULL;
+		return SPPWK_RET_NG;
 	}
 
-	return mac_cls;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Get capacity of classifier table for `nof_ents` entries. It is given in
+ * `component start` command, and doubled until the load factor is not over
+ * CLS_TBL_MAX_LOAD.
+ */
+static uint32_t
+get_cls_tbl_capacity(const struct sppwk_comp_info *wk_comp_info,
+		unsigned int nof_ents)
+{
+	uint32_t capacity = wk_comp_info->cls_tbl_size;
+
+	if (capacity == 0)
+		capacity = NOF_CLS_TABLE_ENTRIES;
+	while ((uint64_t)nof_ents * 100 > (uint64_t)capacity * CLS_TBL_MAX_LOAD)
+		capacity *= 2;
+	return capacity;
 }
 
 /* initialize classifier information. */
@@ -307,6 +440,9 @@ init_component_info(struct cls_comp_info *cmp_info,
 {
 	int ret = SPPWK_RET_NG;
 	int i;
+	/* Allocate tables on the socket of lcore referring them. */
+	int socket_id = rte_lcore_to_socket_id(wk_comp_info->lcore_id);
+	unsigned int nof_ents[RTE_MAX_ETHPORTS];  /* Entries of each VLAN. */
 	struct mac_classifier *mac_cls;
 	struct rte_ether_addr eth_addr;
 	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
@@ -316,12 +452,17 @@ init_component_info(struct cls_comp_info *cmp_info,
 	struct sppwk_port_info *tx_port = NULL;
 	uint16_t vid;
 
+	/* Clear remained entries if previous update was failed. */
+	clean_component_info(cmp_info);
+	cmp_info->socket_id = socket_id;
+
 	/* set rx */
 	if (wk_comp_info->nof_rx == 0) {
 		cls_rx_port_info->iface_type = UNDEF;
 		cls_rx_port_info->iface_no = 0;
 		cls_rx_port_info->iface_no_global = 0;
 		cls_rx_port_info->ethdev_port_id = 0;
+		cls_rx_port_info->queue_id = 0;
 		cls_rx_port_info->nof_pkts = 0;
 	} else {
 		cls_rx_port_info->iface_type =
@@ -331,9 +472,40 @@ init_component_info(struct cls_comp_info *cmp_info,
 			wk_comp_info->rx_ports[0]->iface_no;
 		cls_rx_port_info->ethdev_port_id =
 			wk_comp_info->rx_ports[0]->ethdev_port_id;
+		cls_rx_port_info->queue_id = wk_comp_info->rx_queues[0];
 		cls_rx_port_info->nof_pkts = 0;
 	}
 
+	/**
+	 * Register VLAN IDs of TX ports in bitmap before creating classifiers
+	 * to place classifiers in dense array in order of VLAN ID.
+	 */
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		tx_port = wk_comp_info->tx_ports[i];
+		if (tx_port->cls_attrs.mac_addr == 0)
+			continue;
+		vid = tx_port->cls_attrs.vlantag.vid;
+		cmp_info->vlan_map[vid >> 6].bits |= 1ULL << (vid & 0x3f);
+	}
+	cmp_info->nof_mac_clfs = 0;
+	for (i = 0; i < NOF_VLAN_WORDS; i++) {
+		cmp_info->vlan_map[i].rank = cmp_info->nof_mac_clfs;
+		cmp_info->nof_mac_clfs +=
+			__builtin_popcountll(cmp_info->vlan_map[i].bits);
+	}
+
+	/* Count entries of each VLAN for sizing its table. */
+	memset(nof_ents, 0, sizeof(nof_ents));
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		tx_port = wk_comp_info->tx_ports[i];
+		if (tx_port->cls_attrs.mac_addr == 0 ||
+				tx_port->cls_attrs.mac_addr == CLS_DUMMY_ADDR)
+			continue;
+		mac_cls = get_mac_classifier(cmp_info,
+				tx_port->cls_attrs.vlantag.vid);
+		nof_ents[mac_cls - cmp_info->mac_clfs]++;
+	}
+
 	/* set tx */
 	cmp_info->nof_tx_ports = wk_comp_info->nof_tx;
 	cmp_info->mac_addr_entry = 0;
@@ -346,22 +518,32 @@ init_component_info(struct cls_comp_info *cmp_info,
 		cls_tx_ports_info[i].iface_no = i;
 		cls_tx_ports_info[i].iface_no_global = tx_port->iface_no;
 		cls_tx_ports_info[i].ethdev_port_id = tx_port->ethdev_port_id;
+		cls_tx_ports_info[i].queue_id = wk_comp_info->tx_queues[i];
+		if (unlikely(sppwk_get_tx_queue(wk_comp_info, i,
+				&cls_tx_ports_info[i].txq) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
 		cls_tx_ports_info[i].nof_pkts = 0;
+		cls_tx_ports_info[i].flush_thresh = tx_port->flush_thresh;
+		if (cls_tx_ports_info[i].flush_thresh == 0)
+			cls_tx_ports_info[i].flush_thresh =
+				CLS_TX_FLUSH_THRESH;
 
 		if (tx_port->cls_attrs.mac_addr == 0)
 			continue;
 
-		/* if mac classification is NULL, make instance */
-		if (unlikely(cmp_info->mac_clfs[vid] == NULL)) {
+		/* if mac classification is not created, make instance */
+		mac_cls = get_mac_classifier(cmp_info, vid);
+		if (unlikely(mac_cls->cls_tbl == NULL)) {
 			RTE_LOG(DEBUG, VF_CLS,
 					"Mac classification is not registered."
 					" create. vid=%hu\n", vid);
-			cmp_info->mac_clfs[vid] =
-					create_mac_classification();
-			if (unlikely(cmp_info->mac_clfs[vid] == NULL))
+			ret = create_mac_classification(mac_cls, vid,
+					get_cls_tbl_capacity(wk_comp_info,
+					nof_ents[mac_cls - cmp_info->mac_clfs]),
+					socket_id);
+			if (unlikely(ret != SPPWK_RET_OK))
 				return SPPWK_RET_NG;
 		}
-		mac_cls = cmp_info->mac_clfs[vid];
 
 		/* store active tx_port that associate with mac address */
 		mac_cls->cls_ports[mac_cls->nof_cls_ports++] = i;
@@ -406,6 +588,12 @@ init_component_info(struct cls_comp_info *cmp_info,
 				tx_port->iface_no, tx_port->ethdev_port_id);
 	}
 
+	/* Flow rules are referred before MAC addresses. */
+	ret = build_cls_flow_acls(cmp_info->flow_acls, cls_tx_ports_info,
+			cmp_info->nof_tx_ports, socket_id);
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
 	return SPPWK_RET_OK;
 }
 
@@ -417,14 +605,9 @@ transmit_packets(struct cls_port_info *clsd_data)
 	uint16_t n_tx;
 
 	/* transmit packets */
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	n_tx = sppwk_eth_vlan_ring_stats_tx_burst(clsd_data->ethdev_port_id,
-			clsd_data->iface_type, clsd_data->iface_no,
-			0, clsd_data->pkts, clsd_data->nof_pkts);
-#else
-	n_tx = sppwk_eth_vlan_tx_burst(clsd_data->ethdev_port_id, 0,
-			clsd_data->pkts, clsd_data->nof_pkts);
-#endif
+	n_tx = sppwk_eth_vlan_tx_burst(clsd_data->ethdev_port_id,
+			&clsd_data->txq, clsd_data->pkts,
+			clsd_data->nof_pkts);
 
 	/* free cannot transmit packets */
 	if (unlikely(n_tx != clsd_data->nof_pkts)) {
@@ -463,8 +646,8 @@ push_packet(struct rte_mbuf *pkt, struct cls_port_info *clsd_data)
 {
 	clsd_data->pkts[clsd_data->nof_pkts++] = pkt;
 
-	/* transmit packet, if buffer is filled */
-	if (unlikely(clsd_data->nof_pkts == MAX_PKT_BURST)) {
+	/* transmit packet, if buffer is filled up to threshold */
+	if (unlikely(clsd_data->nof_pkts >= clsd_data->flush_thresh)) {
 		RTE_LOG(DEBUG, VF_CLS,
 				"transmit packets (buffer is filled). "
 				"iface_type=%d, iface_no={%d,%d}, "
@@ -484,7 +667,7 @@ get_general_default_classified_index(struct cls_comp_info *cmp_info)
 {
 	struct mac_classifier *mac_cls;
 
-	mac_cls = cmp_info->mac_clfs[VLAN_UNTAGGED_VID];
+	mac_cls = get_mac_classifier(cmp_info, VLAN_UNTAGGED_VID);
 	if (unlikely(mac_cls == NULL)) {
 		LOG_DBG(cmp_info->name, "Untagged's default is not set. "
 				"vid=%d\n", (int)VLAN_UNTAGGED_VID);
@@ -494,139 +677,358 @@ get_general_default_classified_index(struct cls_comp_info *cmp_info)
 	return mac_cls->default_cls_idx;
 }
 
-/* handle L2 multicast(include broadcast) packet */
+/**
+ * Make a copy of L2 multicast packet on `hdr` for a destination modifying
+ * packets. Return NULL if failed, and `hdr` should be released by caller.
+ */
+static inline struct rte_mbuf *
+copy_l2multicast_packet(struct rte_mbuf *pkt, struct rte_mbuf *hdr)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_mbuf *payload;
+	uint32_t copy_len = rte_pktmbuf_pkt_len(pkt);
+
+	if (pkt->nb_segs > 1 || copy_len > CLS_MCAST_COPY_LEN) {
+		/* Copy only L2 header which is rewritten. */
+		eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+		copy_len = sizeof(struct rte_ether_hdr);
+		if (eth->ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN))
+			copy_len += sizeof(struct rte_vlan_hdr);
+		if (unlikely(copy_len > rte_pktmbuf_data_len(pkt)))
+			return NULL;
+	}
+
+	rte_memcpy(rte_pktmbuf_mtod(hdr, void *),
+			rte_pktmbuf_mtod(pkt, void *), copy_len);
+	hdr->data_len = (uint16_t)copy_len;
+	hdr->pkt_len = copy_len;
+	hdr->port = pkt->port;
+	hdr->timestamp = pkt->timestamp;
+	hdr->udata64 = pkt->udata64;  /* Stamps of latency probe and trace. */
+	if (copy_len == rte_pktmbuf_pkt_len(pkt))
+		return hdr;
+
+	/* Share payload of the original as indirect mbuf. */
+	payload = rte_pktmbuf_clone(pkt, pkt->pool);
+	if (unlikely(payload == NULL))
+		return NULL;
+	rte_pktmbuf_adj(payload, (uint16_t)copy_len);
+	if (unlikely(rte_pktmbuf_chain(hdr, payload) != 0)) {
+		rte_pktmbuf_free(payload);
+		return NULL;
+	}
+	return hdr;
+}
+
+/**
+ * Transmit L2 multicast packet to given destinations. Destinations which
+ * modify packets, for adding or deleting VLAN tag, get their own copy, and
+ * others share the original without copying. If all of destinations modify
+ * packets, the original is given to the last one instead of a copy.
+ */
 static inline void
-handle_l2multicast_packet(struct rte_mbuf *pkt,
+fan_out_l2multicast_packet(struct rte_mbuf *pkt,
+		const int *dsts, int nof_dsts, const uint8_t *modifies,
 		struct cls_comp_info *cmp_info,
 		struct cls_port_info *clsd_data)
 {
-	int i;
-	struct mac_classifier *mac_cls;
-	uint16_t vid = get_vid(pkt);
-	int gen_def_clsd_idx = get_general_default_classified_index(cmp_info);
-	int n_act_clsd;
+	int i, n = 0;
+	int nof_copies = 0;
+	int nof_shared;
+	int orig_dst = -1;  /* Index in dsts given the original. */
+	int nof_pushed = 0;  /* Num of copies pushed to destinations. */
+	struct rte_mbuf *copies[RTE_MAX_ETHPORTS + 1];
+	struct rte_mbuf *cp;
+
+	for (i = 0; i < nof_dsts; i++) {
+		if (modifies[dsts[i]]) {
+			nof_copies++;
+			orig_dst = i;
+		}
+	}
+	nof_shared = nof_dsts - nof_copies;
+	if (nof_shared == 0)
+		nof_copies--;
+	else
+		orig_dst = -1;
 
-	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
-	if (unlikely(mac_cls == NULL ||
-			mac_cls->nof_cls_ports == 0)) {
-		/* specific vlan is not registered
-		 * use untagged's default(as general default)
-		 */
-		if (unlikely(gen_def_clsd_idx < 0)) {
-			/* untagged's default is not registered too */
-			RTE_LOG(ERR, VF_CLS,
-					"No entry.(l2 multicast packet)\n");
-			rte_pktmbuf_free(pkt);
-			return;
+	if (nof_copies > 0 && unlikely(rte_pktmbuf_alloc_bulk(pkt->pool,
+			copies, nof_copies) != 0)) {
+		RTE_LOG(DEBUG, VF_CLS,
+				"Failed to alloc copies of multicast packet, "
+				"drop them. num=%d\n", nof_copies);
+		nof_copies = 0;
+	}
+
+	/**
+	 * Make copies before pushing the original, because it might be sent
+	 * and released if buffer of a destination is filled.
+	 */
+	for (i = 0; i < nof_dsts; i++) {
+		if (!modifies[dsts[i]] || i == orig_dst)
+			continue;
+		if (unlikely(n == nof_copies))
+			continue;
+
+		cp = copy_l2multicast_packet(pkt, copies[n]);
+		if (unlikely(cp == NULL)) {
+			rte_pktmbuf_free(copies[n++]);
+			continue;
 		}
+		n++;
+		LOG_CLS((long)dsts[i], cp, cmp_info, clsd_data);
+		push_packet(cp, clsd_data + (long)dsts[i]);
+		nof_pushed++;
+	}
 
-		/* transmit to untagged's default(as general default) */
-		LOG_CLS((long)gen_def_clsd_idx, pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)gen_def_clsd_idx);
+	if (orig_dst >= 0) {
+		LOG_CLS((long)dsts[orig_dst], pkt, cmp_info, clsd_data);
+		push_packet(pkt, clsd_data + (long)dsts[orig_dst]);
+		sppwk_cnt_mcast_fanout(nof_pushed + 1);
 		return;
 	}
 
-	/* add to mbuf's refcnt */
-	n_act_clsd = mac_cls->nof_cls_ports;
-	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID)
-		++n_act_clsd;
+	/* Add to mbuf's refcnt for sharing the original. */
+	rte_mbuf_refcnt_update(pkt, (int16_t)(nof_shared - 1));
+	for (i = 0; i < nof_dsts; i++) {
+		if (modifies[dsts[i]])
+			continue;
+		LOG_CLS((long)dsts[i], pkt, cmp_info, clsd_data);
+		push_packet(pkt, clsd_data + (long)dsts[i]);
+	}
+	sppwk_cnt_mcast_fanout(nof_pushed + nof_shared);
+}
 
-	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
+/**
+ * Handle L2 multicast(include broadcast) packets of a burst. Whether each
+ * of TX ports modifies packets is checked once for the burst, and
+ * destinations are resolved once for each of VLANs.
+ */
+static inline void
+handle_l2multicast_packets(struct rte_mbuf **pkts, int nof_pkts,
+		struct cls_comp_info *cmp_info,
+		struct cls_port_info *clsd_data)
+{
+	int i, j;
+	int nof_dsts = 0;
+	int gen_def_clsd_idx = get_general_default_classified_index(cmp_info);
+	int dsts[RTE_MAX_ETHPORTS + 1];
+	uint8_t modifies[RTE_MAX_ETHPORTS];
+	struct mac_classifier *mac_cls;
+	uint16_t vid, prev_vid = 0;
+
+	for (i = 0; i < cmp_info->nof_tx_ports; i++)
+		modifies[i] = (uint8_t)sppwk_port_modifies_pkts(
+				clsd_data[i].ethdev_port_id,
+				SPPWK_PORT_DIR_TX);
+
+	for (i = 0; i < nof_pkts; i++) {
+		vid = get_vid(pkts[i]);
+		if (i > 0 && likely(vid == prev_vid))
+			goto fan_out;
+		prev_vid = vid;
+		nof_dsts = 0;
+
+		/* select mac address classification by vid */
+		mac_cls = get_mac_classifier(cmp_info, vid);
+		if (unlikely(mac_cls == NULL ||
+				mac_cls->nof_cls_ports == 0)) {
+			/* specific vlan is not registered
+			 * use untagged's default(as general default)
+			 */
+			if (gen_def_clsd_idx >= 0)
+				dsts[nof_dsts++] = gen_def_clsd_idx;
+			goto fan_out;
+		}
 
-	/* transmit to specific segment & general default */
-	for (i = 0; i < mac_cls->nof_cls_ports; i++) {
-		LOG_CLS((long)mac_cls->cls_ports[i], pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)mac_cls->cls_ports[i]);
-	}
+		/* transmit to specific segment & general default */
+		for (j = 0; j < mac_cls->nof_cls_ports; j++)
+			dsts[nof_dsts++] = mac_cls->cls_ports[j];
+		if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID)
+			dsts[nof_dsts++] = gen_def_clsd_idx;
 
-	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID) {
-		LOG_CLS((long)gen_def_clsd_idx, pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)gen_def_clsd_idx);
+fan_out:
+		if (unlikely(nof_dsts == 0)) {
+			/* untagged's default is not registered too */
+			RTE_LOG(ERR, VF_CLS,
+					"No entry.(l2 multicast packet)\n");
+			sppwk_cnt_cls_miss(1);
+			rte_pktmbuf_free(pkts[i]);
+			continue;
+		}
+		fan_out_l2multicast_packet(pkts[i], dsts, nof_dsts, modifies,
+				cmp_info, clsd_data);
 	}
 }
 
-/* select index of classified */
+/* Get index of default classified for packets of given VLAN ID. */
 static inline int
-select_classified_index(const struct rte_mbuf *pkt,
+get_default_classified_index(struct mac_classifier *mac_cls, uint16_t vid,
 		struct cls_comp_info *cmp_info)
 {
-	int ret;
+	/* if default is not set, use untagged's default */
+	if (unlikely(mac_cls->default_cls_idx < 0 &&
+			vid != VLAN_UNTAGGED_VID)) {
+		LOG_DBG(cmp_info->name, "Vid's default is not set. "
+				"use general default. vid=%hu\n", vid);
+		return get_general_default_classified_index(cmp_info);
+	}
+
+	LOG_DBG(cmp_info->name, "Use vid's default. vid=%hu\n", vid);
+	return mac_cls->default_cls_idx;
+}
+
+/**
+ * Select indices of classified for a group of packets which have the same
+ * VLAN ID. Destination MAC addresses of the group are looked up with a
+ * single bulk lookup of the hash table instead of one lookup for each.
+ * The result is stored in `clsd_idx` at the position of each packet in
+ * the burst, and -2 is set for L2 multicast packets not registered.
+ */
+static inline void
+select_classified_index_bulk(struct rte_mbuf **pkts,
+		const uint16_t *grp_pkts, int nof_grp_pkts, uint16_t vid,
+		struct cls_comp_info *cmp_info, long *clsd_idx)
+{
+	int i, ret;
+	int def_idx;
+	uint64_t hit_mask = 0;
 	struct rte_ether_hdr *eth;
-	void *lookup_data;
 	struct mac_classifier *mac_cls;
-	uint16_t vid;
-
-	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	vid = get_vid(pkt);
+	const void *keys[MAX_PKT_BURST];
+	void *lookup_data[MAX_PKT_BURST];
 
 	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
+	mac_cls = get_mac_classifier(cmp_info, vid);
 	if (unlikely(mac_cls == NULL)) {
 		LOG_DBG(cmp_info->name, "Mac classification is not "
 				"registered. vid=%hu\n", vid);
-		return get_general_default_classified_index(cmp_info);
+		def_idx = get_general_default_classified_index(cmp_info);
+		for (i = 0; i < nof_grp_pkts; i++)
+			clsd_idx[grp_pkts[i]] = def_idx;
+		return;
+	}
+
+	for (i = 0; i < nof_grp_pkts; i++) {
+		eth = rte_pktmbuf_mtod(pkts[grp_pkts[i]],
+				struct rte_ether_hdr *);
+		keys[i] = &eth->d_addr;
 	}
 
 	/* find in table (by destination mac address) */
-	ret = rte_hash_lookup_data(mac_cls->cls_tbl,
-			(const void *)&eth->d_addr, &lookup_data);
-	if (ret >= 0) {
-		LOG_DBG(cmp_info->name, "Mac address is registered. "
+	ret = rte_hash_lookup_bulk_data(mac_cls->cls_tbl, keys,
+			nof_grp_pkts, &hit_mask, lookup_data);
+	if (unlikely(ret < 0)) {
+		LOG_DBG(cmp_info->name, "Failed to lookup in bulk. "
 				"ret=%d, vid=%hu\n", ret, vid);
-		return (int)(long)lookup_data;
+		hit_mask = 0;
 	}
 
-	LOG_DBG(cmp_info->name,
-			"Mac address is not registered. ret=%d, "
-			"(EINVAL=%d, ENOENT=%d)\n", ret, EINVAL, ENOENT);
-
-	/* check if packet is l2 multicast */
-	if (unlikely(rte_is_multicast_ether_addr(&eth->d_addr)))
-		return -2;
+	def_idx = get_default_classified_index(mac_cls, vid, cmp_info);
+	for (i = 0; i < nof_grp_pkts; i++) {
+		if (likely(hit_mask & (1ULL << i))) {
+			clsd_idx[grp_pkts[i]] = (long)lookup_data[i];
+			continue;
+		}
 
-	/* if default is not set, use untagged's default */
-	if (unlikely(mac_cls->default_cls_idx < 0 &&
-			vid != VLAN_UNTAGGED_VID)) {
-		LOG_DBG(cmp_info->name, "Vid's default is not set. "
-				"use general default. vid=%hu\n", vid);
-		return get_general_default_classified_index(cmp_info);
+		/* check if packet is l2 multicast */
+		if (unlikely(rte_is_multicast_ether_addr(
+				(const struct rte_ether_addr *)keys[i])))
+			clsd_idx[grp_pkts[i]] = -2;
+		else
+			clsd_idx[grp_pkts[i]] = def_idx;
 	}
-
-	/* use default */
-	LOG_DBG(cmp_info->name, "Use vid's default. vid=%hu\n", vid);
-	return mac_cls->default_cls_idx;
 }
 
+/**
+ * Classify a burst of packets. Packets matched with flow rules are resolved
+ * at first. Others are grouped by VLAN ID, and destinations of each group
+ * are resolved with a bulk lookup. Packets are pushed to TX buffers in the
+ * received order after all of destinations are resolved, so that the order
+ * of packets in each flow is kept.
+ */
 static inline void
 _classify_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
 		struct cls_comp_info *cmp_info,
 		struct cls_port_info *clsd_data)
 {
-	int i;
-	long clsd_idx;
-
+	int i, j;
+	int nof_grps = 0;
+	int nof_mcast_pkts = 0;
+	int nof_flow_pkts = 0;
+	uint16_t vid;
+	long clsd_idx[MAX_PKT_BURST];
+	int32_t flow_idx[MAX_PKT_BURST];
+	struct rte_mbuf *mcast_pkts[MAX_PKT_BURST];
+	uint16_t grp_vids[MAX_PKT_BURST];  /* VLAN ID of each group. */
+	int nof_grp_pkts[MAX_PKT_BURST];  /* Num of packets in each group. */
+	/* Indices of packets in rx_pkts for each group. */
+	uint16_t grp_pkts[MAX_PKT_BURST][MAX_PKT_BURST];
+
+	/* Prefetch first packets of the burst before referring headers. */
+	for (i = 0; i < CLS_PREFETCH_OFFSET && i < n_rx; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(rx_pkts[i], void *));
+
+	if (cmp_info->flow_acls[0] != NULL || cmp_info->flow_acls[1] != NULL)
+		nof_flow_pkts = classify_cls_flows(cmp_info->flow_acls,
+				rx_pkts, n_rx, flow_idx);
+
+	/* Group packets by VLAN ID. */
 	for (i = 0; i < n_rx; i++) {
+		if (likely(i + CLS_PREFETCH_OFFSET < n_rx))
+			rte_prefetch0(rte_pktmbuf_mtod(
+					rx_pkts[i + CLS_PREFETCH_OFFSET],
+					void *));
+
 		LOG_PKT(cmp_info->name, rx_pkts[i]);
 
-		clsd_idx = select_classified_index(rx_pkts[i], cmp_info);
-		LOG_CLS(clsd_idx, rx_pkts[i], cmp_info, clsd_data);
+		if (nof_flow_pkts > 0 && flow_idx[i] >= 0) {
+			clsd_idx[i] = flow_idx[i];
+			continue;
+		}
+
+		vid = get_vid(rx_pkts[i]);
+		for (j = 0; j < nof_grps; j++) {
+			if (likely(grp_vids[j] == vid))
+				break;
+		}
+		if (unlikely(j == nof_grps)) {
+			grp_vids[j] = vid;
+			nof_grp_pkts[j] = 0;
+			nof_grps++;
+		}
+		grp_pkts[j][nof_grp_pkts[j]++] = i;
+	}
+
+	/* Resolve destinations with one bulk lookup for each group. */
+	for (j = 0; j < nof_grps; j++)
+		select_classified_index_bulk(rx_pkts, grp_pkts[j],
+				nof_grp_pkts[j], grp_vids[j], cmp_info,
+				clsd_idx);
+
+	for (i = 0; i < n_rx; i++) {
+		LOG_CLS(clsd_idx[i], rx_pkts[i], cmp_info, clsd_data);
 
-		if (likely(clsd_idx >= 0)) {
+		if (likely(clsd_idx[i] >= 0)) {
 			LOG_DBG(cmp_info->name, "as unicast packet. i=%d\n",
 					i);
-			push_packet(rx_pkts[i], clsd_data + clsd_idx);
-		} else if (unlikely(clsd_idx == -1)) {
+			push_packet(rx_pkts[i], clsd_data + clsd_idx[i]);
+		} else if (unlikely(clsd_idx[i] == -1)) {
 			LOG_DBG(cmp_info->name, "no destination. "
 					"drop packet. i=%d\n", i);
+			sppwk_cnt_cls_miss(1);
 			rte_pktmbuf_free(rx_pkts[i]);
-		} else if (unlikely(clsd_idx == -2)) {
+		} else if (unlikely(clsd_idx[i] == -2)) {
 			LOG_DBG(cmp_info->name, "as multicast packet. i=%d\n",
 					i);
-			handle_l2multicast_packet(rx_pkts[i],
-					cmp_info, clsd_data);
+			mcast_pkts[nof_mcast_pkts++] = rx_pkts[i];
 		}
 	}
+
+	/* Fan out multicast packets of the burst at once. */
+	if (unlikely(nof_mcast_pkts > 0))
+		handle_l2multicast_packets(mcast_pkts, nof_mcast_pkts,
+				cmp_info, clsd_data);
 }
 
 /* TODO(yasufum) Revise this comment and name of func. */
@@ -653,10 +1055,332 @@ change_classifier_index(struct cls_mng_info *mng_info, int id)
 int
 init_cls_mng_info(void)
 {
+	size_t sz;
+
 	memset(cls_mng_info_list, 0, sizeof(cls_mng_info_list));
+	cls_drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
+			US_PER_S * DRAIN_TX_PACKET_INTERVAL;
+
+	/**
+	 * Classifier tables are rebuilt for each of updates if QSBR variable
+	 * is not available, so it is not an error.
+	 */
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	cls_qsbr = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (unlikely(cls_qsbr == NULL ||
+			rte_rcu_qsbr_init(cls_qsbr, RTE_MAX_LCORE) != 0)) {
+		RTE_LOG(WARNING, VF_CLS, "Cannot init QSBR variable, "
+				"disable updating live classifier table.\n");
+		rte_free(cls_qsbr);
+		cls_qsbr = NULL;
+	}
+	cls_deferred_head = 0;
+	cls_deferred_tail = 0;
 	return 0;
 }
 
+/* Register lcore as a reader of classifier tables. */
+void
+cls_rcu_register(unsigned int lcore_id)
+{
+	if (cls_qsbr != NULL)
+		rte_rcu_qsbr_thread_register(cls_qsbr, lcore_id);
+}
+
+/* Start or stop reporting quiescent state of lcore. */
+void
+cls_rcu_set_online(unsigned int lcore_id, int online)
+{
+	if (cls_qsbr == NULL)
+		return;
+
+	if (online)
+		rte_rcu_qsbr_thread_online(cls_qsbr, lcore_id);
+	else
+		rte_rcu_qsbr_thread_offline(cls_qsbr, lcore_id);
+}
+
+/* Report lcore no longer refers classifier tables until next poll. */
+void
+cls_rcu_quiescent(unsigned int lcore_id)
+{
+	if (cls_qsbr != NULL)
+		rte_rcu_qsbr_quiescent(cls_qsbr, lcore_id);
+}
+
+/**
+ * Find classifiers on which given port is a TX port, and index of the port
+ * on each of them. Return the num of classifiers, or -1 if a classifier is
+ * switching to other side and cannot be updated directly.
+ */
+static int
+find_classifiers_of_tx_port(const struct sppwk_port_info *port,
+		struct cls_comp_info **cmp_infos, int *tx_idxs)
+{
+	int i, j;
+	int nof_cls = 0;
+	struct cls_mng_info *mng_info;
+	struct cls_comp_info *cmp_info;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		mng_info = cls_mng_info_list + i;
+		if (!mng_info->is_used)
+			continue;
+		if (mng_info->ref_index == mng_info->upd_index)
+			return -1;
+
+		cmp_info = mng_info->comp_list + mng_info->ref_index;
+		for (j = 0; j < cmp_info->nof_tx_ports; j++) {
+			if (cmp_info->tx_ports_i[j].iface_type ==
+					port->iface_type &&
+					cmp_info->tx_ports_i[j].iface_no_global
+					== port->iface_no) {
+				cmp_infos[nof_cls] = cmp_info;
+				tx_idxs[nof_cls++] = j;
+				break;
+			}
+		}
+	}
+	return nof_cls;
+}
+
+/* Remove TX port of given index from ports for multicast of classifier. */
+static void
+del_cls_port(struct mac_classifier *mac_cls, int tx_idx)
+{
+	int i;
+	int last = mac_cls->nof_cls_ports - 1;
+
+	for (i = 0; i <= last; i++) {
+		if (mac_cls->cls_ports[i] == tx_idx)
+			break;
+	}
+	if (i > last)
+		return;
+
+	/**
+	 * Shrink first, then move the last one to the removed slot, so that
+	 * readers can miss the moved port for a moment but never see it
+	 * twice.
+	 */
+	mac_cls->nof_cls_ports = last;
+	rte_smp_wmb();
+	mac_cls->cls_ports[i] = mac_cls->cls_ports[last];
+}
+
+/**
+ * Set or unset default TX port of VLAN on live classifier. Only one port can
+ * be the default, so it is rebuilt if another one is already set or unset.
+ */
+static int
+update_default_entry(enum sppwk_action wk_action, int vid,
+		struct mac_classifier *mac_cls, int tx_idx,
+		const struct sppwk_port_info *port)
+{
+	if (wk_action == SPPWK_ACT_ADD) {
+		if (mac_cls->default_cls_idx >= 0)
+			return SPPWK_RET_NG;
+
+		/* Publish the port after its slot is written. */
+		mac_cls->cls_ports[mac_cls->nof_cls_ports] = tx_idx;
+		rte_smp_wmb();
+		mac_cls->nof_cls_ports++;
+		mac_cls->default_cls_idx = tx_idx;
+	} else {
+		if (mac_cls->default_cls_idx != tx_idx)
+			return SPPWK_RET_NG;
+
+		mac_cls->default_cls_idx = -1;
+		del_cls_port(mac_cls, tx_idx);
+	}
+
+	RTE_LOG(INFO, VF_CLS, "%s default of live classifier. "
+			"vid=%d, iface_type=%d, iface_no=%d\n",
+			wk_action == SPPWK_ACT_ADD ? "Set" : "Unset",
+			vid, port->iface_type, port->iface_no);
+	return SPPWK_RET_OK;
+}
+
+/* Add or delete an entry of MAC address on a live classifier table. */
+static int
+update_mac_entry(enum sppwk_action wk_action, int vid,
+		struct mac_classifier *mac_cls, int tx_idx,
+		const struct rte_ether_addr *eth_addr, const char *mac_addr_str)
+{
+	int ret;
+	struct cls_deferred_key *dk;
+
+	if (wk_action == SPPWK_ACT_ADD) {
+		/* Rebuild with larger table on update side if load is high. */
+		if ((uint64_t)(rte_hash_count(mac_cls->cls_tbl) + 1) * 100 >
+				(uint64_t)mac_cls->capacity * CLS_TBL_MAX_LOAD)
+			return SPPWK_RET_NG;
+
+		ret = rte_hash_add_key_data(mac_cls->cls_tbl,
+				(const void *)eth_addr, (void *)(long)tx_idx);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, VF_CLS,
+					"Cannot add to classifier table. "
+					"ret=%d, vid=%d, mac_addr=%s\n",
+					ret, vid, mac_addr_str);
+			return SPPWK_RET_NG;
+		}
+
+		/* Publish the port after its slot is written. */
+		mac_cls->cls_ports[mac_cls->nof_cls_ports] = tx_idx;
+		rte_smp_wmb();
+		mac_cls->nof_cls_ports++;
+		return SPPWK_RET_OK;
+	}
+
+	ret = rte_hash_del_key(mac_cls->cls_tbl, (const void *)eth_addr);
+	if (unlikely(ret < 0)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot delete from classifier table. "
+				"ret=%d, vid=%d, mac_addr=%s\n",
+				ret, vid, mac_addr_str);
+		return SPPWK_RET_NG;
+	}
+
+	/* Key slot is released after readers finish referring it. */
+	dk = &cls_deferred_keys[cls_deferred_tail];
+	dk->cls_tbl = mac_cls->cls_tbl;
+	dk->pos = ret;
+	dk->acl_ctx = NULL;
+	dk->token = rte_rcu_qsbr_start(cls_qsbr);
+	cls_deferred_tail = (cls_deferred_tail + 1) % NOF_CLS_DEFERRED_KEYS;
+
+	del_cls_port(mac_cls, tx_idx);
+	return SPPWK_RET_OK;
+}
+
+/* Get num of free slots of queue of deleted keys waiting for reclaim. */
+static inline unsigned int
+get_nof_free_deferred_keys(void)
+{
+	return (cls_deferred_head + NOF_CLS_DEFERRED_KEYS -
+			cls_deferred_tail - 1) % NOF_CLS_DEFERRED_KEYS;
+}
+
+/**
+ * Add or delete an entry of MAC address on live tables of all of classifiers
+ * sending to the port. It fails if one of them cannot be updated, and all of
+ * them are rebuilt from attributes of ports including updated ones.
+ */
+int
+update_classifier_entry(enum sppwk_action wk_action, int vid,
+		uint64_t mac_addr, const struct sppwk_port_info *port)
+{
+	int i, ret, nof_cls;
+	int tx_idxs[RTE_MAX_LCORE];
+	struct cls_comp_info *cmp_infos[RTE_MAX_LCORE];
+	struct mac_classifier *mac_clfs[RTE_MAX_LCORE];
+	struct rte_ether_addr eth_addr;
+	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
+
+	if (cls_qsbr == NULL || vid < 0 || vid >= NOF_VLAN)
+		return SPPWK_RET_NG;
+
+	nof_cls = find_classifiers_of_tx_port(port, cmp_infos, tx_idxs);
+	if (nof_cls <= 0)
+		return SPPWK_RET_NG;
+
+	/* Rebuild if classifier for the VLAN is not created yet. */
+	for (i = 0; i < nof_cls; i++) {
+		mac_clfs[i] = get_mac_classifier(cmp_infos[i], (uint16_t)vid);
+		if (mac_clfs[i] == NULL)
+			return SPPWK_RET_NG;
+	}
+
+	reclaim_deferred_keys();
+
+	/* Rebuild if no room for releasing deleted keys later. */
+	if (unlikely(wk_action != SPPWK_ACT_ADD &&
+			get_nof_free_deferred_keys() < (unsigned int)nof_cls))
+		return SPPWK_RET_NG;
+
+	rte_memcpy(&eth_addr, &mac_addr, RTE_ETHER_ADDR_LEN);
+	rte_ether_format_addr(mac_addr_str, sizeof(mac_addr_str), &eth_addr);
+
+	for (i = 0; i < nof_cls; i++) {
+		if (mac_addr == CLS_DUMMY_ADDR)
+			ret = update_default_entry(wk_action, vid, mac_clfs[i],
+					tx_idxs[i], port);
+		else
+			ret = update_mac_entry(wk_action, vid, mac_clfs[i],
+					tx_idxs[i], &eth_addr, mac_addr_str);
+		if (ret != SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+	}
+
+	if (mac_addr == CLS_DUMMY_ADDR)
+		return SPPWK_RET_OK;
+
+	RTE_LOG(INFO, VF_CLS, "%s entry of live classifier table. "
+			"vid=%d, mac_addr=%s, iface_type=%d, iface_no=%d\n",
+			wk_action == SPPWK_ACT_ADD ? "Add" : "Delete",
+			vid, mac_addr_str, port->iface_type, port->iface_no);
+	return SPPWK_RET_OK;
+}
+
+/* Replace ACLs of flow rules of classifiers which have given TX port. */
+int
+update_classifier_flows(const struct sppwk_port_info *port)
+{
+	int i, j, ret, nof_cls;
+	int tx_idxs[RTE_MAX_LCORE];
+	struct cls_comp_info *cmp_infos[RTE_MAX_LCORE];
+	struct cls_comp_info *cmp_info;
+	struct cls_deferred_key *dk;
+	struct rte_acl_ctx *acls[2];
+	struct rte_acl_ctx *old_acls[2];
+
+	if (cls_qsbr == NULL)
+		return SPPWK_RET_NG;
+
+	nof_cls = find_classifiers_of_tx_port(port, cmp_infos, tx_idxs);
+	if (nof_cls <= 0)
+		return SPPWK_RET_NG;
+
+	reclaim_deferred_keys();
+
+	/* Rebuild if no room for releasing replaced ACLs later. */
+	if (unlikely(get_nof_free_deferred_keys() < 2 * (unsigned int)nof_cls))
+		return SPPWK_RET_NG;
+
+	for (j = 0; j < nof_cls; j++) {
+		cmp_info = cmp_infos[j];
+		ret = build_cls_flow_acls(acls, cmp_info->tx_ports_i,
+				cmp_info->nof_tx_ports, cmp_info->socket_id);
+		if (unlikely(ret != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+
+		/* Publish new ACLs built entirely before replacing. */
+		rte_smp_wmb();
+		for (i = 0; i < 2; i++) {
+			old_acls[i] = cmp_info->flow_acls[i];
+			cmp_info->flow_acls[i] = acls[i];
+		}
+
+		/* Old ACLs are released after readers finish referring them. */
+		for (i = 0; i < 2; i++) {
+			if (old_acls[i] == NULL)
+				continue;
+			dk = &cls_deferred_keys[cls_deferred_tail];
+			dk->cls_tbl = NULL;
+			dk->acl_ctx = old_acls[i];
+			dk->token = rte_rcu_qsbr_start(cls_qsbr);
+			cls_deferred_tail = (cls_deferred_tail + 1) %
+					NOF_CLS_DEFERRED_KEYS;
+		}
+
+		RTE_LOG(INFO, VF_CLS,
+				"Replace flow rules of live classifier `%s`.\n",
+				cmp_info->name);
+	}
+	return SPPWK_RET_OK;
+}
+
 /* classifier(mac address) update component info. */
 int
 update_classifier(struct sppwk_comp_info *wk_comp_info)
@@ -712,9 +1436,7 @@ classify_packets(int comp_id)
 	struct cls_port_info *clsd_data_rx = NULL;
 	struct cls_port_info *clsd_data_tx = NULL;
 
-	uint64_t cur_tsc, prev_tsc = 0;
-	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
-			US_PER_S * DRAIN_TX_PACKET_INTERVAL;
+	uint64_t cur_tsc;
 
 	/* change index of update classifier management information */
 	change_classifier_index(mng_info, comp_id);
@@ -726,11 +1448,18 @@ classify_packets(int comp_id)
 	/* Check if it is ready to do classifying. */
 	if (!(clsd_data_rx->iface_type != UNDEF &&
 			cmp_info->nof_tx_ports >= 1 &&
-			cmp_info->mac_addr_entry == 1))
+			(cmp_info->mac_addr_entry == 1 ||
+			cmp_info->flow_acls[0] != NULL ||
+			cmp_info->flow_acls[1] != NULL)))
 		return SPPWK_RET_OK;
 
+	/**
+	 * Drain TX buffers not filled up to threshold only if the interval has
+	 * passed since last draining, to keep bursts full-sized under moderate
+	 * load and to bound latency under light load.
+	 */
 	cur_tsc = rte_rdtsc();
-	if (unlikely(cur_tsc - prev_tsc > drain_tsc)) {
+	if (unlikely(cur_tsc - mng_info->prev_tsc > cls_drain_tsc)) {
 		for (i = 0; i < cmp_info->nof_tx_ports; i++) {
 			if (likely(clsd_data_tx[i].nof_pkts == 0))
 				continue;
@@ -739,24 +1468,23 @@ classify_packets(int comp_id)
 					"transmit packets (drain). index=%d, "
 					"nof_pkts=%hu, interval=%lu\n",
 					i, clsd_data_tx[i].nof_pkts,
-					cur_tsc - prev_tsc);
-				transmit_packets(&clsd_data_tx[i]);
+					cur_tsc - mng_info->prev_tsc);
+			transmit_packets(&clsd_data_tx[i]);
 		}
-		prev_tsc = cur_tsc;
+		mng_info->prev_tsc = cur_tsc;
 	}
 
+	/* Send packets staged by other lcores sharing TX queues. */
+	for (i = 0; i < cmp_info->nof_tx_ports; i++)
+		sppwk_eth_tx_drain(clsd_data_tx[i].ethdev_port_id,
+				&clsd_data_tx[i].txq);
+
 	if (clsd_data_rx->iface_type == UNDEF)
 		return SPPWK_RET_OK;
 
 	/* Retrieve packets */
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	n_rx = sppwk_eth_vlan_ring_stats_rx_burst(clsd_data_rx->ethdev_port_id,
-			clsd_data_rx->iface_type, clsd_data_rx->iface_no,
-			0, rx_pkts, MAX_PKT_BURST);
-#else
-	n_rx = sppwk_eth_vlan_rx_burst(clsd_data_rx->ethdev_port_id, 0,
-			rx_pkts, MAX_PKT_BURST);
-#endif
+	n_rx = sppwk_eth_vlan_rx_burst(clsd_data_rx->ethdev_port_id,
+			clsd_data_rx->queue_id, rx_pkts, MAX_PKT_BURST);
 	if (unlikely(n_rx == 0))
 		return SPPWK_RET_OK;
 
@@ -796,6 +1524,7 @@ get_classifier_status(unsigned int lcore_id, int id,
 		nof_rx = 1;
 		rx_ports[0].iface_type = cmp_info->rx_port_i.iface_type;
 		rx_ports[0].iface_no = cmp_info->rx_port_i.iface_no_global;
+		rx_ports[0].queue_id = cmp_info->rx_port_i.queue_id;
 	}
 
 	memset(tx_ports, 0x00, sizeof(tx_ports));
@@ -803,6 +1532,7 @@ get_classifier_status(unsigned int lcore_id, int id,
 	for (i = 0; i < nof_tx; i++) {
 		tx_ports[i].iface_type = port_info[i].iface_type;
 		tx_ports[i].iface_no = port_info[i].iface_no_global;
+		tx_ports[i].queue_id = port_info[i].queue_id;
 	}
 
 	/* Set the information with the function specified by the command. */
@@ -874,14 +1604,28 @@ add_mac_entry(struct classifier_table_params *params,
 	}
 }
 
+/* Add a flow rule in classifier table for `status` command. */
+static void
+add_flow_entry(const struct sppwk_flow_rule *rule,
+		const struct sppwk_port_idx *port, void *arg)
+{
+	struct classifier_table_params *params = arg;
+	char rule_str[SPPWK_FLOW_RULE_STR_SZ];
+
+	sppwk_flow_rule_str(rule_str, rule);
+	(*params->tbl_proc)(params, SPPWK_CLS_TYPE_FLOW, ETH_VLAN_ID_MAX,
+			rule_str, port);
+}
+
 /* Add entries of classifier table. */
 static int
 _add_classifier_table(struct classifier_table_params *params)
 {
-	int i, vlan_id;
+	int i, cls_idx;
 	struct cls_mng_info *mng_info;
 	struct cls_comp_info *cmp_info;
 	struct cls_port_info *port_info;
+	struct mac_classifier *mac_cls;
 
 	for (i = 0; i < RTE_MAX_LCORE; i++) {
 		mng_info = cls_mng_info_list + i;
@@ -894,16 +1638,18 @@ _add_classifier_table(struct classifier_table_params *params)
 		RTE_LOG(DEBUG, VF_CLS,
 			"Parse MAC entries for status on lcore %u.\n", i);
 
-		for (vlan_id = 0; vlan_id < NOF_VLAN; ++vlan_id) {
-			if (cmp_info->mac_clfs[vlan_id] == NULL)
-				continue;
-
-			add_mac_entry(params, (uint16_t) vlan_id,
-					cmp_info->mac_clfs[vlan_id], cmp_info,
+		/* Only configured VLANs are stored in dense array. */
+		for (cls_idx = 0; cls_idx < cmp_info->nof_mac_clfs;
+				++cls_idx) {
+			mac_cls = &cmp_info->mac_clfs[cls_idx];
+			add_mac_entry(params, mac_cls->vid, mac_cls, cmp_info,
 					port_info);
 		}
 	}
 
+	/* Flow rules are listed even if the port is not used yet. */
+	iterate_cls_flow_rules(add_flow_entry, params);
+
 	return SPPWK_RET_OK;
 }
 
@@ -934,3 +1680,69 @@ add_classifier_table(const char *name, char **output,
 	spp_strbuf_free(tbl_params.output);
 	return ret;
 }
+
+/* Add usage of a classifier table in JSON. */
+static int
+append_cls_tbl_usage(char **output, const char *comp_name,
+		const struct mac_classifier *mac_cls)
+{
+	int ret;
+	unsigned int nof_ents = (unsigned int)rte_hash_count(mac_cls->cls_tbl);
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, VF_CLS, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_str_value(&tmp_buff, "name", comp_name);
+	if (ret == SPPWK_RET_OK && mac_cls->vid != VLAN_UNTAGGED_VID)
+		ret = append_json_uint_value(&tmp_buff, "vid", mac_cls->vid);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "entries", nof_ents);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "capacity",
+				mac_cls->capacity);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "load_factor_percent",
+				nof_ents * 100 / mac_cls->capacity);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add usage of classifier tables of each VLAN in JSON. */
+int
+add_classifier_table_usage(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int i, cls_idx;
+	int ret = SPPWK_RET_OK;
+	struct cls_mng_info *mng_info;
+	struct cls_comp_info *cmp_info;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, VF_CLS, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (i = 0; i < RTE_MAX_LCORE && ret == SPPWK_RET_OK; i++) {
+		mng_info = cls_mng_info_list + i;
+		if (!is_used_mng_info(mng_info))
+			continue;
+
+		cmp_info = mng_info->comp_list + mng_info->ref_index;
+		for (cls_idx = 0; cls_idx < cmp_info->nof_mac_clfs &&
+				ret == SPPWK_RET_OK; ++cls_idx)
+			ret = append_cls_tbl_usage(&tmp_buff, cmp_info->name,
+					&cmp_info->mac_clfs[cls_idx]);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
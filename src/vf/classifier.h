@@ -57,6 +57,18 @@ int add_classifier_table_val(
 int add_classifier_table(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
 
+/**
+ * Add num of entries, capacity and load factor of classifier table of
+ * each VLAN for `status` command.
+ *
+ * @param[in] name Name of the entry in JSON.
+ * @param[in,out] output Buffer of JSON to be appended.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_classifier_table_usage(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
 /**
  * classifier(mac address) initialize globals.
  *
@@ -65,6 +77,60 @@ int add_classifier_table(const char *name, char **output,
  */
 int init_cls_mng_info(void);
 
+/**
+ * Register lcore as a reader of classifier tables for RCU. It should be
+ * called from each of worker lcores before running.
+ *
+ * @param[in] lcore_id Lcore ID of worker.
+ */
+void cls_rcu_register(unsigned int lcore_id);
+
+/**
+ * Start or stop reporting quiescent state of lcore. Lcore not running
+ * should be offline for not blocking to release deleted entries.
+ *
+ * @param[in] lcore_id Lcore ID of worker.
+ * @param[in] online 1 for online, or 0 for offline.
+ */
+void cls_rcu_set_online(unsigned int lcore_id, int online);
+
+/**
+ * Report that lcore no longer refers classifier tables until next poll.
+ *
+ * @param[in] lcore_id Lcore ID of worker.
+ */
+void cls_rcu_quiescent(unsigned int lcore_id);
+
+/**
+ * Add or delete an entry of MAC address on live classifier tables of all of
+ * classifiers sending to the port without rebuilding them. Deleted key is
+ * released asynchronously after all of workers pass through quiescent
+ * state. It fails if the entry cannot be updated in this way on one of
+ * them, and the classifiers should be rebuilt instead.
+ *
+ * @param[in] wk_action Action of SPPWK_ACT_ADD or SPPWK_ACT_DEL.
+ * @param[in] vid VLAN ID of the entry.
+ * @param[in] mac_addr MAC address of the entry.
+ * @param[in] port TX port of the entry.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_classifier_entry(enum sppwk_action wk_action, int vid,
+		uint64_t mac_addr, const struct sppwk_port_info *port);
+
+/**
+ * Replace ACLs of flow rules of all of running classifiers which have given
+ * TX port with new ones built from current rules, without rebuilding the
+ * classifiers. Old ACLs are released asynchronously after all of workers
+ * pass through quiescent state. It fails if ACLs cannot be replaced in this
+ * way, and the classifiers should be rebuilt instead.
+ *
+ * @param[in] port TX port of which flow rules are updated.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_classifier_flows(const struct sppwk_port_info *port);
+
 /**
  * initialize classifier information.
  *
@@ -0,0 +1,555 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <unistd.h>
+#include <string.h>
+
+#include <rte_acl.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_log.h>
+#include <rte_byteorder.h>
+#include <rte_branch_prediction.h>
+
+#include "flow_classifier.h"
+#include "shared/secondary/return_codes.h"
+
+#define RTE_LOGTYPE_VF_FLOW_CLS RTE_LOGTYPE_USER1
+
+/* Index of IP version of ACL contexts. */
+enum cls_flow_ip_ver {
+	CLS_FLOW_IPV4,
+	CLS_FLOW_IPV6,
+};
+
+/* Fields of ACL rule for IPv4. */
+enum {
+	FLOW4_PROTO,
+	FLOW4_SRC,
+	FLOW4_DST,
+	FLOW4_SPORT,
+	FLOW4_DPORT,
+	NOF_FLOW4_FIELDS,
+};
+
+/* Fields of ACL rule for IPv6. Each of addresses is split into 4 words. */
+enum {
+	FLOW6_PROTO,
+	FLOW6_SRC0,
+	FLOW6_DST0 = FLOW6_SRC0 + 4,
+	FLOW6_SPORT = FLOW6_DST0 + 4,
+	FLOW6_DPORT,
+	NOF_FLOW6_FIELDS,
+};
+
+RTE_ACL_RULE_DEF(cls_flow_rule4, NOF_FLOW4_FIELDS);
+RTE_ACL_RULE_DEF(cls_flow_rule6, NOF_FLOW6_FIELDS);
+
+/* Offset of field of IPv4 from protocol which is the first one. */
+#define FLOW4_OFS(member) (offsetof(struct rte_ipv4_hdr, member) - \
+		offsetof(struct rte_ipv4_hdr, next_proto_id))
+#define FLOW4_L4_OFS (sizeof(struct rte_ipv4_hdr) - \
+		offsetof(struct rte_ipv4_hdr, next_proto_id))
+
+/* Offset of field of IPv6 from protocol which is the first one. */
+#define FLOW6_OFS(member) (offsetof(struct rte_ipv6_hdr, member) - \
+		offsetof(struct rte_ipv6_hdr, proto))
+#define FLOW6_L4_OFS (sizeof(struct rte_ipv6_hdr) - \
+		offsetof(struct rte_ipv6_hdr, proto))
+
+/* Define field of ACL rule. */
+#define FLOW_FIELD(ftype, fsize, idx, input_idx, ofs) { \
+		.type = (ftype), \
+		.size = (fsize), \
+		.field_index = (idx), \
+		.input_index = (input_idx), \
+		.offset = (ofs), \
+	}
+
+static const struct rte_acl_field_def flow4_defs[NOF_FLOW4_FIELDS] = {
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_BITMASK, sizeof(uint8_t),
+			FLOW4_PROTO, 0, 0),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW4_SRC, 1, FLOW4_OFS(src_addr)),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW4_DST, 2, FLOW4_OFS(dst_addr)),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t),
+			FLOW4_SPORT, 3, FLOW4_L4_OFS),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t),
+			FLOW4_DPORT, 3, FLOW4_L4_OFS + sizeof(uint16_t)),
+};
+
+static const struct rte_acl_field_def flow6_defs[NOF_FLOW6_FIELDS] = {
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_BITMASK, sizeof(uint8_t),
+			FLOW6_PROTO, 0, 0),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_SRC0, 1, FLOW6_OFS(src_addr)),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_SRC0 + 1, 2, FLOW6_OFS(src_addr) + 4),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_SRC0 + 2, 3, FLOW6_OFS(src_addr) + 8),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_SRC0 + 3, 4, FLOW6_OFS(src_addr) + 12),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_DST0, 5, FLOW6_OFS(dst_addr)),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_DST0 + 1, 6, FLOW6_OFS(dst_addr) + 4),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_DST0 + 2, 7, FLOW6_OFS(dst_addr) + 8),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t),
+			FLOW6_DST0 + 3, 8, FLOW6_OFS(dst_addr) + 12),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t),
+			FLOW6_SPORT, 9, FLOW6_L4_OFS),
+	FLOW_FIELD(RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t),
+			FLOW6_DPORT, 9, FLOW6_L4_OFS + sizeof(uint16_t)),
+};
+
+/* Flow rule and its TX port. */
+struct cls_flow_entry {
+	struct sppwk_flow_rule rule;
+	struct sppwk_port_idx port;
+};
+
+/**
+ * Flow rules of all ports in order of adding. Former one has higher
+ * priority if several rules are matched. It is referred only from command
+ * thread, and workers refer ACL contexts built from it.
+ */
+static struct cls_flow_entry cls_flow_entries[CLS_FLOW_RULES_MAX];
+static int nof_cls_flow_entries;
+
+/* Buffers of ACL rules used while building contexts. */
+static struct cls_flow_rule4 acl4_rules[CLS_FLOW_RULES_MAX];
+static struct cls_flow_rule6 acl6_rules[CLS_FLOW_RULES_MAX];
+
+/* Count used for making unique name of ACL context. */
+static uint16_t cls_flow_acl_count;
+
+/* Get index of given rule in flow rules, or -1 if not found. */
+static int
+find_cls_flow_entry(const struct sppwk_flow_rule *rule)
+{
+	int i;
+
+	for (i = 0; i < nof_cls_flow_entries; i++) {
+		if (memcmp(&cls_flow_entries[i].rule, rule,
+				sizeof(*rule)) == 0)
+			return i;
+	}
+	return -1;
+}
+
+/* Return 1 as true if the same rule is given twice. */
+static int
+has_dup_flow_rules(const struct sppwk_flow_rule *rules, int nof_rules)
+{
+	int i, j;
+
+	for (i = 0; i < nof_rules; i++) {
+		for (j = 0; j < i; j++) {
+			if (memcmp(&rules[i], &rules[j],
+					sizeof(rules[i])) == 0)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+/* Add flow rules for given TX port. */
+int
+add_cls_flow_rules(const struct sppwk_flow_rule *rules, int nof_rules,
+		const struct sppwk_port_idx *port)
+{
+	int i;
+	struct cls_flow_entry *ent;
+
+	if (unlikely(nof_cls_flow_entries + nof_rules > CLS_FLOW_RULES_MAX)) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "No room for %d flow rules.\n",
+				nof_rules);
+		return SPPWK_RET_NG;
+	}
+
+	if (unlikely(has_dup_flow_rules(rules, nof_rules))) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "Same flow rule is given twice.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (i = 0; i < nof_rules; i++) {
+		if (unlikely(find_cls_flow_entry(&rules[i]) >= 0)) {
+			RTE_LOG(ERR, VF_FLOW_CLS,
+					"Flow rule is already added.\n");
+			return SPPWK_RET_NG;
+		}
+	}
+
+	for (i = 0; i < nof_rules; i++) {
+		ent = &cls_flow_entries[nof_cls_flow_entries++];
+		ent->rule = rules[i];
+		ent->port = *port;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Delete flow rules of given TX port. */
+int
+del_cls_flow_rules(const struct sppwk_flow_rule *rules, int nof_rules,
+		const struct sppwk_port_idx *port)
+{
+	int i, idx;
+
+	if (unlikely(has_dup_flow_rules(rules, nof_rules))) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "Same flow rule is given twice.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (i = 0; i < nof_rules; i++) {
+		idx = find_cls_flow_entry(&rules[i]);
+		if (unlikely(idx < 0 ||
+				cls_flow_entries[idx].port.iface_type !=
+				port->iface_type ||
+				cls_flow_entries[idx].port.iface_no !=
+				port->iface_no)) {
+			RTE_LOG(ERR, VF_FLOW_CLS,
+					"Flow rule is not added for %d:%d.\n",
+					port->iface_type, port->iface_no);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	/* Keep order of remained rules for their priority. */
+	for (i = 0; i < nof_rules; i++) {
+		idx = find_cls_flow_entry(&rules[i]);
+		memmove(&cls_flow_entries[idx], &cls_flow_entries[idx + 1],
+				sizeof(cls_flow_entries[0]) *
+				(nof_cls_flow_entries - idx - 1));
+		nof_cls_flow_entries--;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get index of TX port of classifier, or -1 if not found. */
+static int
+get_flow_tx_idx(const struct sppwk_port_idx *port,
+		const struct cls_port_info *tx_ports, int nof_tx)
+{
+	int i;
+
+	for (i = 0; i < nof_tx; i++) {
+		if (tx_ports[i].iface_type == port->iface_type &&
+				tx_ports[i].iface_no_global == port->iface_no)
+			return i;
+	}
+	return -1;
+}
+
+/* Get value of 32 bits word of address in host byte order. */
+static inline uint32_t
+flow_addr_word(const uint8_t *addr, int word)
+{
+	uint32_t val;
+
+	memcpy(&val, addr + word * 4, sizeof(val));
+	return rte_be_to_cpu_32(val);
+}
+
+/* Get prefix length for 32 bits word of address. */
+static inline uint32_t
+flow_addr_word_len(uint8_t len, int word)
+{
+	int wlen = (int)len - word * 32;
+
+	return wlen < 0 ? 0 : (wlen > 32 ? 32 : (uint32_t)wlen);
+}
+
+/* Set fields of protocol and ports of ACL rule. */
+static void
+set_flow_rule_common(struct rte_acl_field *fields, int proto_idx,
+		int sport_idx, const struct sppwk_flow_rule *rule)
+{
+	fields[proto_idx].value.u8 = rule->proto;
+	fields[proto_idx].mask_range.u8 = rule->proto != 0 ? UINT8_MAX : 0;
+	fields[sport_idx].value.u16 = rule->sport_min;
+	fields[sport_idx].mask_range.u16 = rule->sport_max;
+	fields[sport_idx + 1].value.u16 = rule->dport_min;
+	fields[sport_idx + 1].mask_range.u16 = rule->dport_max;
+}
+
+/* Set ACL rule of IPv4 from flow rule. */
+static void
+set_flow4_rule(struct cls_flow_rule4 *acl_rule,
+		const struct sppwk_flow_rule *rule)
+{
+	set_flow_rule_common(acl_rule->field, FLOW4_PROTO, FLOW4_SPORT, rule);
+	acl_rule->field[FLOW4_SRC].value.u32 =
+		flow_addr_word(rule->src_addr, 0);
+	acl_rule->field[FLOW4_SRC].mask_range.u32 = rule->src_len;
+	acl_rule->field[FLOW4_DST].value.u32 =
+		flow_addr_word(rule->dst_addr, 0);
+	acl_rule->field[FLOW4_DST].mask_range.u32 = rule->dst_len;
+}
+
+/* Set ACL rule of IPv6 from flow rule. */
+static void
+set_flow6_rule(struct cls_flow_rule6 *acl_rule,
+		const struct sppwk_flow_rule *rule)
+{
+	int i;
+
+	set_flow_rule_common(acl_rule->field, FLOW6_PROTO, FLOW6_SPORT, rule);
+	for (i = 0; i < 4; i++) {
+		acl_rule->field[FLOW6_SRC0 + i].value.u32 =
+			flow_addr_word(rule->src_addr, i);
+		acl_rule->field[FLOW6_SRC0 + i].mask_range.u32 =
+			flow_addr_word_len(rule->src_len, i);
+		acl_rule->field[FLOW6_DST0 + i].value.u32 =
+			flow_addr_word(rule->dst_addr, i);
+		acl_rule->field[FLOW6_DST0 + i].mask_range.u32 =
+			flow_addr_word_len(rule->dst_len, i);
+	}
+}
+
+/* Create and build ACL context from given rules. */
+static struct rte_acl_ctx *
+create_flow_acl(const char *ver_str, const struct rte_acl_rule *acl_rules,
+		int nof_rules, const struct rte_acl_field_def *defs,
+		int nof_fields, int socket_id)
+{
+	int ret;
+	char name[RTE_ACL_NAMESIZE];
+	struct rte_acl_ctx *ctx;
+	struct rte_acl_config cfg;
+	struct rte_acl_param param = {
+		.name = name,
+		.socket_id = socket_id,
+		.rule_size = RTE_ACL_RULE_SZ(nof_fields),
+		.max_rule_num = nof_rules,
+	};
+
+	/* make ACL name(require uniqueness between processes) */
+	snprintf(name, sizeof(name), "clsacl%s_%07x%04hx", ver_str, getpid(),
+			cls_flow_acl_count++);
+
+	ctx = rte_acl_create(&param);
+	if (unlikely(ctx == NULL)) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "Cannot create ACL. name=%s\n",
+				name);
+		return NULL;
+	}
+
+	ret = rte_acl_add_rules(ctx, acl_rules, nof_rules);
+	if (unlikely(ret != 0)) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "Cannot add rules to ACL. "
+				"ret=%d, name=%s\n", ret, name);
+		rte_acl_free(ctx);
+		return NULL;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_categories = 1;
+	cfg.num_fields = nof_fields;
+	memcpy(cfg.defs, defs, sizeof(defs[0]) * nof_fields);
+	ret = rte_acl_build(ctx, &cfg);
+	if (unlikely(ret != 0)) {
+		RTE_LOG(ERR, VF_FLOW_CLS, "Cannot build ACL. "
+				"ret=%d, name=%s\n", ret, name);
+		rte_acl_free(ctx);
+		return NULL;
+	}
+
+	RTE_LOG(INFO, VF_FLOW_CLS, "Build ACL. name=%s, rules=%d, socket=%d\n",
+			name, nof_rules, socket_id);
+	return ctx;
+}
+
+/* Build ACL contexts of IPv4 and IPv6 from flow rules of TX ports. */
+int
+build_cls_flow_acls(struct rte_acl_ctx **acls,
+		const struct cls_port_info *tx_ports, int nof_tx,
+		int socket_id)
+{
+	int i, tx_idx;
+	int nof_rules4 = 0, nof_rules6 = 0;
+	struct rte_acl_rule_data data;
+	const struct cls_flow_entry *ent;
+
+	acls[CLS_FLOW_IPV4] = NULL;
+	acls[CLS_FLOW_IPV6] = NULL;
+
+	memset(acl4_rules, 0, sizeof(acl4_rules[0]) * nof_cls_flow_entries);
+	memset(acl6_rules, 0, sizeof(acl6_rules[0]) * nof_cls_flow_entries);
+	for (i = 0; i < nof_cls_flow_entries; i++) {
+		ent = &cls_flow_entries[i];
+		tx_idx = get_flow_tx_idx(&ent->port, tx_ports, nof_tx);
+		if (tx_idx < 0)
+			continue;
+
+		/* Userdata 0 is for no match, so index is incremented. */
+		data.category_mask = 1;
+		data.priority = RTE_ACL_MAX_PRIORITY - i;
+		data.userdata = (uint32_t)tx_idx + 1;
+
+		if (ent->rule.ip_ver != 6) {
+			acl4_rules[nof_rules4].data = data;
+			set_flow4_rule(&acl4_rules[nof_rules4++], &ent->rule);
+		}
+		if (ent->rule.ip_ver != 4) {
+			acl6_rules[nof_rules6].data = data;
+			set_flow6_rule(&acl6_rules[nof_rules6++], &ent->rule);
+		}
+	}
+
+	if (nof_rules4 > 0) {
+		acls[CLS_FLOW_IPV4] = create_flow_acl("4",
+				(const struct rte_acl_rule *)acl4_rules,
+				nof_rules4, flow4_defs, NOF_FLOW4_FIELDS,
+				socket_id);
+		if (unlikely(acls[CLS_FLOW_IPV4] == NULL))
+			return SPPWK_RET_NG;
+	}
+	if (nof_rules6 > 0) {
+		acls[CLS_FLOW_IPV6] = create_flow_acl("6",
+				(const struct rte_acl_rule *)acl6_rules,
+				nof_rules6, flow6_defs, NOF_FLOW6_FIELDS,
+				socket_id);
+		if (unlikely(acls[CLS_FLOW_IPV6] == NULL)) {
+			free_cls_flow_acls(acls);
+			return SPPWK_RET_NG;
+		}
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Release ACL contexts of IPv4 and IPv6. */
+void
+free_cls_flow_acls(struct rte_acl_ctx **acls)
+{
+	int i;
+
+	for (i = CLS_FLOW_IPV4; i <= CLS_FLOW_IPV6; i++) {
+		if (acls[i] != NULL)
+			rte_acl_free(acls[i]);
+		acls[i] = NULL;
+	}
+}
+
+/**
+ * Get IP version of packet and pointer to the first field of ACL, or 0 if
+ * the packet cannot be classified with flow rules. IPv4 packet with options
+ * or non-first fragment is not classified because ports are not found at
+ * fixed offset.
+ */
+static inline int
+get_flow_data(struct rte_mbuf *pkt, const uint8_t **data)
+{
+	uint32_t l2_len = sizeof(struct rte_ether_hdr);
+	uint16_t ether_type;
+	struct rte_ether_hdr *eth;
+	struct rte_vlan_hdr *vh;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+
+	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	ether_type = eth->ether_type;
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN)) {
+		vh = (struct rte_vlan_hdr *)(eth + 1);
+		ether_type = vh->eth_proto;
+		l2_len += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)) {
+		if (unlikely(rte_pktmbuf_data_len(pkt) < l2_len +
+				sizeof(struct rte_ipv4_hdr) +
+				sizeof(uint32_t)))
+			return 0;
+		ip4 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv4_hdr *,
+				l2_len);
+		if (unlikely((ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) !=
+				sizeof(struct rte_ipv4_hdr) /
+				RTE_IPV4_IHL_MULTIPLIER ||
+				(ip4->fragment_offset & rte_cpu_to_be_16(
+				RTE_IPV4_HDR_OFFSET_MASK)) != 0))
+			return 0;
+		*data = &ip4->next_proto_id;
+		return 4;
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6)) {
+		if (unlikely(rte_pktmbuf_data_len(pkt) < l2_len +
+				sizeof(struct rte_ipv6_hdr) +
+				sizeof(uint32_t)))
+			return 0;
+		ip6 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv6_hdr *,
+				l2_len);
+		*data = &ip6->proto;
+		return 6;
+	}
+
+	return 0;
+}
+
+/* Classify a burst of packets with flow rules. */
+int
+classify_cls_flows(struct rte_acl_ctx * const *acls,
+		struct rte_mbuf **pkts, int nof_pkts, int32_t *tx_idx)
+{
+	int i, ver;
+	int nof_matched = 0;
+	int nof_data[2] = { 0, 0 };
+	struct rte_acl_ctx *ctx[2];
+	const uint8_t *pkt_data = NULL;
+	const uint8_t *data[2][MAX_PKT_BURST];
+	int idx[2][MAX_PKT_BURST];
+	uint32_t res[MAX_PKT_BURST];
+
+	/* Refer each of contexts once because it can be replaced. */
+	ctx[CLS_FLOW_IPV4] = acls[CLS_FLOW_IPV4];
+	ctx[CLS_FLOW_IPV6] = acls[CLS_FLOW_IPV6];
+
+	for (i = 0; i < nof_pkts; i++) {
+		tx_idx[i] = -1;
+		switch (get_flow_data(pkts[i], &pkt_data)) {
+		case 4:
+			ver = CLS_FLOW_IPV4;
+			break;
+		case 6:
+			ver = CLS_FLOW_IPV6;
+			break;
+		default:
+			continue;
+		}
+		if (ctx[ver] == NULL)
+			continue;
+		data[ver][nof_data[ver]] = pkt_data;
+		idx[ver][nof_data[ver]++] = i;
+	}
+
+	for (ver = CLS_FLOW_IPV4; ver <= CLS_FLOW_IPV6; ver++) {
+		if (nof_data[ver] == 0)
+			continue;
+		if (unlikely(rte_acl_classify(ctx[ver], data[ver], res,
+				nof_data[ver], 1) != 0))
+			continue;
+		for (i = 0; i < nof_data[ver]; i++) {
+			if (res[i] == 0)
+				continue;
+			tx_idx[idx[ver][i]] = (int32_t)res[i] - 1;
+			nof_matched++;
+		}
+	}
+	return nof_matched;
+}
+
+/* Call given function for each of flow rules. */
+void
+iterate_cls_flow_rules(
+		void (*func)(const struct sppwk_flow_rule *rule,
+			const struct sppwk_port_idx *port, void *arg),
+		void *arg)
+{
+	int i;
+
+	for (i = 0; i < nof_cls_flow_entries; i++)
+		func(&cls_flow_entries[i].rule, &cls_flow_entries[i].port,
+				arg);
+}
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __FLOW_CLASSIFIER_H__
+#define __FLOW_CLASSIFIER_H__
+
+#include "shared/secondary/spp_worker_th/vf_deps.h"
+
+/**
+ * @file
+ * SPP Flow Classifier
+ *
+ * Flow classifier is a part of classifier which determines TX port of
+ * incoming IPv4 and IPv6 packets with rules of 5-tuple, protocol, source
+ * and destination addresses and ports, before classifying with MAC
+ * address. Rules are kept for each of TX ports, and compiled into ACL
+ * contexts of classifier which has the TX ports.
+ */
+
+/* Max num of flow rules of all ports. */
+#define CLS_FLOW_RULES_MAX 1024
+
+/**
+ * Add flow rules for given TX port. No rule is added if any of them is
+ * already added or no room for them.
+ *
+ * @param[in] rules Flow rules.
+ * @param[in] nof_rules Num of rules.
+ * @param[in] port TX port.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_cls_flow_rules(const struct sppwk_flow_rule *rules, int nof_rules,
+		const struct sppwk_port_idx *port);
+
+/**
+ * Delete flow rules of given TX port. No rule is deleted if any of them is
+ * not added for the port.
+ *
+ * @param[in] rules Flow rules.
+ * @param[in] nof_rules Num of rules.
+ * @param[in] port TX port.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int del_cls_flow_rules(const struct sppwk_flow_rule *rules, int nof_rules,
+		const struct sppwk_port_idx *port);
+
+/**
+ * Build ACL contexts of IPv4 and IPv6 from flow rules of given TX ports.
+ * Context is NULL for IP version without rules.
+ *
+ * @param[out] acls ACL contexts of IPv4 and IPv6.
+ * @param[in] tx_ports TX ports of classifier.
+ * @param[in] nof_tx Num of TX ports.
+ * @param[in] socket_id Socket ID of memory for contexts.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int build_cls_flow_acls(struct rte_acl_ctx **acls,
+		const struct cls_port_info *tx_ports, int nof_tx,
+		int socket_id);
+
+/**
+ * Release ACL contexts of IPv4 and IPv6.
+ *
+ * @param[in,out] acls ACL contexts of IPv4 and IPv6.
+ */
+void free_cls_flow_acls(struct rte_acl_ctx **acls);
+
+/**
+ * Classify a burst of packets with flow rules. Index of TX port of
+ * matched rule is set in `tx_idx` for each of packets, or -1 if no rule is
+ * matched.
+ *
+ * @param[in] acls ACL contexts of IPv4 and IPv6.
+ * @param[in] pkts Packets to be classified.
+ * @param[in] nof_pkts Num of packets.
+ * @param[out] tx_idx Index of TX port for each of packets.
+ * @return Num of packets matched.
+ */
+int classify_cls_flows(struct rte_acl_ctx * const *acls,
+		struct rte_mbuf **pkts, int nof_pkts, int32_t *tx_idx);
+
+/**
+ * Call given function for each of flow rules for `status` command.
+ *
+ * @param[in] func Function called with rule, TX port and `arg`.
+ * @param[in] arg Argument of function.
+ */
+void iterate_cls_flow_rules(
+		void (*func)(const struct sppwk_flow_rule *rule,
+			const struct sppwk_port_idx *port, void *arg),
+		void *arg);
+
+#endif /* __FLOW_CLASSIFIER_H__ */
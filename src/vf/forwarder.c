@@ -9,16 +9,15 @@
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-#include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
-
 #define RTE_LOGTYPE_FORWARD RTE_LOGTYPE_USER1
 
 /* A set of port info of rx and tx */
 struct forward_rxtx {
 	struct sppwk_port_info rx; /* rx port */
 	struct sppwk_port_info tx; /* tx port */
+	uint16_t rx_queue;  /* Queue of rx port */
+	uint16_t tx_queue;  /* Queue of tx port */
+	struct sppwk_tx_queue txq;  /* TX queue used by the lcore */
 };
 
 /* Information on the path used for forward. */
@@ -82,12 +81,14 @@ get_forwarder_status(unsigned int lcore_id, int id,
 	for (cnt = 0; cnt < fwd_path->nof_rx; cnt++) {
 		rx_ports[cnt].iface_type = fwd_path->ports[cnt].rx.iface_type;
 		rx_ports[cnt].iface_no = fwd_path->ports[cnt].rx.iface_no;
+		rx_ports[cnt].queue_id = fwd_path->ports[cnt].rx_queue;
 	}
 
 	memset(tx_ports, 0x00, sizeof(tx_ports));
 	for (cnt = 0; cnt < fwd_path->nof_tx; cnt++) {
 		tx_ports[cnt].iface_type = fwd_path->ports[cnt].tx.iface_type;
 		tx_ports[cnt].iface_no = fwd_path->ports[cnt].tx.iface_no;
+		tx_ports[cnt].queue_id = fwd_path->ports[cnt].tx_queue;
 	}
 
 	/* Set the information with the function specified by the command. */
@@ -108,6 +109,7 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	int nof_rx = comp_info->nof_rx;
 	int nof_tx = comp_info->nof_tx;
 	int max = (nof_rx > nof_tx)?nof_rx*nof_tx:nof_tx;
+	struct sppwk_tx_queue txq;
 	struct forward_info *fwd_info = &g_forward_info[comp_info->comp_id];
 	/* TODO(yasufum) rename `path` of struct forward_path. */
 	struct forward_path *fwd_path = &fwd_info->path[fwd_info->upd_index];
@@ -132,6 +134,12 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 		return SPPWK_RET_NG;
 	}
 
+	/* TX queue is shared with other lcores sending to the port. */
+	memset(&txq, 0x00, sizeof(txq));
+	if (nof_tx == 1 && unlikely(sppwk_get_tx_queue(comp_info, 0,
+			&txq) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
 	memset(fwd_path, 0x00, sizeof(struct forward_path));
 
 	RTE_LOG(INFO, FORWARD,
@@ -143,14 +151,19 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	fwd_path->wk_type = comp_info->wk_type;
 	fwd_path->nof_rx = comp_info->nof_rx;
 	fwd_path->nof_tx = comp_info->nof_tx;
-	for (cnt = 0; cnt < nof_rx; cnt++)
+	for (cnt = 0; cnt < nof_rx; cnt++) {
 		memcpy(&fwd_path->ports[cnt].rx, comp_info->rx_ports[cnt],
 				sizeof(struct sppwk_port_info));
+		fwd_path->ports[cnt].rx_queue = comp_info->rx_queues[cnt];
+	}
 
 	/* TX port is set according with larger nof_rx / nof_tx. */
-	for (cnt = 0; cnt < max; cnt++)
+	for (cnt = 0; cnt < max; cnt++) {
 		memcpy(&fwd_path->ports[cnt].tx, comp_info->tx_ports[0],
 				sizeof(struct sppwk_port_info));
+		fwd_path->ports[cnt].tx_queue = comp_info->tx_queues[0];
+		fwd_path->ports[cnt].txq = txq;
+	}
 
 	fwd_info->upd_index = fwd_info->ref_index;
 	while (likely(fwd_info->ref_index == fwd_info->upd_index))
@@ -212,27 +225,17 @@ forward_packets(int id)
 		rx = &path->ports[cnt].rx;
 		tx = &path->ports[cnt].tx;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		nb_rx = sppwk_eth_vlan_ring_stats_rx_burst(rx->ethdev_port_id,
-				rx->iface_type, rx->iface_no, 0,
-				bufs, MAX_PKT_BURST);
-#else
-		nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id, 0,
+		nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id,
+				path->ports[cnt].rx_queue,
 				bufs, MAX_PKT_BURST);
-#endif
 		if (unlikely(nb_rx == 0))
 			continue;
 
 		/* Send packets */
 		if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx = sppwk_eth_vlan_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, bufs, nb_rx);
-#else
 			nb_tx = sppwk_eth_vlan_tx_burst(tx->ethdev_port_id,
-					0, bufs, nb_rx);
-#endif
+					&path->ports[cnt].txq,
+					bufs, nb_rx);
 
 		/* Discard remained packets to release mbuf */
 		if (unlikely(nb_tx < nb_rx)) {
@@ -240,5 +243,10 @@ forward_packets(int id)
 				rte_pktmbuf_free(bufs[buf]);
 		}
 	}
+
+	/* Send packets staged by other lcores sharing the TX queue. */
+	tx = &path->ports[0].tx;
+	if (tx->ethdev_port_id >= 0)
+		sppwk_eth_tx_drain(tx->ethdev_port_id, &path->ports[0].txq);
 	return SPPWK_RET_OK;
 }
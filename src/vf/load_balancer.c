@@ -0,0 +1,671 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <netinet/in.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+#include <rte_thash.h>
+#include <rte_hash_crc.h>
+
+#include "load_balancer.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/json_helper.h"
+#include "shared/secondary/spp_worker_th/vf_deps.h"
+#include "shared/secondary/spp_worker_th/port_capability.h"
+
+#define RTE_LOGTYPE_LB RTE_LOGTYPE_USER1
+
+/* Mask for getting index of indirection table from hash value. */
+#define LB_RETA_MASK (LB_RETA_SIZE - 1)
+
+/* Length of RSS key of Toeplitz hash. */
+#define LB_RSS_KEY_LEN 40
+
+/* Num of packets prefetched ahead of calculating hash. */
+#define LB_PREFETCH_OFFSET 4
+
+/**
+ * List of hash function. The order of items should be same as the order of
+ * enum `sppwk_lb_hash_type` defined in cmd_utils.h.
+ */
+static const char *LB_HASH_STR_LIST[] = {
+	"none",
+	"toeplitz",
+	"crc",
+};
+
+/**
+ * RSS key of repeated 0x6d5a. Toeplitz hash with this key gives the same
+ * value for both directions of a flow because the key is periodic in 16 bits,
+ * so that swapping addresses and ports of source and destination does not
+ * change the hash. It is converted to the format of rte_softrss_be() at init.
+ */
+static uint8_t lb_rss_key[LB_RSS_KEY_LEN] __rte_aligned(4) = {
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+static uint8_t lb_rss_key_be[LB_RSS_KEY_LEN] __rte_aligned(4);
+
+/* Weight of TX port given by lb_table command. */
+struct lb_port_weight {
+	struct sppwk_port_idx port;
+	unsigned int weight;
+};
+
+/* TX port of entry of indirection table given by lb_table command. */
+struct lb_reta_entry {
+	int is_set;  /* 0 if the entry is assigned by weights. */
+	struct sppwk_port_idx port;
+};
+
+/* Configuration of load balancer given by lb_table command. */
+struct lb_conf {
+	enum sppwk_lb_hash_type hash_type;
+	int nof_weights;  /* Num of entries of weights. */
+	struct lb_port_weight weights[RTE_MAX_ETHPORTS];
+	struct lb_reta_entry reta[LB_RETA_SIZE];
+};
+
+/* TX port of load balancer and packets to be sent to. */
+struct lb_tx_port {
+	struct sppwk_port_info info;
+	uint16_t queue_id;  /* TX queue of the port. */
+	struct sppwk_tx_queue txq;  /* TX queue used by the lcore. */
+	unsigned int weight;  /* Weight of distribution, or 0 for unused. */
+	uint16_t nof_pkts;  /* Number of packets in pkts[]. */
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+};
+
+/* Information on the path used for load balancing. */
+struct lb_path {
+	char name[STR_LEN_NAME];  /* Component name */
+	enum sppwk_lb_hash_type hash_type;
+	int nof_rx;  /* Number of RX ports */
+	int nof_tx;  /* Number of TX ports */
+	int nof_active;  /* Number of TX ports of non-zero weight */
+	struct sppwk_port_info rx;  /* RX port */
+	uint16_t rx_queue;  /* Queue of RX port */
+	struct lb_tx_port tx[RTE_MAX_ETHPORTS];  /* TX ports */
+	uint8_t reta[LB_RETA_SIZE];  /* Indirection table of TX ports */
+};
+
+/* Information for load balancer. */
+struct lb_info {
+	volatile int ref_index; /* index to reference area */
+	volatile int upd_index; /* index to update area    */
+	struct lb_path path[TWO_SIDES];
+				/* Information of data path */
+};
+
+static struct lb_info g_lb_info[RTE_MAX_LCORE];
+static struct lb_conf g_lb_conf[RTE_MAX_LCORE];
+
+/* Clear g_lb_info, ref and update indices. */
+void
+init_load_balancer(void)
+{
+	int cnt = 0;
+	memset(&g_lb_info, 0x00, sizeof(g_lb_info));
+	memset(&g_lb_conf, 0x00, sizeof(g_lb_conf));
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		g_lb_info[cnt].ref_index = 0;
+		g_lb_info[cnt].upd_index = 1;
+	}
+
+	rte_convert_rss_key((const uint32_t *)lb_rss_key,
+			(uint32_t *)lb_rss_key_be, LB_RSS_KEY_LEN);
+}
+
+/* Clear hash function and weights of ports configured. */
+void
+init_lb_info(int comp_id)
+{
+	memset(&g_lb_conf[comp_id], 0x00, sizeof(struct lb_conf));
+}
+
+/* Set hash function of load balancer. */
+int
+set_lb_hash_type(int comp_id, enum sppwk_lb_hash_type hash_type)
+{
+	if (unlikely(hash_type != SPPWK_LB_HASH_TOEPLITZ &&
+			hash_type != SPPWK_LB_HASH_CRC)) {
+		RTE_LOG(ERR, LB, "Invalid hash function %d.\n", hash_type);
+		return SPPWK_RET_NG;
+	}
+
+	g_lb_conf[comp_id].hash_type = hash_type;
+	return SPPWK_RET_OK;
+}
+
+/* Get index of weight of given port, or -1 if not found. */
+static int
+get_lb_weight_idx(const struct lb_conf *conf, enum port_type iface_type,
+		int iface_no)
+{
+	int i;
+	for (i = 0; i < conf->nof_weights; i++) {
+		if (conf->weights[i].port.iface_type == iface_type &&
+				conf->weights[i].port.iface_no == iface_no)
+			return i;
+	}
+	return -1;
+}
+
+/* Set weight of TX port of load balancer. */
+int
+set_lb_port_weight(int comp_id, const struct sppwk_port_idx *port,
+		unsigned int weight)
+{
+	int idx;
+	struct lb_conf *conf = &g_lb_conf[comp_id];
+
+	if (unlikely(weight > SPPWK_LB_WEIGHT_MAX)) {
+		RTE_LOG(ERR, LB, "Invalid weight %u.\n", weight);
+		return SPPWK_RET_NG;
+	}
+
+	idx = get_lb_weight_idx(conf, port->iface_type, port->iface_no);
+	if (idx < 0) {
+		if (unlikely(conf->nof_weights >= RTE_MAX_ETHPORTS)) {
+			RTE_LOG(ERR, LB, "No space for weight of port.\n");
+			return SPPWK_RET_NG;
+		}
+		idx = conf->nof_weights++;
+		conf->weights[idx].port = *port;
+	}
+
+	conf->weights[idx].weight = weight;
+	return SPPWK_RET_OK;
+}
+
+/* Set TX port of entries of indirection table of load balancer. */
+int
+set_lb_reta(int comp_id, unsigned int first, unsigned int last,
+		const struct sppwk_port_idx *port)
+{
+	unsigned int i;
+	struct lb_conf *conf = &g_lb_conf[comp_id];
+
+	if (unlikely(first > last || last >= LB_RETA_SIZE)) {
+		RTE_LOG(ERR, LB, "Invalid entries of indirection table "
+				"from %u to %u.\n", first, last);
+		return SPPWK_RET_NG;
+	}
+
+	for (i = first; i <= last; i++) {
+		conf->reta[i].is_set = (port->iface_type != UNDEF);
+		conf->reta[i].port = *port;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get index of TX port of load balancer, or -1 if not found. */
+static int
+get_lb_tx_idx(const struct lb_path *path, const struct sppwk_port_idx *port)
+{
+	int i;
+	for (i = 0; i < path->nof_tx; i++) {
+		if (path->tx[i].info.iface_type == port->iface_type &&
+				path->tx[i].info.iface_no == port->iface_no)
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Assign entries of indirection table to TX ports in proportion to their
+ * weights with smooth weighted round robin, so that entries of a port are
+ * scattered over the table. Entries given by lb_table command are assigned
+ * to the port instead. Return the num of ports assigned.
+ */
+static int
+build_lb_reta(struct lb_path *path, const struct lb_conf *conf)
+{
+	int i, slot, best;
+	int nof_active = 0;
+	int total = 0;
+	int current[RTE_MAX_ETHPORTS];
+	int is_assigned[RTE_MAX_ETHPORTS];
+
+	memset(current, 0x00, sizeof(current));
+	memset(is_assigned, 0x00, sizeof(is_assigned));
+	for (i = 0; i < path->nof_tx; i++) {
+		if (path->tx[i].weight == 0)
+			continue;
+		total += path->tx[i].weight;
+	}
+
+	for (slot = 0; slot < LB_RETA_SIZE; slot++) {
+		best = -1;
+		if (conf->reta[slot].is_set)
+			best = get_lb_tx_idx(path, &conf->reta[slot].port);
+		if (best >= 0) {
+			path->reta[slot] = best;
+			is_assigned[best] = 1;
+			continue;
+		}
+
+		/* Load balancer is not used if a slot has no port to assign. */
+		if (total == 0)
+			return 0;
+
+		for (i = 0; i < path->nof_tx; i++) {
+			if (path->tx[i].weight == 0)
+				continue;
+			current[i] += path->tx[i].weight;
+			if (best < 0 || current[i] > current[best])
+				best = i;
+		}
+		current[best] -= total;
+		path->reta[slot] = best;
+		is_assigned[best] = 1;
+	}
+
+	for (i = 0; i < path->nof_tx; i++)
+		nof_active += is_assigned[i];
+	return nof_active;
+}
+
+/* Get load balancer status. */
+int
+get_lb_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *params)
+{
+	int ret = SPPWK_RET_NG;
+	int cnt;
+	struct lb_info *lb_info = &g_lb_info[id];
+	struct lb_path *lb_path = &lb_info->path[lb_info->ref_index];
+	struct sppwk_port_idx rx_ports[RTE_MAX_ETHPORTS];
+	struct sppwk_port_idx tx_ports[RTE_MAX_ETHPORTS];
+
+	memset(rx_ports, 0x00, sizeof(rx_ports));
+	if (lb_path->nof_rx > 0) {
+		rx_ports[0].iface_type = lb_path->rx.iface_type;
+		rx_ports[0].iface_no = lb_path->rx.iface_no;
+		rx_ports[0].queue_id = lb_path->rx_queue;
+	}
+
+	memset(tx_ports, 0x00, sizeof(tx_ports));
+	for (cnt = 0; cnt < lb_path->nof_tx; cnt++) {
+		tx_ports[cnt].iface_type = lb_path->tx[cnt].info.iface_type;
+		tx_ports[cnt].iface_no = lb_path->tx[cnt].info.iface_no;
+		tx_ports[cnt].queue_id = lb_path->tx[cnt].queue_id;
+	}
+
+	/* Set the information with the function specified by the command. */
+	ret = (*params->lcore_proc)(params, lcore_id, lb_path->name,
+			SPPWK_TYPE_LB_STR, lb_path->nof_rx, rx_ports,
+			lb_path->nof_tx, tx_ports);
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	return SPPWK_RET_OK;
+}
+
+/* Update load balancer info */
+int
+update_load_balancer(struct sppwk_comp_info *comp_info)
+{
+	int cnt, idx;
+	int nof_rx = comp_info->nof_rx;
+	int nof_tx = comp_info->nof_tx;
+	struct lb_info *lb_info = &g_lb_info[comp_info->comp_id];
+	struct lb_path *lb_path = &lb_info->path[lb_info->upd_index];
+	const struct lb_conf *conf = &g_lb_conf[comp_info->comp_id];
+
+	/* Load balancer has one RX port and several TX ports. */
+	if (unlikely(nof_rx > 1)) {
+		RTE_LOG(ERR, LB,
+			"Invalid num of RX ports of load balancer "
+			"(id=%d, nof_rx=%d).\n",
+			comp_info->comp_id, nof_rx);
+		return SPPWK_RET_NG;
+	}
+
+	memset(lb_path, 0x00, sizeof(struct lb_path));
+
+	RTE_LOG(INFO, LB,
+			"Start updating load balancer (id=%d, name=%s)\n",
+			comp_info->comp_id, comp_info->name);
+
+	memcpy(&lb_path->name, comp_info->name, STR_LEN_NAME);
+	lb_path->hash_type = conf->hash_type;
+	if (lb_path->hash_type == SPPWK_LB_HASH_NONE)
+		lb_path->hash_type = SPPWK_LB_HASH_TOEPLITZ;
+	lb_path->nof_rx = nof_rx;
+	lb_path->nof_tx = nof_tx;
+	if (nof_rx > 0) {
+		memcpy(&lb_path->rx, comp_info->rx_ports[0],
+				sizeof(struct sppwk_port_info));
+		lb_path->rx_queue = comp_info->rx_queues[0];
+	}
+
+	for (cnt = 0; cnt < nof_tx; cnt++) {
+		memcpy(&lb_path->tx[cnt].info, comp_info->tx_ports[cnt],
+				sizeof(struct sppwk_port_info));
+		lb_path->tx[cnt].queue_id = comp_info->tx_queues[cnt];
+		if (unlikely(sppwk_get_tx_queue(comp_info, cnt,
+				&lb_path->tx[cnt].txq) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+		idx = get_lb_weight_idx(conf,
+				comp_info->tx_ports[cnt]->iface_type,
+				comp_info->tx_ports[cnt]->iface_no);
+		lb_path->tx[cnt].weight =
+				(idx < 0) ? 1 : conf->weights[idx].weight;
+	}
+	lb_path->nof_active = build_lb_reta(lb_path, conf);
+
+	lb_info->upd_index = lb_info->ref_index;
+	while (likely(lb_info->ref_index == lb_info->upd_index))
+		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+
+	RTE_LOG(INFO, LB,
+			"Done update load balancer. (id=%d, name=%s)\n",
+			comp_info->comp_id, comp_info->name);
+
+	return SPPWK_RET_OK;
+}
+
+/* Change index of load balancer info */
+static inline void
+change_lb_index(int id)
+{
+	struct lb_info *info = &g_lb_info[id];
+	if (info->ref_index == info->upd_index) {
+		/* Change reference index of port ability. */
+		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
+
+		info->ref_index = (info->upd_index+1) % TWO_SIDES;
+	}
+}
+
+/* Hash of an endpoint of a flow, combined with the other one with XOR. */
+static inline uint32_t
+lb_crc_endpoint(const void *addr, uint32_t len, uint16_t port)
+{
+	return rte_hash_crc_2byte(port, rte_hash_crc(addr, len, 0));
+}
+
+/**
+ * Calculate symmetric hash of the flow of packet. L4 ports are included only
+ * for TCP, UDP and SCTP of non-fragmented packet, so that all of fragments
+ * of a flow are transferred to the same port. Packet other than IP is
+ * hashed with MAC addresses.
+ */
+static inline uint32_t
+lb_hash_packet(struct rte_mbuf *pkt, enum sppwk_lb_hash_type hash_type)
+{
+	uint32_t l2_len = sizeof(struct rte_ether_hdr);
+	uint32_t l3_len;
+	uint32_t tuple_len;
+	uint16_t ether_type;
+	uint16_t sport = 0, dport = 0;
+	uint8_t proto;
+	const uint16_t *l4_ports = NULL;
+	struct rte_ether_hdr *eth;
+	struct rte_vlan_hdr *vh;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	union rte_thash_tuple tuple;
+
+	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	ether_type = eth->ether_type;
+	while ((ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) ||
+			ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_QINQ)) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_vlan_hdr)) {
+		vh = rte_pktmbuf_mtod_offset(pkt, struct rte_vlan_hdr *,
+				l2_len);
+		ether_type = vh->eth_proto;
+		l2_len += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_ipv4_hdr)) {
+		ip4 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv4_hdr *,
+				l2_len);
+		proto = ip4->next_proto_id;
+		l3_len = (ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+				RTE_IPV4_IHL_MULTIPLIER;
+		if ((ip4->fragment_offset & rte_cpu_to_be_16(
+				RTE_IPV4_HDR_OFFSET_MASK |
+				RTE_IPV4_HDR_MF_FLAG)) == 0 &&
+				(proto == IPPROTO_TCP || proto == IPPROTO_UDP ||
+				proto == IPPROTO_SCTP) &&
+				rte_pktmbuf_data_len(pkt) >=
+				l2_len + l3_len + sizeof(uint32_t)) {
+			l4_ports = rte_pktmbuf_mtod_offset(pkt, uint16_t *,
+					l2_len + l3_len);
+			sport = rte_be_to_cpu_16(l4_ports[0]);
+			dport = rte_be_to_cpu_16(l4_ports[1]);
+		}
+
+		if (hash_type == SPPWK_LB_HASH_CRC)
+			return rte_hash_crc_1byte(proto,
+					lb_crc_endpoint(&ip4->src_addr,
+						sizeof(ip4->src_addr), sport) ^
+					lb_crc_endpoint(&ip4->dst_addr,
+						sizeof(ip4->dst_addr), dport));
+
+		tuple.v4.src_addr = rte_be_to_cpu_32(ip4->src_addr);
+		tuple.v4.dst_addr = rte_be_to_cpu_32(ip4->dst_addr);
+		tuple.v4.sport = sport;
+		tuple.v4.dport = dport;
+		tuple_len = (l4_ports != NULL) ?
+				RTE_THASH_V4_L4_LEN : RTE_THASH_V4_L3_LEN;
+		return rte_softrss_be((uint32_t *)&tuple, tuple_len,
+				lb_rss_key_be);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) &&
+			rte_pktmbuf_data_len(pkt) >=
+			l2_len + sizeof(struct rte_ipv6_hdr)) {
+		ip6 = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv6_hdr *,
+				l2_len);
+		proto = ip6->proto;
+		/* Extension headers are not followed for L4 ports. */
+		if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP ||
+				proto == IPPROTO_SCTP) &&
+				rte_pktmbuf_data_len(pkt) >= l2_len +
+				sizeof(struct rte_ipv6_hdr) +
+				sizeof(uint32_t)) {
+			l4_ports = (const uint16_t *)(ip6 + 1);
+			sport = rte_be_to_cpu_16(l4_ports[0]);
+			dport = rte_be_to_cpu_16(l4_ports[1]);
+		}
+
+		if (hash_type == SPPWK_LB_HASH_CRC)
+			return rte_hash_crc_1byte(proto,
+					lb_crc_endpoint(ip6->src_addr,
+						sizeof(ip6->src_addr), sport) ^
+					lb_crc_endpoint(ip6->dst_addr,
+						sizeof(ip6->dst_addr), dport));
+
+		rte_thash_load_v6_addrs(ip6, &tuple);
+		tuple.v6.sport = sport;
+		tuple.v6.dport = dport;
+		tuple_len = (l4_ports != NULL) ?
+				RTE_THASH_V6_L4_LEN : RTE_THASH_V6_L3_LEN;
+		return rte_softrss_be((uint32_t *)&tuple, tuple_len,
+				lb_rss_key_be);
+	}
+
+	return lb_crc_endpoint(&eth->s_addr, sizeof(eth->s_addr), 0) ^
+			lb_crc_endpoint(&eth->d_addr, sizeof(eth->d_addr), 0);
+}
+
+/* Send packets buffered for TX port and discard remained ones. */
+static inline void
+send_lb_packets(struct lb_tx_port *tx)
+{
+	int buf;
+	int nb_tx = 0;
+
+	if (tx->info.ethdev_port_id >= 0)
+		nb_tx = sppwk_eth_vlan_tx_burst(tx->info.ethdev_port_id,
+				&tx->txq, tx->pkts, tx->nof_pkts);
+
+	/* Discard remained packets to release mbuf */
+	if (unlikely(nb_tx < tx->nof_pkts)) {
+		for (buf = nb_tx; buf < tx->nof_pkts; buf++)
+			rte_pktmbuf_free(tx->pkts[buf]);
+	}
+	tx->nof_pkts = 0;
+}
+
+/* Distribute packets received from RX port to TX ports. */
+int
+balance_packets(int id)
+{
+	int cnt;
+	int nb_rx = 0;
+	uint32_t hash;
+	struct lb_info *info = &g_lb_info[id];
+	struct lb_path *path = NULL;
+	struct sppwk_port_info *rx;
+	struct lb_tx_port *tx;
+	struct rte_mbuf *bufs[MAX_PKT_BURST];
+
+	change_lb_index(id);
+	path = &info->path[info->ref_index];
+
+	/* Practice condition check */
+	if (!(path->nof_rx == 1 && path->nof_active > 0))
+		return SPPWK_RET_OK;
+
+	/* Send packets staged by other lcores sharing TX queues. */
+	for (cnt = 0; cnt < path->nof_tx; cnt++)
+		sppwk_eth_tx_drain(path->tx[cnt].info.ethdev_port_id,
+				&path->tx[cnt].txq);
+
+	rx = &path->rx;
+	nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id, path->rx_queue,
+			bufs, MAX_PKT_BURST);
+	if (unlikely(nb_rx == 0))
+		return SPPWK_RET_OK;
+
+	for (cnt = 0; cnt < LB_PREFETCH_OFFSET && cnt < nb_rx; cnt++)
+		rte_prefetch0(rte_pktmbuf_mtod(bufs[cnt], void *));
+
+	for (cnt = 0; cnt < nb_rx; cnt++) {
+		if (cnt + LB_PREFETCH_OFFSET < nb_rx)
+			rte_prefetch0(rte_pktmbuf_mtod(
+					bufs[cnt + LB_PREFETCH_OFFSET],
+					void *));
+		hash = lb_hash_packet(bufs[cnt], path->hash_type);
+		tx = &path->tx[path->reta[hash & LB_RETA_MASK]];
+		tx->pkts[tx->nof_pkts++] = bufs[cnt];
+	}
+
+	for (cnt = 0; cnt < path->nof_tx; cnt++) {
+		tx = &path->tx[cnt];
+		if (tx->nof_pkts > 0)
+			send_lb_packets(tx);
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Add hash function, weights and num of entries of indirection table of TX
+ * ports of a load balancer in JSON.
+ */
+static int
+append_lb_table_value(char **output, const struct lb_path *path)
+{
+	int ret, cnt, slot;
+	unsigned int nof_entries[RTE_MAX_ETHPORTS];
+	char port_str[CMD_TAG_APPEND_SIZE];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	char *weights_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	char *port_buff = NULL;
+
+	if (unlikely(tmp_buff == NULL || weights_buff == NULL)) {
+		RTE_LOG(ERR, LB, "Failed to alloc buff.\n");
+		spp_strbuf_free(tmp_buff);
+		spp_strbuf_free(weights_buff);
+		return SPPWK_RET_NG;
+	}
+
+	memset(nof_entries, 0x00, sizeof(nof_entries));
+	if (path->nof_active > 0) {
+		for (slot = 0; slot < LB_RETA_SIZE; slot++)
+			nof_entries[path->reta[slot]]++;
+	}
+
+	ret = append_json_str_value(&tmp_buff, "name", path->name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "hash",
+				LB_HASH_STR_LIST[path->hash_type]);
+
+	for (cnt = 0; cnt < path->nof_tx && ret == SPPWK_RET_OK; cnt++) {
+		port_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(port_buff == NULL)) {
+			RTE_LOG(ERR, LB, "Failed to alloc buff.\n");
+			ret = SPPWK_RET_NG;
+			break;
+		}
+
+		sppwk_port_uid(port_str, path->tx[cnt].info.iface_type,
+				path->tx[cnt].info.iface_no);
+		ret = append_json_str_value(&port_buff, "port", port_str);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint_value(&port_buff, "weight",
+					path->tx[cnt].weight);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint_value(&port_buff, "reta",
+					nof_entries[cnt]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_block_brackets(&weights_buff, "",
+					port_buff);
+		spp_strbuf_free(port_buff);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(&tmp_buff, "weights",
+				weights_buff);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+
+	spp_strbuf_free(weights_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add hash function and weights of each of load balancers in JSON. */
+int
+add_lb_table(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int id;
+	int ret = SPPWK_RET_OK;
+	struct lb_info *info;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, LB, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (id = 0; id < RTE_MAX_LCORE && ret == SPPWK_RET_OK; id++) {
+		if (sppwk_get_comp_type(id) != SPPWK_TYPE_LB)
+			continue;
+
+		info = &g_lb_info[id];
+		ret = append_lb_table_value(&tmp_buff,
+				&info->path[info->ref_index]);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
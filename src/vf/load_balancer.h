@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __LOAD_BALANCER_H__
+#define __LOAD_BALANCER_H__
+
+#include "shared/secondary/spp_worker_th/cmd_utils.h"
+
+/**
+ * @file
+ * SPP Load Balancer
+ *
+ * Load balancer component provides packet forwarding function from one
+ * port to several ports. It calculates symmetric hash of the flow tuple of
+ * incoming packet, IP addresses, protocol and L4 ports, and determines TX
+ * port from indirection table of which entries are assigned to TX ports in
+ * proportion to their weights. Packets of a flow and of its reverse
+ * direction are always transferred to the same port.
+ */
+
+/* Num of entries of indirection table, must be power of 2. */
+#define LB_RETA_SIZE SPPWK_LB_RETA_SIZE
+
+/* Clear g_lb_info, ref and update indices. */
+void init_load_balancer(void);
+
+/**
+ * Clear hash function and weights of ports configured for load balancer.
+ *
+ * @param[in] comp_id Unique component ID.
+ */
+void init_lb_info(int comp_id);
+
+/**
+ * Set hash function of load balancer. It is activated by updating the
+ * component.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] hash_type Hash function.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_lb_hash_type(int comp_id, enum sppwk_lb_hash_type hash_type);
+
+/**
+ * Set weight of TX port of load balancer. Port without weight is given 1,
+ * and port of weight 0 is not used for distribution. It can be set before
+ * the port is attached, and is activated by updating the component.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] port TX port.
+ * @param[in] weight Weight of the port.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_lb_port_weight(int comp_id, const struct sppwk_port_idx *port,
+		unsigned int weight);
+
+/**
+ * Assign entries of indirection table from `first` to `last` to TX port,
+ * instead of assigning them in proportion to weights. Entries are assigned
+ * by weights again if `port` is UNDEF. The port of entry must be a TX port
+ * of the component when it is updated, or the entry is assigned by weights.
+ *
+ * @param[in] comp_id Unique component ID.
+ * @param[in] first First index of entries.
+ * @param[in] last Last index of entries.
+ * @param[in] port TX port, or UNDEF for assigning by weights.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_lb_reta(int comp_id, unsigned int first, unsigned int last,
+		const struct sppwk_port_idx *port);
+
+/**
+ * Distribute packets received from RX port to TX ports.
+ *
+ * @param[in] id Unique component ID.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int balance_packets(int id);
+
+/**
+ * Get load balancer status.
+ *
+ * @param[in] lcore_id Lcore ID for load balancer.
+ * @param[in] id Unique component ID.
+ * @param[in,out] params Pointer to detailed data of load balancer status.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int get_lb_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *params);
+
+/**
+ * Add hash function, weights of TX ports and indirection table of each of
+ * load balancers for `status` command.
+ *
+ * @param[in] name Name of the entry in JSON.
+ * @param[in,out] output Buffer of JSON to be appended.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_lb_table(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+#endif /* __LOAD_BALANCER_H__ */
@@ -6,8 +6,11 @@
 #include <arpa/inet.h>
 #include <getopt.h>
 
+#include <rte_cycles.h>
+
 #include "classifier.h"
 #include "forwarder.h"
+#include "load_balancer.h"
 #include "shared/secondary/common.h"
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
@@ -16,12 +19,14 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/port_stats.h"
+#include "shared/secondary/spp_worker_th/telemetry.h"
+#include "shared/idle_policy.h"
+#include "shared/chain_trace.h"
 
 #define RTE_LOGTYPE_SPP_VF RTE_LOGTYPE_USER1
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
 
 /* getopt_long return value for long option */
 enum SPP_LONGOPT_RETVAL {
@@ -29,7 +34,9 @@ enum SPP_LONGOPT_RETVAL {
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT,  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_QUEUES,  /* For `--vhost-queues` */
+	SPP_LONGOPT_RETVAL_IDLE_POLICY  /* For `--idle-policy` */
 };
 
 /* Declare global variables */
@@ -58,11 +65,18 @@ usage(const char *progname)
 	RTE_LOG(INFO, SPP_VF, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--vhost-queues NUM]"
+			" [--idle-policy PAUSE,SLEEP,MAX_US]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  :"
 			" Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --vhost-queues NUM        :"
+			" Num of RX and TX queues of vhost\n"
+			" --idle-policy PAUSE,SLEEP,MAX_US :"
+			" Num of empty polls to pause and to sleep,"
+			" and max usec of a sleep\n"
 			, progname);
 }
 
@@ -75,6 +89,7 @@ parse_app_args(int argc, char *argv[])
 	int ctl_port;  /* Port num to connect spp_ctl. */
 	int ret;
 	int cnt;
+	int nof_queues;  /* Num of queues of vhost. */
 	int option_index, opt;
 
 	int proc_flg = 0;
@@ -89,6 +104,10 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "vhost-queues", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_VHOST_QUEUES },
+			{ "idle-policy", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_IDLE_POLICY },
 			{ 0 },
 	};
 
@@ -120,6 +139,19 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_VHOST_QUEUES:
+			if ((spp_atoi(optarg, &nof_queues) != 0) ||
+					(set_vhost_nof_queues(nof_queues) != 0)) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_IDLE_POLICY:
+			if (parse_idle_policy(optarg) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			set_spp_ctl_ip(ctl_ip);
@@ -143,8 +175,9 @@ parse_app_args(int argc, char *argv[])
 	}
 	RTE_LOG(INFO, SPP_VF,
 			"Parsed app args (client_id=%d,server=%s:%d,"
-			"vhost_client=%d)\n",
-			cli_id, ctl_ip, ctl_port, get_vhost_cli_mode());
+			"vhost_client=%d,vhost_queues=%d)\n",
+			cli_id, ctl_ip, ctl_port, get_vhost_cli_mode(),
+			get_vhost_nof_queues());
 	return SPPWK_RET_OK;
 }
 
@@ -154,18 +187,30 @@ slave_main(void *arg __attribute__ ((unused)))
 {
 	int ret = 0;
 	int cnt = 0;
+	int online = 0;
 	unsigned int lcore_id = rte_lcore_id();
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
 	struct core_mng_info *info = &g_core_info[lcore_id];
 	struct core_info *core = get_core_info(lcore_id);
+	struct sppwk_lcore_cnts *cnts = sppwk_lcore_cnts();
+	uint64_t start, nof_rx, nof_rx_poll;
+	struct idle_state idle = { 0 };
 
 	RTE_LOG(INFO, SPP_VF, "Slave started on lcore %d.\n", lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_IDLING);
+	cls_rcu_register(lcore_id);
 
 	while ((status = sppwk_get_lcore_status(lcore_id)) !=
 			SPPWK_LCORE_REQ_STOP) {
-		if (status != SPPWK_LCORE_RUNNING)
+		/* Be offline while not running to not block RCU updates. */
+		if (unlikely(online != (status == SPPWK_LCORE_RUNNING))) {
+			online = !online;
+			cls_rcu_set_online(lcore_id, online);
+		}
+		if (status != SPPWK_LCORE_RUNNING) {
+			idle_policy_stopped(&idle);
 			continue;
+		}
 
 		if (sppwk_is_lcore_updated(lcore_id) == 1) {
 			/* Setting with the flush command trigger. */
@@ -174,29 +219,42 @@ slave_main(void *arg __attribute__ ((unused)))
 		}
 
 		/* It is for processing multiple components. */
+		nof_rx_poll = cnts->nof_rx;
 		for (cnt = 0; cnt < core->num; cnt++) {
+			start = rte_rdtsc();
+			nof_rx = cnts->nof_rx;
+
 			/* Component classification to call a function. */
 			if (sppwk_get_comp_type(core->id[cnt]) ==
 					SPPWK_TYPE_CLS) {
 				/* Component type for classifier. */
 				ret = classify_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
+			} else if (sppwk_get_comp_type(core->id[cnt]) ==
+					SPPWK_TYPE_LB) {
+				/* Component type for load balancer. */
+				ret = balance_packets(core->id[cnt]);
 			} else {
 				/* Component type for forward or merge. */
 				ret = forward_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
 			}
+			if (unlikely(ret != 0))
+				break;
+
+			sppwk_cnt_cycles(core->id[cnt], rte_rdtsc() - start,
+					cnts->nof_rx - nof_rx);
 		}
+		cls_rcu_quiescent(lcore_id);
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, SPP_VF, "Failed to forward on lcore %d. "
 					"(id = %d).\n",
 					lcore_id, core->id[cnt]);
 			break;
 		}
+		idle_policy_poll(&idle, cnts->nof_rx - nof_rx_poll);
 	}
 
+	if (online)
+		cls_rcu_set_online(lcore_id, 0);
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
 	RTE_LOG(INFO, SPP_VF, "Terminated slave on lcore %d.\n", lcore_id);
 	return ret;
@@ -271,6 +329,7 @@ main(int argc, char *argv[])
 			break;
 
 		init_forwarder();
+		init_load_balancer();
 		sppwk_port_capability_init();
 
 		/* Setup connection for accepting commands from controller */
@@ -280,24 +339,13 @@ main(int argc, char *argv[])
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		int port_type, port_id;
-		char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
-		int nof_rings = 0;
-		for (int i = 0; i < RTE_MAX_ETHPORTS; i++) {
-			if (!rte_eth_dev_is_valid_port(i))
-				continue;
-			rte_eth_dev_get_name_by_port(i, dev_name);
-			ret = parse_dev_name(dev_name, &port_type, &port_id);
-			if (port_type == RING)
-				nof_rings++;
-		}
-		ret = sppwk_init_ring_latency_stats(
-				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL,
-				nof_rings);
+		sppwk_init_ring_latency_stats(
+				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL);
+		chain_trace_init(CHAIN_TRACE_SAMPLING_INTERVAL);
+
+		ret = sppwk_telemetry_init(get_client_id(), "vf");
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 
 		/* Start worker threads of classifier and forwarder */
 		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
@@ -331,10 +379,7 @@ main(int argc, char *argv[])
 			* Wait to avoid CPU overloaded.
 			*/
 			usleep(100);
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			print_ring_latency_stats(&g_iface_info);
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+			sppwk_telemetry_update(sppwk_fill_telemetry);
 		}
 
 		if (unlikely(ret != SPPWK_RET_OK)) {
@@ -358,9 +403,8 @@ main(int argc, char *argv[])
 	 */
 	del_vhost_sockfile(g_iface_info.vhost);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 	sppwk_clean_ring_latency_stats();
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+	chain_trace_clean();
 
 	RTE_LOG(INFO, SPP_VF, "Exit spp_vf.\n");
 	return ret;
@@ -3,10 +3,14 @@
  */
 
 #include "classifier.h"
+#include "flow_classifier.h"
 #include "forwarder.h"
+#include "load_balancer.h"
+#include "shared/chain_trace.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/port_stats.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
@@ -23,6 +27,7 @@ const char *CLS_TYPE_A_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"flow",
 	"",  /* termination */
 };
 
@@ -108,6 +113,118 @@ update_cls_table(enum sppwk_action wk_action,
 		strcpy(port_info->cls_attrs.mac_addr_str, mac_str);
 	}
 
+	/* Rebuild classifier only if cannot update live table directly. */
+	if (update_classifier_entry(wk_action, vid, mac_uint64,
+				port_info) == SPPWK_RET_OK)
+		return SPPWK_RET_OK;
+
+	set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
+	return SPPWK_RET_OK;
+}
+
+/* Update flow rules of classifier with given action, add or del. */
+static int
+update_cls_flow_table(enum sppwk_action wk_action, const char *rules_str,
+		const struct sppwk_port_idx *port)
+{
+	int ret, nof_rules;
+	struct sppwk_flow_rule rules[SPPWK_MAX_FLOW_RULES];
+	struct sppwk_port_info *port_info;
+
+	RTE_LOG(DEBUG, VF_CMD_RUNNER, "Called %s with "
+			"type `flow`, rules `%s`, and port `%d:%d`.\n",
+			__func__, rules_str, port->iface_type, port->iface_no);
+
+	nof_rules = sppwk_parse_flow_rules(rules_str, rules,
+			SPPWK_MAX_FLOW_RULES);
+	if (unlikely(nof_rules < 0)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Invalid flow rules `%s`.\n",
+				rules_str);
+		return SPPWK_RET_NG;
+	}
+
+	port_info = get_sppwk_port(port->iface_type, port->iface_no);
+	if (unlikely(port_info == NULL ||
+			port_info->iface_type == UNDEF)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Port %d:%d doesn't exist.\n",
+				port->iface_type, port->iface_no);
+		return SPPWK_RET_NG;
+	}
+
+	if (wk_action == SPPWK_ACT_ADD)
+		ret = add_cls_flow_rules(rules, nof_rules, port);
+	else
+		ret = del_cls_flow_rules(rules, nof_rules, port);
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	/* Rebuild classifier only if cannot replace ACLs directly. */
+	if (update_classifier_flows(port_info) == SPPWK_RET_OK)
+		return SPPWK_RET_OK;
+
+	set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Set hash function, weight of TX port or entries of indirection table of
+ * load balancer.
+ */
+static int
+update_lb_table(enum sppwk_cmd_type cmd_type,
+		const struct sppwk_lb_cmd_attrs *lb_attrs)
+{
+	int ret;
+	int comp_lcore_id;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	int *change_component = NULL;
+
+	comp_lcore_id = sppwk_get_lcore_id(lb_attrs->name);
+	if (unlikely(comp_lcore_id < 0)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Unknown component by lb_table "
+				"command. (component = %s)\n", lb_attrs->name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
+			&change_component, NULL);
+	if (unlikely((comp_info_base + comp_lcore_id)->wk_type !=
+			SPPWK_TYPE_LB)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Component `%s` is not "
+				"load balancer.\n", lb_attrs->name);
+		return SPPWK_RET_NG;
+	}
+
+	if (cmd_type == SPPWK_CMDTYPE_LB_HASH)
+		ret = set_lb_hash_type(comp_lcore_id, lb_attrs->hash_type);
+	else if (cmd_type == SPPWK_CMDTYPE_LB_RETA)
+		ret = set_lb_reta(comp_lcore_id, lb_attrs->reta_first,
+				lb_attrs->reta_last, &lb_attrs->port);
+	else
+		ret = set_lb_port_weight(comp_lcore_id, &lb_attrs->port,
+				lb_attrs->weight);
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	*(change_component + comp_lcore_id) = 1;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Set threshold of num of packets buffered for TX port by classifiers. It
+ * is applied to classifiers sending to the port at the next update.
+ */
+static int
+update_flush_thresh(const struct sppwk_flush_thresh_cmd_attrs *attrs)
+{
+	struct sppwk_port_info *port_info;
+
+	port_info = get_sppwk_port(attrs->port.iface_type,
+			attrs->port.iface_no);
+	if (unlikely(port_info == NULL))
+		return SPPWK_RET_NG;
+
+	port_info->flush_thresh = attrs->thresh;
 	set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
 	return SPPWK_RET_OK;
 }
@@ -116,12 +233,15 @@ update_cls_table(enum sppwk_action wk_action,
 /* TODO(yasufum) revise func name for removing term `component` or `comp`. */
 static int
 update_comp(enum sppwk_action wk_action, const char *name,
-		unsigned int lcore_id, enum sppwk_worker_type wk_type)
+		unsigned int lcore_id, enum sppwk_worker_type wk_type,
+		unsigned int cls_tbl_size)
 {
 	int ret;
 	int ret_del;
+	int cnt;
 	int comp_lcore_id = 0;
 	unsigned int tmp_lcore_id = 0;
+	enum sppwk_worker_type tmp_wk_type;
 	struct sppwk_comp_info *comp_info = NULL;
 	/* TODO(yasufum) revise `core` to be more specific. */
 	struct core_info *core = NULL;
@@ -163,10 +283,13 @@ update_comp(enum sppwk_action wk_action, const char *name,
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
+		memset(&g_sppwk_comp_cycles[comp_lcore_id], 0x00,
+				sizeof(struct poll_cycles));
 		strcpy(comp_info->name, name);
 		comp_info->wk_type = wk_type;
 		comp_info->lcore_id = lcore_id;
 		comp_info->comp_id = comp_lcore_id;
+		comp_info->cls_tbl_size = cls_tbl_size;
 
 		core->id[core->num] = comp_lcore_id;
 		core->num++;
@@ -182,14 +305,22 @@ update_comp(enum sppwk_action wk_action, const char *name,
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		tmp_lcore_id = comp_info->lcore_id;
+
+		/* Others sharing TX ports are updated to take over queues. */
+		for (cnt = 0; cnt < comp_info->nof_tx; cnt++)
+			set_component_change_port(comp_info->tx_ports[cnt],
+					SPPWK_PORT_DIR_TX);
+		tmp_wk_type = comp_info->wk_type;
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
 
 		info = (core_info + tmp_lcore_id);
 		core = &info->core[info->upd_index];
 
-		/* initialize classifier information */
-		if (comp_info->wk_type == SPPWK_TYPE_CLS)
+		/* initialize classifier or load balancer information */
+		if (tmp_wk_type == SPPWK_TYPE_CLS)
 			init_classifier_info(comp_lcore_id);
+		else if (tmp_wk_type == SPPWK_TYPE_LB)
+			init_lb_info(comp_lcore_id);
 
 		/* The latest lcore is released if worker thread is stopped. */
 		ret_del = del_comp_info(comp_lcore_id, core->num, core->id);
@@ -236,6 +367,7 @@ check_vf_port_count(int component_type, enum sppwk_port_dir dir,
 		break;
 
 	case SPPWK_TYPE_CLS:
+	case SPPWK_TYPE_LB:
 		if (nof_rx > 1)
 			return SPPWK_RET_NG;
 		break;
@@ -265,6 +397,7 @@ update_port(enum sppwk_action wk_action,
 	struct sppwk_port_info *port_info = NULL;
 	int *nof_ports = NULL;
 	struct sppwk_port_info **ports = NULL;
+	uint16_t *queues = NULL;
 	struct sppwk_comp_info *comp_info_base = NULL;
 	int *change_component = NULL;
 
@@ -281,9 +414,11 @@ update_port(enum sppwk_action wk_action,
 	if (dir == SPPWK_PORT_DIR_RX) {
 		nof_ports = &comp_info->nof_rx;
 		ports = comp_info->rx_ports;
+		queues = comp_info->rx_queues;
 	} else {
 		nof_ports = &comp_info->nof_tx;
 		ports = comp_info->tx_ports;
+		queues = comp_info->tx_queues;
 	}
 
 	switch (wk_action) {
@@ -298,18 +433,16 @@ update_port(enum sppwk_action wk_action,
 		port_idx = get_idx_port_info(port_info, *nof_ports, ports);
 		if (port_idx >= SPPWK_RET_OK) {
 			/* registered */
-			if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VLAN) {
-				while ((cnt < PORT_CAPABL_MAX) &&
-					    (port_info->port_attrs[cnt].ops !=
-					    SPPWK_PORT_OPS_ADD_VLAN))
-					cnt++;
-				if (cnt >= PORT_CAPABL_MAX) {
-					RTE_LOG(ERR, VF_CMD_RUNNER, "update VLAN tag "
-						"Non-registratio\n");
+			if (queues[port_idx] != port->queue_id) {
+				RTE_LOG(ERR, VF_CMD_RUNNER, "Port is already "
+					"bound to queue %u.\n",
+					queues[port_idx]);
+				return SPPWK_RET_NG;
+			}
+			if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
+				if (sppwk_set_port_attrs(port_info, port_attrs) !=
+						SPPWK_RET_OK)
 					return SPPWK_RET_NG;
-				}
-				memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 
 				ret = SPPWK_RET_OK;
 				break;
@@ -323,23 +456,25 @@ update_port(enum sppwk_action wk_action,
 			return SPPWK_RET_NG;
 		}
 
+		/* Queue given to other lcore cannot be taken over. */
+		if (dir == SPPWK_PORT_DIR_TX &&
+				sppwk_is_lent_tx_queue(port_info,
+					port->queue_id, comp_info->lcore_id)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER, "Queue %u is used "
+				"by other lcore as free queue.\n",
+				port->queue_id);
+			return SPPWK_RET_NG;
+		}
+
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
-			while ((cnt < PORT_CAPABL_MAX) &&
-					(port_info->port_attrs[cnt].ops !=
-					SPPWK_PORT_OPS_NONE)) {
-				cnt++;
-			}
-			if (cnt >= PORT_CAPABL_MAX) {
-				RTE_LOG(ERR, VF_CMD_RUNNER,
-						"No space of port ability.\n");
+			if (sppwk_set_port_attrs(port_info, port_attrs) !=
+					SPPWK_RET_OK)
 				return SPPWK_RET_NG;
-			}
-			memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 		}
 
 		port_info->iface_type = port->iface_type;
 		ports[*nof_ports] = port_info;
+		queues[*nof_ports] = port->queue_id;
 		(*nof_ports)++;
 
 		ret = SPPWK_RET_OK;
@@ -356,7 +491,8 @@ update_port(enum sppwk_action wk_action,
 					sizeof(struct sppwk_port_attrs));
 		}
 
-		ret_del = delete_port_info(port_info, *nof_ports, ports);
+		ret_del = delete_port_info(port_info, *nof_ports, ports,
+				queues);
 		if (ret_del == 0)
 			(*nof_ports)--; /* If deleted, decrement number. */
 
@@ -367,6 +503,9 @@ update_port(enum sppwk_action wk_action,
 		return SPPWK_RET_NG;
 	}
 
+	/* Components sharing TX port are updated to resolve its queues. */
+	if (dir == SPPWK_PORT_DIR_TX)
+		set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
 	*(change_component + comp_lcore_id) = 1;
 	return ret;
 }
@@ -383,11 +522,17 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 	switch (cmd->type) {
 	case SPPWK_CMDTYPE_CLS_MAC:
 	case SPPWK_CMDTYPE_CLS_VLAN:
-		ret = update_cls_table(cmd->spec.cls_table.wk_action,
-				cmd->spec.cls_table.cls_type,
-				cmd->spec.cls_table.vid,
-				cmd->spec.cls_table.mac,
-				&cmd->spec.cls_table.port);
+		if (cmd->spec.cls_table.cls_type == SPPWK_CLS_TYPE_FLOW)
+			ret = update_cls_flow_table(
+					cmd->spec.cls_table.wk_action,
+					cmd->spec.cls_table.flow_rules,
+					&cmd->spec.cls_table.port);
+		else
+			ret = update_cls_table(cmd->spec.cls_table.wk_action,
+					cmd->spec.cls_table.cls_type,
+					cmd->spec.cls_table.vid,
+					cmd->spec.cls_table.mac,
+					&cmd->spec.cls_table.port);
 		if (ret == 0) {
 			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
@@ -399,7 +544,8 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 				cmd->spec.comp.wk_action,
 				cmd->spec.comp.name,
 				cmd->spec.comp.core,
-				cmd->spec.comp.wk_type);
+				cmd->spec.comp.wk_type,
+				cmd->spec.comp.cls_tbl_size);
 		if (ret == 0) {
 			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
@@ -419,6 +565,38 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		}
 		break;
 
+	case SPPWK_CMDTYPE_LB_HASH:
+	case SPPWK_CMDTYPE_LB_WEIGHT:
+	case SPPWK_CMDTYPE_LB_RETA:
+		ret = update_lb_table(cmd->type, &cmd->spec.lb_table);
+		if (ret == 0) {
+			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
+			ret = flush_cmd();
+		}
+		break;
+
+	case SPPWK_CMDTYPE_FLUSH_THRESH:
+		ret = update_flush_thresh(&cmd->spec.flush_thresh);
+		if (ret == 0) {
+			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
+			ret = flush_cmd();
+		}
+		break;
+
+	case SPPWK_CMDTYPE_LAT_PROBE:
+		/* Probes are referred by lcores directly, no need to flush. */
+		ret = sppwk_update_lat_probe(cmd->spec.lat_probe.on,
+				&cmd->spec.lat_probe.port,
+				cmd->spec.lat_probe.name);
+		break;
+
+	case SPPWK_CMDTYPE_CHAIN_TRACE:
+		if (chain_trace_set(cmd->spec.chain_trace.on) < 0)
+			ret = SPPWK_RET_NG;
+		else
+			ret = SPPWK_RET_OK;
+		break;
+
 	default:
 		/* Do nothing. */
 		ret = SPPWK_RET_OK;
@@ -463,6 +641,9 @@ iterate_lcore_info(struct sppwk_lcore_params *params)
 			if (comp_info->wk_type == SPPWK_TYPE_CLS) {
 				ret = get_classifier_status(lcore_id,
 						core->id[cnt], params);
+			} else if (comp_info->wk_type == SPPWK_TYPE_LB) {
+				ret = get_lb_status(lcore_id,
+						core->id[cnt], params);
 			} else {
 				ret = get_forwarder_status(lcore_id,
 						core->id[cnt], params);
@@ -526,6 +707,10 @@ update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp)
 		if (comp_info->wk_type == SPPWK_TYPE_CLS) {
 			ret = update_classifier(comp_info);
 			RTE_LOG(DEBUG, VF_CMD_RUNNER, "Update classifier.\n");
+		} else if (comp_info->wk_type == SPPWK_TYPE_LB) {
+			ret = update_load_balancer(comp_info);
+			RTE_LOG(DEBUG, VF_CMD_RUNNER,
+					"Update load balancer.\n");
 		} else {
 			ret = update_forwarder(comp_info);
 			RTE_LOG(DEBUG, VF_CMD_RUNNER, "Update forwarder.\n");
@@ -556,7 +741,7 @@ append_classifier_element_value(
 	int ret = SPPWK_RET_NG;
 	char *buff, *tmp_buff;
 	char port_str[CMD_TAG_APPEND_SIZE];
-	char value_str[STR_LEN_SHORT];
+	char value_str[SPPWK_FLOW_RULE_STR_SZ];
 	buff = params->output;
 	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
 	if (unlikely(tmp_buff == NULL)) {
@@ -572,7 +757,7 @@ append_classifier_element_value(
 	if (unlikely(ret < SPPWK_RET_OK))
 		return ret;
 
-	memset(value_str, 0x00, STR_LEN_SHORT);
+	memset(value_str, 0x00, sizeof(value_str));
 	switch (cls_type) {
 	case SPPWK_CLS_TYPE_MAC:
 		sprintf(value_str, "%s", mac);
@@ -580,6 +765,10 @@ append_classifier_element_value(
 	case SPPWK_CLS_TYPE_VLAN:
 		sprintf(value_str, "%d/%s", vid, mac);
 		break;
+	case SPPWK_CLS_TYPE_FLOW:
+		/* Flow rule is given as `mac`. */
+		snprintf(value_str, sizeof(value_str), "%s", mac);
+		break;
 	default:
 		/* not used */
 		break;
@@ -615,6 +804,9 @@ get_comp_type_from_str(const char *type_str)
 	} else if (strncmp(type_str, CORE_TYPE_FORWARD_STR,
 			strlen(CORE_TYPE_FORWARD_STR)+1) == 0) {
 		return SPPWK_TYPE_FWD;
+	} else if (strncmp(type_str, CORE_TYPE_LOAD_BALANCER_STR,
+			strlen(CORE_TYPE_LOAD_BALANCER_STR)+1) == 0) {
+		return SPPWK_TYPE_LB;
 	}
 
 	return SPPWK_TYPE_NONE;
@@ -644,6 +836,14 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "master-lcore", add_master_lcore},
 		{ "core", add_core},
 		{ "classifier_table", add_classifier_table},
+		{ "classifier_table_usage", add_classifier_table_usage},
+		{ "lb_table", add_lb_table},
+		{ "port_stats", add_port_stats},
+		{ "lcore_stats", add_lcore_stats},
+		{ "lcore_cycles", add_lcore_cycles},
+		{ "comp_cycles", add_comp_cycles},
+		{ "ring_latency", add_ring_latency},
+		{ "chain_latency", add_chain_latency},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));